@@ -320,7 +320,8 @@ public final class NativeLibrary {
     public static boolean isValidFile(String filename) {
         String name = filename.toLowerCase();
         return (name.endsWith(".cci") || name.endsWith(".3ds") || name.endsWith(".elf") ||
-                name.endsWith(".cxi") || name.endsWith(".app") || name.endsWith(".3dsx"));
+                name.endsWith(".cxi") || name.endsWith(".app") || name.endsWith(".3dsx") ||
+                name.endsWith(".zcci") || name.endsWith(".zcxi"));
     }
 
     public static void addNetPlayMessage(int type, String message) {
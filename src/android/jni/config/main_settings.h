@@ -43,6 +43,7 @@ extern const ConfigInfo<std::string> REMOTE_SHADER_HOST;
 extern const ConfigInfo<bool> ENABLE_DSP_LLE;
 extern const ConfigInfo<bool> DSP_LLE_MULTITHREAD;
 extern const ConfigInfo<bool> AUDIO_STRETCHING;
+extern const ConfigInfo<u16> AUDIO_TARGET_LATENCY;
 extern const ConfigInfo<float> AUDIO_VOLUME;
 extern const ConfigInfo<float> MIC_VOLUME;
 extern const ConfigInfo<u8> AUDIO_OUTPUT_TYPE;
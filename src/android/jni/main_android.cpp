@@ -13,6 +13,7 @@
 #include "core/core.h"
 #include "core/frontend/applets/default_applets.h"
 #include "core/frontend/mic.h"
+#include "core/game_library.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/cfg/cfg.h"
 #include "core/hle/service/hid/hid.h"
@@ -55,6 +56,7 @@ struct GameInfo {
     bool executable;
 };
 static std::map<std::string, GameInfo> s_app_dict;
+static std::unique_ptr<Core::GameLibrary> s_game_library;
 
 void BootGame(const std::string& path) {
     NativeLibrary::UpdateProgress("BootGame", 0, 1);
@@ -166,46 +168,16 @@ void BootGame(const std::string& path) {
     Config::Save();
 }
 
-static bool GetSMDHData(Loader::AppLoader* loader, Loader::SMDH* smdh) {
-    std::vector<u8> smdh_data;
-    [&loader, &smdh_data]() -> void {
-        u64 program_id = 0;
-        loader->ReadProgramId(program_id);
-        loader->ReadIcon(smdh_data);
-        if (program_id < 0x00040000'00000000 || program_id > 0x00040000'FFFFFFFF)
-            return;
-
-        std::string update_path = Service::AM::GetTitleContentPath(
-            Service::FS::MediaType::SDMC, program_id + 0x0000000E'00000000);
-
-        if (!FileUtil::Exists(update_path))
-            return;
-
-        std::unique_ptr<Loader::AppLoader> update_loader = Loader::GetLoader(update_path);
-        if (!update_loader)
-            return;
-
-        std::vector<u8> dlc_data;
-        update_loader->ReadIcon(dlc_data);
-        if (Loader::IsValidSMDH(dlc_data)) {
-            std::swap(smdh_data, dlc_data);
-        }
-    }();
-
-    if (Loader::IsValidSMDH(smdh_data)) {
-        memcpy(smdh, smdh_data.data(), sizeof(Loader::SMDH));
-        return true;
-    }
-
-    return false;
-}
-
 static const GameInfo& GetGameInfo(const std::string& path) {
     u64 timestamp;
+    u64 size;
     if (IsSafPath(path)) {
+        // Opening a document just to query its size is slow, the timestamp alone has to do
         timestamp = NativeLibrary::SafLastModified(path);
+        size = 0;
     } else {
         timestamp = FileUtil::GetFileModificationTimestamp(path);
+        size = FileUtil::GetSize(path);
     }
     auto [iter, is_new] = s_app_dict.emplace(path, GameInfo{});
     auto& game = iter->second;
@@ -215,19 +187,20 @@ static const GameInfo& GetGameInfo(const std::string& path) {
         }
     }
 
-    auto app_loader = Loader::GetLoader(path);
-    if (app_loader == nullptr) {
+    const Core::GameEntry entry = s_game_library->GetEntry(path, size, timestamp);
+    if (entry.file_type == Loader::FileType::Error) {
         return game;
     }
 
-    app_loader->ReadProgramId(game.id);
-    app_loader->ReadTitle(game.name);
-    app_loader->IsExecutable(game.executable);
+    game.id = entry.program_id;
+    game.name = entry.title;
+    game.executable = entry.executable;
     game.strid = fmt::format("{:016X}", game.id);
     game.timestamp = timestamp;
 
-    Loader::SMDH smdh;
-    if (GetSMDHData(app_loader.get(), &smdh)) {
+    if (Loader::IsValidSMDH(entry.smdh)) {
+        Loader::SMDH smdh;
+        memcpy(&smdh, entry.smdh.data(), sizeof(Loader::SMDH));
         game.icon = smdh.GetIcon(true);
         game.regions = smdh.GetRegions();
     }
@@ -315,6 +288,10 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_SetUserPath(JNIEnv* env,
         Config::SaveDefault();
     }
 
+    // game metadata index, which lives in the user directory
+    s_game_library = std::make_unique<Core::GameLibrary>();
+    s_game_library->Load();
+
     // Register frontend applets
     Frontend::RegisterDefaultApplets();
     s_keyboard = std::make_shared<AndroidKeyboard>();
@@ -436,6 +413,8 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_MoveEvent(JNIEnv* env, j
 JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass obj,
                                                             jstring jFile) {
     NativeLibrary::Initialize(env);
+    // the game list has been shown by now, keep what was indexed for the next launch
+    s_game_library->Save();
     // reload config
     Config::Clear();
     Config::Load();
@@ -472,6 +451,7 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     Settings::values.sink_id = Config::Get(Config::AUDIO_ENGINE);
     Settings::values.audio_device_id = Config::Get(Config::AUDIO_DEVICE);
     Settings::values.enable_audio_stretching = Config::Get(Config::AUDIO_STRETCHING);
+    Settings::values.audio_target_latency = Config::Get(Config::AUDIO_TARGET_LATENCY);
     // mic
     Settings::values.mic_input_type = Config::Get(Config::MIC_INPUT_TYPE);
     Settings::values.mic_input_device = Config::Get(Config::MIC_INPUT_DEVICE);
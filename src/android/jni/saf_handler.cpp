@@ -4,6 +4,19 @@
 #include "saf_handler.h"
 #include "jni_common.h"
 
+static std::size_t PositionalRead(int fd, void* buf, std::size_t size, u64 offset) {
+    std::size_t total = 0;
+    while (total < size) {
+        const ssize_t result =
+            pread(fd, static_cast<u8*>(buf) + total, size - total, offset + total);
+        if (result <= 0) {
+            break;
+        }
+        total += static_cast<std::size_t>(result);
+    }
+    return total;
+}
+
 class SAFHandler : public FileUtil::IOHandler {
 public:
     static std::unique_ptr<FileUtil::IOHandler> Open(const std::string& filename, const char openmode[]) {
@@ -30,6 +43,10 @@ public:
         return write(m_fd, buf, size * count);
     }
 
+    std::size_t ReadAt(void* buf, std::size_t size, u64 offset) override {
+        return PositionalRead(m_fd, buf, size, offset);
+    }
+
     bool Seek(s64 offset, int whence) override {
         return -1 != lseek(m_fd, offset, whence);
     }
@@ -53,6 +70,10 @@ public:
     bool Flush() override {
         return 0 == fsync(m_fd);
     }
+
+    int GetDescriptor() override {
+        return m_fd;
+    }
 private:
     int m_fd;
 };
@@ -83,6 +104,10 @@ public:
         return std::fwrite(buf, size, count, m_file);
     }
 
+    std::size_t ReadAt(void* buf, std::size_t size, u64 offset) override {
+        return PositionalRead(fileno(m_file), buf, size, offset);
+    }
+
     bool Seek(s64 offset, int whence) override {
         return 0 != fseeko(m_file, offset, whence);
     }
@@ -113,6 +138,10 @@ public:
     bool Flush() override {
         return 0 == std::fflush(m_file);
     }
+
+    int GetDescriptor() override {
+        return fileno(m_file);
+    }
 private:
     std::FILE* m_file;
 };
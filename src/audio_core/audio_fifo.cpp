@@ -0,0 +1,124 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include "audio_core/audio_fifo.h"
+
+namespace AudioCore {
+
+namespace {
+constexpr u64 position_one = u64(1) << 32;
+constexpr u64 position_mask = position_one - 1;
+
+/// Weight given to each new occupancy measurement; smooths out the burstiness of both ends.
+constexpr double occupancy_smoothing = 0.02;
+/// Relative rate change per unit of relative occupancy error.
+constexpr double drift_gain = 0.05;
+/// Occupancy, as a multiple of the target, above which the backlog is discarded outright.
+constexpr std::size_t resync_factor = 4;
+} // Anonymous namespace
+
+AudioFifo::AudioFifo() : target_latency(capacity / 4) {}
+
+std::size_t AudioFifo::Push(const s16* frames, std::size_t frame_count) {
+    const std::size_t pushed = ring.Push(frames, frame_count);
+    producer_started.store(true, std::memory_order_relaxed);
+    if (pushed < frame_count) {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+        frames_dropped.fetch_add(frame_count - pushed, std::memory_order_relaxed);
+    }
+    return pushed;
+}
+
+std::size_t AudioFifo::Pop(s16* output, std::size_t frame_count) {
+    return ring.Pop(output, frame_count);
+}
+
+std::vector<s16> AudioFifo::PopAll() {
+    return ring.Pop();
+}
+
+std::size_t AudioFifo::PopCorrected(s16* output, std::size_t frame_count) {
+    if (frame_count == 0) {
+        return 0;
+    }
+
+    const std::size_t target = std::max<std::size_t>(target_latency.load(), 1);
+    std::size_t available = ring.Size();
+
+    // A large backlog (e.g. after the sink stalled) would take minutes to play out at the
+    // corrected rate, so drop it instead.
+    if (available > target * resync_factor) {
+        const std::size_t excess = std::min(available - target, capacity);
+        const std::size_t dropped = ring.Pop(scratch.data(), excess);
+        frames_dropped.fetch_add(dropped, std::memory_order_relaxed);
+        available -= dropped;
+        filtered_occupancy = static_cast<double>(available);
+    }
+
+    filtered_occupancy +=
+        (static_cast<double>(available) - filtered_occupancy) * occupancy_smoothing;
+    const double error = (filtered_occupancy - static_cast<double>(target)) / target;
+    const double ratio =
+        1.0 + std::clamp(error * drift_gain, -max_drift_correction, max_drift_correction);
+    playback_ratio.store(ratio, std::memory_order_relaxed);
+
+    const u64 step = static_cast<u64>(std::llround(ratio * position_one));
+    // Anything past the capacity could not be buffered anyway, so the read underruns there
+    const auto wanted = std::min(
+        static_cast<std::size_t>((position + (frame_count - 1) * step) >> 32), capacity);
+    const std::size_t popped = ring.Pop(scratch.data(), wanted);
+
+    std::size_t next = 0;
+    std::size_t written = 0;
+    for (; written < frame_count; written++) {
+        while (position >= position_one) {
+            if (next == popped) {
+                RecordUnderrun();
+                return written;
+            }
+            previous_frame = current_frame;
+            current_frame = {scratch[next * 2 + 0], scratch[next * 2 + 1]};
+            next++;
+            position -= position_one;
+        }
+
+        const s64 fraction = static_cast<s64>((position & position_mask) >> 16);
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const s64 delta = current_frame[channel] - previous_frame[channel];
+            output[written * 2 + channel] =
+                static_cast<s16>(previous_frame[channel] + ((delta * fraction) >> 16));
+        }
+        position += step;
+    }
+    return written;
+}
+
+void AudioFifo::SetTargetLatency(std::size_t frames) {
+    target_latency.store(std::clamp<std::size_t>(frames, 1, capacity / resync_factor));
+}
+
+std::size_t AudioFifo::Size() const {
+    return ring.Size();
+}
+
+AudioFifo::Stats AudioFifo::GetAndResetStats() {
+    Stats stats{};
+    stats.underruns = underruns.exchange(0, std::memory_order_relaxed);
+    stats.overruns = overruns.exchange(0, std::memory_order_relaxed);
+    stats.frames_dropped = frames_dropped.exchange(0, std::memory_order_relaxed);
+    stats.occupancy = ring.Size();
+    stats.playback_ratio = playback_ratio.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioFifo::RecordUnderrun() {
+    // Running dry before the producer has started is expected and not worth reporting.
+    if (producer_started.load(std::memory_order_relaxed)) {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace AudioCore
@@ -0,0 +1,95 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+#include "common/ring_buffer.h"
+
+namespace AudioCore {
+
+/**
+ * Lock-free single-producer single-consumer FIFO between the DSP and the sink callback.
+ *
+ * The consumer side optionally corrects clock drift between the two ends: it keeps the buffer
+ * occupancy near a target latency by reading slightly faster or slower than real time, which
+ * amounts to a pitch change of at most max_drift_correction. Unlike the time stretcher this does
+ * not try to absorb emulation speed changes, only the small skew between the emulated and host
+ * audio clocks.
+ */
+class AudioFifo {
+public:
+    static constexpr std::size_t capacity = 0x2000;
+
+    /// The largest relative change to the playback rate drift correction applies.
+    static constexpr double max_drift_correction = 0.005;
+
+    struct Stats {
+        /// Number of consumer reads which could not be fully satisfied
+        u64 underruns;
+        /// Number of producer writes which did not fit into the buffer
+        u64 overruns;
+        /// Number of frames discarded by overruns or resynchronisation
+        u64 frames_dropped;
+        /// Number of frames currently buffered
+        std::size_t occupancy;
+        /// Rate at which the consumer is currently reading relative to real time
+        double playback_ratio;
+    };
+
+    AudioFifo();
+
+    /// Pushes interleaved stereo frames. Called from the producer thread only.
+    /// @returns The number of frames actually pushed
+    std::size_t Push(const s16* frames, std::size_t frame_count);
+
+    /// Pops up to frame_count frames without any correction. Called from the consumer only.
+    std::size_t Pop(s16* output, std::size_t frame_count);
+
+    /// Pops all buffered frames without any correction. Called from the consumer only.
+    std::vector<s16> PopAll();
+
+    /**
+     * Fills up to frame_count frames, adjusting the read rate to steer the occupancy towards the
+     * target latency. Called from the consumer only.
+     * @returns The number of frames written; fewer than frame_count indicates an underrun
+     */
+    std::size_t PopCorrected(s16* output, std::size_t frame_count);
+
+    /// Sets the occupancy, in frames, which drift correction steers towards.
+    void SetTargetLatency(std::size_t frames);
+
+    /// Number of frames currently buffered.
+    std::size_t Size() const;
+
+    /// Returns the counters accumulated since the last call and resets them.
+    Stats GetAndResetStats();
+
+private:
+    void RecordUnderrun();
+
+    Common::RingBuffer<s16, capacity, 2> ring;
+
+    std::atomic<std::size_t> target_latency;
+    std::atomic<u64> underruns{0};
+    std::atomic<u64> overruns{0};
+    std::atomic<u64> frames_dropped{0};
+    std::atomic<bool> producer_started{false};
+
+    // Consumer-only state. The ratio is published for stats.
+    std::atomic<double> playback_ratio{1.0};
+    double filtered_occupancy = 0.0;
+    /// Read position between previous_frame and current_frame, in 32.32 fixed point
+    u64 position = 0;
+    std::array<s16, 2> previous_frame{};
+    std::array<s16, 2> current_frame{};
+    /// Frames popped by PopCorrected, preallocated so that the sink callback never allocates
+    std::array<s16, capacity * 2> scratch{};
+};
+
+} // namespace AudioCore
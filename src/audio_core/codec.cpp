@@ -6,6 +6,11 @@
 #include <array>
 #include <cstddef>
 #include <cstring>
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
 #include "audio_core/audio_types.h"
 #include "audio_core/codec.h"
 #include "common/assert.h"
@@ -13,64 +18,134 @@
 
 namespace AudioCore::Codec {
 
+/// Samples are decoded into a contiguous block of this many stereo samples before being appended
+/// to the output buffer, which allows the conversion loops to be vectorized.
+constexpr std::size_t chunk_samples = 256;
+
+using StereoSample16 = std::array<s16, 2>;
+
+/**
+ * Decodes sample_count samples in chunks of at most max_chunk samples.
+ * @param decode Called as decode(dest, first_sample, count) to fill dest with count samples.
+ */
+template <std::size_t max_chunk, typename DecodeFunc>
+static StereoBuffer16 DecodeInChunks(std::size_t sample_count, DecodeFunc decode) {
+    StereoBuffer16 ret;
+    std::array<StereoSample16, max_chunk> chunk;
+    for (std::size_t first = 0; first < sample_count; first += max_chunk) {
+        const std::size_t count = std::min(max_chunk, sample_count - first);
+        decode(chunk.data(), first, count);
+        ret.insert(ret.end(), chunk.begin(), chunk.begin() + count);
+    }
+    return ret;
+}
+
+constexpr std::size_t ADPCM_FRAME_LEN = 8;
+constexpr std::size_t ADPCM_SAMPLES_PER_FRAME = 14;
+
+/**
+ * Unpacks the first num_bytes data bytes of an ADPCM frame into the scaled filter input of each
+ * sample, (nibble * scale) << 11 plus the 0x400 rounding term, in 11 bit fixed point. Only the
+ * samples of those bytes are valid afterwards, the bytes after them are not read.
+ */
+static void UnpackADPCMFrame(const u8* data, std::size_t num_bytes, int scale_shift,
+                             std::array<s32, ADPCM_SAMPLES_PER_FRAME + 2>& xn) {
+#if defined(ARCHITECTURE_x86_64)
+    u64 bytes = 0;
+    std::memcpy(&bytes, data, num_bytes);
+    const __m128i words = _mm_unpacklo_epi8(_mm_cvtsi64_si128(bytes), _mm_setzero_si128());
+    // The high nibble of each byte is the earlier sample.
+    const __m128i high = _mm_srli_epi16(words, 4);
+    const __m128i low = _mm_and_si128(words, _mm_set1_epi16(0xF));
+    const __m128i shift = _mm_cvtsi32_si128(scale_shift + 11);
+    const __m128i rounding = _mm_set1_epi32(0x400);
+    const auto store = [&](std::size_t offset, __m128i nibbles) {
+        // Sign extend the 4 bit nibbles to 16 and then 32 bits.
+        nibbles = _mm_srai_epi16(_mm_slli_epi16(nibbles, 12), 12);
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(nibbles, nibbles), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(nibbles, nibbles), 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&xn[offset]),
+                         _mm_add_epi32(_mm_sll_epi32(lo, shift), rounding));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&xn[offset + 4]),
+                         _mm_add_epi32(_mm_sll_epi32(hi, shift), rounding));
+    };
+    store(0, _mm_unpacklo_epi16(high, low));
+    store(8, _mm_unpackhi_epi16(high, low));
+#elif defined(ARCHITECTURE_ARM64)
+    u64 bytes = 0;
+    std::memcpy(&bytes, data, num_bytes);
+    const uint8x8_t packed = vcreate_u8(bytes);
+    // The high nibble of each byte is the earlier sample.
+    const uint8x8x2_t nibbles = vzip_u8(vshr_n_u8(packed, 4), vand_u8(packed, vdup_n_u8(0xF)));
+    const int32x4_t shift = vdupq_n_s32(scale_shift + 11);
+    const int32x4_t rounding = vdupq_n_s32(0x400);
+    const auto store = [&](std::size_t offset, uint8x8_t values) {
+        // Sign extend the 4 bit nibbles to 16 and then 32 bits.
+        const int16x8_t widened = vreinterpretq_s16_u16(vmovl_u8(values));
+        const int16x8_t words = vshrq_n_s16(vshlq_n_s16(widened, 12), 12);
+        vst1q_s32(&xn[offset],
+                  vaddq_s32(vshlq_s32(vmovl_s16(vget_low_s16(words)), shift), rounding));
+        vst1q_s32(&xn[offset + 4],
+                  vaddq_s32(vshlq_s32(vmovl_s16(vget_high_s16(words)), shift), rounding));
+    };
+    store(0, nibbles.val[0]);
+    store(8, nibbles.val[1]);
+#else
+    constexpr std::array<int, 16> SIGNED_NIBBLES = {
+        {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
+    const int scale = 1 << scale_shift;
+    for (std::size_t i = 0; i < num_bytes; i++) {
+        xn[i * 2 + 0] = ((SIGNED_NIBBLES[data[i] >> 4] * scale) << 11) + 0x400;
+        xn[i * 2 + 1] = ((SIGNED_NIBBLES[data[i] & 0xF] * scale) << 11) + 0x400;
+    }
+#endif
+}
+
 StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
                            const std::array<s16, 16>& adpcm_coeff, ADPCMState& state) {
     // GC-ADPCM with scale factor and variable coefficients.
     // Frames are 8 bytes long containing 14 samples each.
     // Samples are 4 bits (one nibble) long.
 
-    constexpr std::size_t FRAME_LEN = 8;
-    constexpr std::size_t SAMPLES_PER_FRAME = 14;
-    constexpr std::array<int, 16> SIGNED_NIBBLES = {
-        {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
-
+    // Samples are decoded in pairs, so an odd sample_count decodes one extra sample.
     const std::size_t ret_size =
         sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
-    StereoBuffer16 ret(ret_size);
 
     int yn1 = state.yn1, yn2 = state.yn2;
 
-    const std::size_t NUM_FRAMES =
-        (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
-    for (std::size_t framei = 0; framei < NUM_FRAMES; framei++) {
-        const int frame_header = data[framei * FRAME_LEN];
-        const int scale = 1 << (frame_header & 0xF);
-        const int idx = (frame_header >> 4) & 0x7;
-
-        // Coefficients are fixed point with 11 bits fractional part.
-        const int coef1 = adpcm_coeff[idx * 2 + 0];
-        const int coef2 = adpcm_coeff[idx * 2 + 1];
-
-        // Decodes an audio sample. One nibble produces one sample.
-        const auto decode_sample = [&](const int nibble) -> s16 {
-            const int xn = nibble * scale;
-            // We first transform everything into 11 bit fixed point, perform the second order
-            // digital filter, then transform back.
-            // 0x400 == 0.5 in 11 bit fixed point.
-            // Filter: y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
-            int val = ((xn << 11) + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11;
-            // Clamp to output range.
-            val = std::clamp(val, -32768, 32767);
-            // Advance output feedback.
-            yn2 = yn1;
-            yn1 = val;
-            return (s16)val;
-        };
-
-        std::size_t outputi = framei * SAMPLES_PER_FRAME;
-        std::size_t datai = framei * FRAME_LEN + 1;
-        for (std::size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi].fill(sample1);
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi].fill(sample2);
-            outputi++;
-
-            datai++;
-        }
-    }
+    // Chunks hold a whole number of ADPCM frames.
+    constexpr std::size_t frames_per_chunk = chunk_samples / ADPCM_SAMPLES_PER_FRAME;
+    StereoBuffer16 ret = DecodeInChunks<frames_per_chunk * ADPCM_SAMPLES_PER_FRAME>(
+        ret_size, [&](StereoSample16* dest, std::size_t first, std::size_t count) {
+            std::array<s32, ADPCM_SAMPLES_PER_FRAME + 2> xn;
+            std::size_t framei = first / ADPCM_SAMPLES_PER_FRAME;
+            for (std::size_t outputi = 0; outputi < count; framei++) {
+                const u8* frame = data + framei * ADPCM_FRAME_LEN;
+                const int frame_header = frame[0];
+                const int idx = (frame_header >> 4) & 0x7;
+
+                // Coefficients are fixed point with 11 bits fractional part.
+                const int coef1 = adpcm_coeff[idx * 2 + 0];
+                const int coef2 = adpcm_coeff[idx * 2 + 1];
+
+                // The last frame may be cut short, so only read the bytes of its samples
+                const std::size_t frame_samples =
+                    std::min(ADPCM_SAMPLES_PER_FRAME, count - outputi);
+                UnpackADPCMFrame(frame + 1, (frame_samples + 1) / 2, frame_header & 0xF, xn);
+
+                // The second order digital filter is inherently serial:
+                // y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
+                for (std::size_t i = 0; i < frame_samples; i++) {
+                    int val = (xn[i] + coef1 * yn1 + coef2 * yn2) >> 11;
+                    // Clamp to output range.
+                    val = std::clamp(val, -32768, 32767);
+                    // Advance output feedback.
+                    yn2 = yn1;
+                    yn1 = val;
+                    dest[outputi++].fill(static_cast<s16>(val));
+                }
+            }
+        });
 
     state.yn1 = static_cast<s16>(yn1);
     state.yn2 = static_cast<s16>(yn2);
@@ -78,48 +153,104 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
     return ret;
 }
 
+/// Widens count unsigned 8 bit samples to PCM16, duplicating each sample if mono.
+template <bool mono>
+static void WidenPCM8(const u8* source, s16* dest, std::size_t count) {
+    std::size_t i = 0;
+#if defined(ARCHITECTURE_x86_64)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        // Interleaving zero below each byte computes sample << 8.
+        const __m128i lo = _mm_unpacklo_epi8(zero, bytes);
+        const __m128i hi = _mm_unpackhi_epi8(zero, bytes);
+        __m128i* out = reinterpret_cast<__m128i*>(dest + (mono ? i * 2 : i));
+        if constexpr (mono) {
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(lo, lo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, lo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, hi));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, hi));
+        } else {
+            _mm_storeu_si128(out + 0, lo);
+            _mm_storeu_si128(out + 1, hi);
+        }
+    }
+#elif defined(ARCHITECTURE_ARM64)
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t bytes = vld1q_u8(source + i);
+        const int16x8_t lo = vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(bytes), 8));
+        const int16x8_t hi = vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(bytes), 8));
+        s16* out = dest + (mono ? i * 2 : i);
+        if constexpr (mono) {
+            vst2q_s16(out, int16x8x2_t{{lo, lo}});
+            vst2q_s16(out + 16, int16x8x2_t{{hi, hi}});
+        } else {
+            vst1q_s16(out, lo);
+            vst1q_s16(out + 8, hi);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        const s16 sample = static_cast<s16>(static_cast<u16>(source[i]) << 8);
+        if constexpr (mono) {
+            dest[i * 2 + 0] = sample;
+            dest[i * 2 + 1] = sample;
+        } else {
+            dest[i] = sample;
+        }
+    }
+}
+
 StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
                           const std::size_t sample_count) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
-    const auto decode_sample = [](u8 sample) {
-        return static_cast<s16>(static_cast<u16>(sample) << 8);
-    };
-
-    StereoBuffer16 ret(sample_count);
+    return DecodeInChunks<chunk_samples>(
+        sample_count, [&](StereoSample16* dest, std::size_t first, std::size_t count) {
+            if (num_channels == 1) {
+                WidenPCM8<true>(data + first, dest->data(), count);
+            } else {
+                WidenPCM8<false>(data + first * 2, dest->data(), count * 2);
+            }
+        });
+}
 
-    if (num_channels == 1) {
-        for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i].fill(decode_sample(data[i]));
-        }
-    } else {
-        for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i][0] = decode_sample(data[i * 2 + 0]);
-            ret[i][1] = decode_sample(data[i * 2 + 1]);
-        }
+/// Duplicates count mono PCM16 samples into both channels of dest.
+static void DuplicatePCM16(const u8* source, s16* dest, std::size_t count) {
+    std::size_t i = 0;
+#if defined(ARCHITECTURE_x86_64)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i samples =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * sizeof(s16)));
+        __m128i* out = reinterpret_cast<__m128i*>(dest + i * 2);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(samples, samples));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(samples, samples));
+    }
+#elif defined(ARCHITECTURE_ARM64)
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t samples = vreinterpretq_s16_u8(vld1q_u8(source + i * sizeof(s16)));
+        vst2q_s16(dest + i * 2, int16x8x2_t{{samples, samples}});
+    }
+#endif
+    for (; i < count; i++) {
+        s16 sample;
+        std::memcpy(&sample, source + i * sizeof(s16), sizeof(s16));
+        dest[i * 2 + 0] = sample;
+        dest[i * 2 + 1] = sample;
     }
-
-    return ret;
 }
 
 StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
                            const std::size_t sample_count) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
-    StereoBuffer16 ret(sample_count);
-
-    if (num_channels == 1) {
-        for (std::size_t i = 0; i < sample_count; i++) {
-            s16 sample;
-            std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
-            ret[i].fill(sample);
-        }
-    } else {
-        for (std::size_t i = 0; i < sample_count; ++i) {
-            std::memcpy(&ret[i], data + i * sizeof(s16) * 2, 2 * sizeof(s16));
-        }
-    }
-
-    return ret;
+    return DecodeInChunks<chunk_samples>(
+        sample_count, [&](StereoSample16* dest, std::size_t first, std::size_t count) {
+            if (num_channels == 1) {
+                DuplicatePCM16(data + first * sizeof(s16), dest->data(), count);
+            } else {
+                std::memcpy(dest, data + first * sizeof(s16) * 2, count * sizeof(s16) * 2);
+            }
+        });
 }
 } // namespace AudioCore::Codec
@@ -7,6 +7,7 @@
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 #include "common/assert.h"
+#include "core/dumping/backend.h"
 #include "core/settings.h"
 
 namespace AudioCore {
@@ -41,27 +42,65 @@ void DspInterface::EnableStretching(bool enable) {
     perform_time_stretching = enable;
 }
 
+void DspInterface::SetStretchMethod(Settings::AudioStretchMethod method) {
+    // Applied by the sink callback, which owns the time stretcher.
+    stretch_method = method;
+    stretch_method_changed = true;
+}
+
+void DspInterface::SetTargetLatency(u32 milliseconds) {
+    // Frontends which do not configure the latency leave it at 0
+    if (milliseconds == 0) {
+        milliseconds = default_target_latency_ms;
+    }
+    fifo.SetTargetLatency(static_cast<std::size_t>(milliseconds) * native_sample_rate / 1000);
+}
+
+AudioFifo::Stats DspInterface::GetAndResetFifoStats() {
+    return fifo.GetAndResetStats();
+}
+
+void DspInterface::SetVideoDumper(VideoDumper::Backend* dumper) {
+    video_dumper = dumper;
+}
+
 void DspInterface::OutputFrame(const StereoFrame16& frame) {
-    fifo.Push(frame.data(), frame.size());
+    if (video_dumper && video_dumper->IsDumping()) {
+        video_dumper->AddAudioFrame(frame);
+        // Offline dumps run faster than real time, so there is no point feeding the sink.
+        if (Settings::values.offline_dumping) {
+            return;
+        }
+    }
+    fifo.Push(frame[0].data(), frame.size());
 }
 
 void DspInterface::OutputSample(std::array<s16, 2> sample) {
+    if (video_dumper && video_dumper->IsDumping()) {
+        video_dumper->AddAudioSample(sample);
+        if (Settings::values.offline_dumping) {
+            return;
+        }
+    }
     fifo.Push(sample.data(), 1);
 }
 
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
     std::size_t frames_written;
     if (perform_time_stretching) {
-        const std::vector<s16> in{fifo.Pop()};
+        if (stretch_method_changed.exchange(false)) {
+            time_stretcher.SetMethod(stretch_method);
+        }
+        const std::vector<s16> in{fifo.PopAll()};
         const std::size_t num_in{in.size() / 2};
         frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
     } else if (flushing_time_stretcher) {
         time_stretcher.Flush();
         frames_written = time_stretcher.Process(nullptr, 0, buffer, num_frames);
-        frames_written += fifo.Pop(buffer, num_frames - frames_written);
+        frames_written += fifo.Pop(buffer + 2 * frames_written, num_frames - frames_written);
         flushing_time_stretcher = false;
     } else {
-        frames_written = fifo.Pop(buffer, num_frames);
+        frames_written = fifo.PopCorrected(buffer, num_frames);
     }
 
     if (frames_written > 0) {
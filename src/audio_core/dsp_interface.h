@@ -6,16 +6,20 @@
 
 #include <memory>
 #include <vector>
+#include "audio_core/audio_fifo.h"
 #include "audio_core/audio_types.h"
 #include "audio_core/time_stretch.h"
 #include "common/common_types.h"
-#include "common/ring_buffer.h"
 #include "core/memory.h"
 
 namespace Service::DSP {
 class DSP_DSP;
 } // namespace Service::DSP
 
+namespace VideoDumper {
+class Backend;
+} // namespace VideoDumper
+
 namespace AudioCore {
 
 class Sink;
@@ -98,6 +102,18 @@ public:
     Sink& GetSink();
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
+    /// Select the audio stretching implementation.
+    void SetStretchMethod(Settings::AudioStretchMethod method);
+    /// Default for SetTargetLatency, in milliseconds
+    static constexpr u32 default_target_latency_ms = 50;
+
+    /// Set how much audio, in milliseconds, drift correction keeps buffered ahead of the sink.
+    /// 0 selects default_target_latency_ms.
+    void SetTargetLatency(u32 milliseconds);
+    /// Returns the sink FIFO counters accumulated since the last call and resets them.
+    AudioFifo::Stats GetAndResetFifoStats();
+    /// Sets the backend which output audio is passed to while video dumping is active.
+    void SetVideoDumper(VideoDumper::Backend* dumper);
 
 protected:
     void OutputFrame(const StereoFrame16& frame);
@@ -108,9 +124,12 @@ private:
     void OutputCallback(s16* buffer, std::size_t num_frames);
 
     std::unique_ptr<Sink> sink;
+    VideoDumper::Backend* video_dumper = nullptr;
     std::atomic<bool> perform_time_stretching = false;
     std::atomic<bool> flushing_time_stretcher = false;
-    Common::RingBuffer<s16, 0x2000, 2> fifo;
+    std::atomic<Settings::AudioStretchMethod> stretch_method{};
+    std::atomic<bool> stretch_method_changed = false;
+    AudioFifo fifo;
     std::array<s16, 2> last_frame{};
     TimeStretcher time_stretcher;
     std::string current_sink_id;
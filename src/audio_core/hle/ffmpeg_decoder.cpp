@@ -2,11 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "audio_core/hle/adts.h"
 #include "audio_core/hle/ffmpeg_decoder.h"
 #include "audio_core/hle/ffmpeg_dl.h"
 
 namespace AudioCore::HLE {
 
+namespace {
+/// How many ADTS frames past the last request to decode speculatively
+constexpr std::size_t decode_ahead_frames = 2;
+/// Size of an ADTS header without CRC
+constexpr std::size_t adts_header_size = 7;
+} // Anonymous namespace
+
 class FFMPEGDecoder::Impl {
 public:
     explicit Impl(Memory::MemorySystem& memory);
@@ -17,12 +29,46 @@ public:
     }
 
 private:
+    /// PCM16 output of one request, per channel
+    struct DecodedAudio {
+        bool success = false;
+        u32 sample_rate = 0;
+        u32 num_channels = 0;
+        u32 num_samples = 0;
+        std::array<std::vector<u8>, 2> out_streams;
+    };
+
+    /**
+     * A unit of work for the decode thread. AAC frames overlap with their predecessor, so a job
+     * records the input that precedes it; if the codec context last decoded something else, the
+     * predecessor is decoded first (and discarded) to bring the context into the right state.
+     */
+    struct DecodeJob {
+        u32 src_addr = 0;
+        std::vector<u8> input;
+        std::vector<u8> predecessor;
+        /// Decoded ahead of any request; its errors are only reported if it is requested
+        bool speculative = false;
+        bool cancelled = false;
+        bool done = false;
+        DecodedAudio result;
+    };
+
     std::optional<BinaryResponse> Initalize(const BinaryRequest& request);
 
     void Clear();
 
     std::optional<BinaryResponse> Decode(const BinaryRequest& request);
 
+    /// Queues speculative jobs for the ADTS frames following the last request.
+    void ScheduleDecodeAhead(u32 next_addr, const std::vector<u8>& last_input);
+    /// Cancels all queued jobs and waits for the decode thread to become idle.
+    void CancelAndWait(std::unique_lock<std::mutex>& lock);
+
+    void DecodeThread();
+    void RunJob(DecodeJob& job);
+    DecodedAudio DecodeBuffer(const std::vector<u8>& input, bool quiet);
+
     struct AVPacketDeleter {
         void operator()(AVPacket* packet) const {
             av_packet_free_dl(&packet);
@@ -52,18 +98,47 @@ private:
 
     Memory::MemorySystem& memory;
 
+    // The codec state below is only touched by the decode thread, or while it is idle.
     AVCodec* codec;
     std::unique_ptr<AVCodecContext, AVCodecContextDeleter> av_context;
     std::unique_ptr<AVCodecParserContext, AVCodecParserContextDeleter> parser;
     std::unique_ptr<AVPacket, AVPacketDeleter> av_packet;
     std::unique_ptr<AVFrame, AVFrameDeleter> decoded_frame;
+    /// Input most recently fed to av_context; empty if the context was just flushed
+    std::vector<u8> context_input;
+
+    std::mutex job_mutex;
+    std::condition_variable job_added;
+    std::condition_variable job_finished;
+    std::deque<std::shared_ptr<DecodeJob>> job_queue;
+    bool decode_thread_busy = false;
+    bool stop_decode_thread = false;
+    std::thread decode_thread;
+
+    // Emulation thread only
+    /// Speculative jobs in stream order, starting with the frame after the last request
+    std::deque<std::shared_ptr<DecodeJob>> decode_ahead;
+    /// Input of the last request
+    std::vector<u8> previous_input;
 };
 
 FFMPEGDecoder::Impl::Impl(Memory::MemorySystem& memory) : memory(memory) {
     have_ffmpeg_dl = InitFFmpegDL();
+    if (have_ffmpeg_dl) {
+        decode_thread = std::thread([this] { DecodeThread(); });
+    }
 }
 
-FFMPEGDecoder::Impl::~Impl() = default;
+FFMPEGDecoder::Impl::~Impl() {
+    if (decode_thread.joinable()) {
+        {
+            std::lock_guard lock{job_mutex};
+            stop_decode_thread = true;
+        }
+        job_added.notify_one();
+        decode_thread.join();
+    }
+}
 
 std::optional<BinaryResponse> FFMPEGDecoder::Impl::ProcessRequest(const BinaryRequest& request) {
     if (request.codec != DecoderCodec::AAC) {
@@ -91,10 +166,6 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::ProcessRequest(const BinaryRe
 }
 
 std::optional<BinaryResponse> FFMPEGDecoder::Impl::Initalize(const BinaryRequest& request) {
-    if (initalized) {
-        Clear();
-    }
-
     BinaryResponse response;
     std::memcpy(&response, &request, sizeof(response));
     response.unknown1 = 0x0;
@@ -103,6 +174,26 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::Initalize(const BinaryRequest
         return response;
     }
 
+    std::unique_lock lock{job_mutex};
+    CancelAndWait(lock);
+    decode_ahead.clear();
+    previous_input.clear();
+    context_input.clear();
+
+    if (initalized) {
+        // Keep the contexts warm across re-initialisation; flushing is enough to drop the state
+        // of the previous stream.
+        avcodec_flush_buffers_dl(av_context.get());
+        parser.reset(av_parser_init_dl(codec->id));
+        if (parser) {
+            return response;
+        }
+        LOG_ERROR(Audio_DSP, "Parser not found\n");
+        Clear();
+        initalized = false;
+        return response;
+    }
+
     av_packet.reset(av_packet_alloc_dl());
 
     codec = avcodec_find_decoder_dl(AV_CODEC_ID_AAC);
@@ -162,17 +253,174 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::Decode(const BinaryRequest& r
         LOG_ERROR(Audio_DSP, "Got out of bounds src_addr {:08x}", request.src_addr);
         return {};
     }
-    u8* data = memory.GetFCRAMPointer(request.src_addr - Memory::FCRAM_PADDR);
+    const u8* data = memory.GetFCRAMPointer(request.src_addr - Memory::FCRAM_PADDR);
+    std::vector<u8> input(data, data + request.size);
+
+    std::shared_ptr<DecodeJob> job;
+    {
+        std::unique_lock lock{job_mutex};
+
+        // Use the speculative result if the guest asked for the frame we predicted, and the
+        // frame data has not changed since we read it.
+        if (!decode_ahead.empty() && decode_ahead.front()->src_addr == request.src_addr &&
+            decode_ahead.front()->input == input) {
+            job = std::move(decode_ahead.front());
+            decode_ahead.pop_front();
+        } else {
+            for (auto& ahead : decode_ahead) {
+                ahead->cancelled = true;
+            }
+            decode_ahead.clear();
+
+            job = std::make_shared<DecodeJob>();
+            job->src_addr = request.src_addr;
+            job->input = input;
+            job->predecessor = previous_input;
+            job_queue.push_back(job);
+            job_added.notify_one();
+        }
+
+        job_finished.wait(lock, [&job] { return job->done; });
+    }
 
-    std::array<std::vector<u8>, 2> out_streams;
+    previous_input = std::move(input);
+    ScheduleDecodeAhead(request.src_addr + request.size, previous_input);
 
-    std::size_t data_size = request.size;
+    DecodedAudio& result = job->result;
+    if (!result.success) {
+        if (job->speculative) {
+            LOG_ERROR(Audio_DSP, "Could not decode the frame at {:08x}", request.src_addr);
+        }
+        return {};
+    }
+    if (result.num_samples != 0) {
+        response.sample_rate = GetSampleRateEnum(result.sample_rate);
+        response.num_channels = result.num_channels;
+        response.num_samples = result.num_samples;
+    }
+
+    const std::array<std::vector<u8>, 2>& out_streams = result.out_streams;
+    if (out_streams[0].size() != 0) {
+        if (request.dst_addr_ch0 < Memory::FCRAM_PADDR ||
+            request.dst_addr_ch0 + out_streams[0].size() >
+                Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
+            LOG_ERROR(Audio_DSP, "Got out of bounds dst_addr_ch0 {:08x}", request.dst_addr_ch0);
+            return {};
+        }
+        std::memcpy(memory.GetFCRAMPointer(request.dst_addr_ch0 - Memory::FCRAM_PADDR),
+                    out_streams[0].data(), out_streams[0].size());
+    }
+
+    if (out_streams[1].size() != 0) {
+        if (request.dst_addr_ch1 < Memory::FCRAM_PADDR ||
+            request.dst_addr_ch1 + out_streams[1].size() >
+                Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
+            LOG_ERROR(Audio_DSP, "Got out of bounds dst_addr_ch1 {:08x}", request.dst_addr_ch1);
+            return {};
+        }
+        std::memcpy(memory.GetFCRAMPointer(request.dst_addr_ch1 - Memory::FCRAM_PADDR),
+                    out_streams[1].data(), out_streams[1].size());
+    }
+    return response;
+}
+
+void FFMPEGDecoder::Impl::ScheduleDecodeAhead(u32 next_addr, const std::vector<u8>& last_input) {
+    std::lock_guard lock{job_mutex};
+
+    const std::vector<u8>* predecessor = &last_input;
+    if (!decode_ahead.empty()) {
+        const DecodeJob& last = *decode_ahead.back();
+        next_addr = last.src_addr + static_cast<u32>(last.input.size());
+        predecessor = &last.input;
+    }
+
+    while (decode_ahead.size() < decode_ahead_frames) {
+        // Games stream AAC as back-to-back ADTS frames, so the next frame's length is in its
+        // header. Anything else is simply not predicted.
+        if (next_addr < Memory::FCRAM_PADDR ||
+            next_addr + adts_header_size > Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
+            break;
+        }
+        const u8* data = memory.GetFCRAMPointer(next_addr - Memory::FCRAM_PADDR);
+        const ADTSData adts = ParseADTS(reinterpret_cast<const char*>(data));
+        if (adts.length <= adts_header_size ||
+            next_addr + adts.length > Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
+            break;
+        }
+
+        auto job = std::make_shared<DecodeJob>();
+        job->src_addr = next_addr;
+        job->input.assign(data, data + adts.length);
+        job->predecessor = *predecessor;
+        job->speculative = true;
+        job_queue.push_back(job);
+        decode_ahead.push_back(job);
+
+        next_addr += adts.length;
+        predecessor = &decode_ahead.back()->input;
+    }
+    job_added.notify_one();
+}
+
+void FFMPEGDecoder::Impl::CancelAndWait(std::unique_lock<std::mutex>& lock) {
+    for (auto& job : job_queue) {
+        job->cancelled = true;
+    }
+    job_finished.wait(lock, [this] { return job_queue.empty() && !decode_thread_busy; });
+}
+
+void FFMPEGDecoder::Impl::DecodeThread() {
+    std::unique_lock lock{job_mutex};
+    while (true) {
+        job_added.wait(lock, [this] { return stop_decode_thread || !job_queue.empty(); });
+        if (stop_decode_thread) {
+            return;
+        }
+
+        std::shared_ptr<DecodeJob> job = std::move(job_queue.front());
+        job_queue.pop_front();
+        if (!job->cancelled) {
+            decode_thread_busy = true;
+            lock.unlock();
+            RunJob(*job);
+            lock.lock();
+            decode_thread_busy = false;
+        }
+        job->done = true;
+        job_finished.notify_all();
+    }
+}
+
+void FFMPEGDecoder::Impl::RunJob(DecodeJob& job) {
+    if (context_input != job.predecessor) {
+        // The context holds the overlap of some other frame; reset it and replay the real
+        // predecessor so the output matches decoding the stream in order.
+        avcodec_flush_buffers_dl(av_context.get());
+        parser.reset(av_parser_init_dl(codec->id));
+        if (!job.predecessor.empty()) {
+            DecodeBuffer(job.predecessor, true);
+        }
+    }
+    job.result = DecodeBuffer(job.input, job.speculative);
+    context_input = job.input;
+}
+
+FFMPEGDecoder::Impl::DecodedAudio FFMPEGDecoder::Impl::DecodeBuffer(
+    const std::vector<u8>& input, bool quiet) {
+    // Frames decoded ahead may be whatever follows the stream in memory, so their errors are
+    // expected and not worth more than a debug message.
+    const Log::Level error_level = quiet ? Log::Level::Debug : Log::Level::Error;
+    DecodedAudio result;
+    std::array<std::vector<u8>, 2>& out_streams = result.out_streams;
+
+    const u8* data = input.data();
+    std::size_t data_size = input.size();
     while (data_size > 0) {
         if (!decoded_frame) {
             decoded_frame.reset(av_frame_alloc_dl());
             if (!decoded_frame) {
-                LOG_ERROR(Audio_DSP, "Could not allocate audio frame");
-                return {};
+                LOG_GENERIC(Log::Class::Audio_DSP, error_level, "Could not allocate audio frame");
+                return result;
             }
         }
 
@@ -180,16 +428,17 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::Decode(const BinaryRequest& r
             av_parser_parse2_dl(parser.get(), av_context.get(), &av_packet->data, &av_packet->size,
                                 data, data_size, AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
         if (ret < 0) {
-            LOG_ERROR(Audio_DSP, "Error while parsing");
-            return {};
+            LOG_GENERIC(Log::Class::Audio_DSP, error_level, "Error while parsing");
+            return result;
         }
         data += ret;
         data_size -= ret;
 
         ret = avcodec_send_packet_dl(av_context.get(), av_packet.get());
         if (ret < 0) {
-            LOG_ERROR(Audio_DSP, "Error submitting the packet to the decoder");
-            return {};
+            LOG_GENERIC(Log::Class::Audio_DSP, error_level,
+                        "Error submitting the packet to the decoder");
+            return result;
         }
 
         if (av_packet->size) {
@@ -198,22 +447,23 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::Decode(const BinaryRequest& r
                 if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
                     break;
                 else if (ret < 0) {
-                    LOG_ERROR(Audio_DSP, "Error during decoding");
-                    return {};
+                    LOG_GENERIC(Log::Class::Audio_DSP, error_level, "Error during decoding");
+                    return result;
                 }
                 int bytes_per_sample = av_get_bytes_per_sample_dl(av_context->sample_fmt);
                 if (bytes_per_sample < 0) {
-                    LOG_ERROR(Audio_DSP, "Failed to calculate data size");
-                    return {};
+                    LOG_GENERIC(Log::Class::Audio_DSP, error_level,
+                                "Failed to calculate data size");
+                    return result;
                 }
 
                 ASSERT(decoded_frame->channels <= out_streams.size());
 
                 std::size_t size = bytes_per_sample * (decoded_frame->nb_samples);
 
-                response.sample_rate = GetSampleRateEnum(decoded_frame->sample_rate);
-                response.num_channels = decoded_frame->channels;
-                response.num_samples += decoded_frame->nb_samples;
+                result.sample_rate = decoded_frame->sample_rate;
+                result.num_channels = decoded_frame->channels;
+                result.num_samples += decoded_frame->nb_samples;
 
                 // FFmpeg converts to 32 signed floating point PCM, we need s16 PCM so we need to
                 // convert it
@@ -228,33 +478,12 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::Decode(const BinaryRequest& r
                         out_streams[channel].push_back(val >> 8);
                     }
                     current_pos += sizeof(val_float);
-                }
             }
         }
     }
 
-    if (out_streams[0].size() != 0) {
-        if (request.dst_addr_ch0 < Memory::FCRAM_PADDR ||
-            request.dst_addr_ch0 + out_streams[0].size() >
-                Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
-            LOG_ERROR(Audio_DSP, "Got out of bounds dst_addr_ch0 {:08x}", request.dst_addr_ch0);
-            return {};
-        }
-        std::memcpy(memory.GetFCRAMPointer(request.dst_addr_ch0 - Memory::FCRAM_PADDR),
-                    out_streams[0].data(), out_streams[0].size());
-    }
-
-    if (out_streams[1].size() != 0) {
-        if (request.dst_addr_ch1 < Memory::FCRAM_PADDR ||
-            request.dst_addr_ch1 + out_streams[1].size() >
-                Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
-            LOG_ERROR(Audio_DSP, "Got out of bounds dst_addr_ch1 {:08x}", request.dst_addr_ch1);
-            return {};
-        }
-        std::memcpy(memory.GetFCRAMPointer(request.dst_addr_ch1 - Memory::FCRAM_PADDR),
-                    out_streams[1].data(), out_streams[1].size());
-    }
-    return response;
+    result.success = true;
+    return result;
 }
 
 FFMPEGDecoder::FFMPEGDecoder(Memory::MemorySystem& memory) : impl(std::make_unique<Impl>(memory)) {}
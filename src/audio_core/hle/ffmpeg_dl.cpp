@@ -36,6 +36,7 @@ FuncDL<void(AVPacket**)> av_packet_free_dl;
 FuncDL<AVCodec*(AVCodecID)> avcodec_find_decoder_dl;
 FuncDL<int(AVCodecContext*, const AVPacket*)> avcodec_send_packet_dl;
 FuncDL<int(AVCodecContext*, AVFrame*)> avcodec_receive_frame_dl;
+FuncDL<void(AVCodecContext*)> avcodec_flush_buffers_dl;
 FuncDL<AVCodecParserContext*(int)> av_parser_init_dl;
 FuncDL<int(AVCodecParserContext*, AVCodecContext*, uint8_t**, int*, const uint8_t*, int, int64_t,
            int64_t, int64_t)>
@@ -152,6 +153,13 @@ bool InitFFmpegDL() {
         return false;
     }
 
+    avcodec_flush_buffers_dl =
+        FuncDL<void(AVCodecContext*)>(dll_codec.get(), "avcodec_flush_buffers");
+    if (!avcodec_flush_buffers_dl) {
+        LOG_ERROR(Audio_DSP, "Can not load function avcodec_flush_buffers");
+        return false;
+    }
+
     av_parser_init_dl = FuncDL<AVCodecParserContext*(int)>(dll_codec.get(), "av_parser_init");
     if (!av_parser_init_dl) {
         LOG_ERROR(Audio_DSP, "Can not load function av_parser_init");
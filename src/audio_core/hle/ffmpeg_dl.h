@@ -45,6 +45,7 @@ extern FuncDL<void(AVPacket**)> av_packet_free_dl;
 extern FuncDL<AVCodec*(AVCodecID)> avcodec_find_decoder_dl;
 extern FuncDL<int(AVCodecContext*, const AVPacket*)> avcodec_send_packet_dl;
 extern FuncDL<int(AVCodecContext*, AVFrame*)> avcodec_receive_frame_dl;
+extern FuncDL<void(AVCodecContext*)> avcodec_flush_buffers_dl;
 extern FuncDL<AVCodecParserContext*(int)> av_parser_init_dl;
 extern FuncDL<int(AVCodecParserContext*, AVCodecContext*, uint8_t**, int*, const uint8_t*, int,
                   int64_t, int64_t, int64_t)>
@@ -68,6 +69,7 @@ const auto av_packet_free_dl = &av_packet_free;
 const auto avcodec_find_decoder_dl = &avcodec_find_decoder;
 const auto avcodec_send_packet_dl = &avcodec_send_packet;
 const auto avcodec_receive_frame_dl = &avcodec_receive_frame;
+const auto avcodec_flush_buffers_dl = &avcodec_flush_buffers;
 const auto av_parser_init_dl = &av_parser_init;
 const auto av_parser_parse2_dl = &av_parser_parse2;
 const auto av_parser_close_dl = &av_parser_close;
@@ -15,7 +15,7 @@
 #include "audio_core/hle/hle.h"
 #include "audio_core/hle/mixers.h"
 #include "audio_core/hle/shared_memory.h"
-#include "audio_core/hle/source.h"
+#include "audio_core/hle/source_mixer.h"
 #include "audio_core/sink.h"
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -23,6 +23,7 @@
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/settings.h"
 
 using InterruptType = Service::DSP::DSP_DSP::InterruptType;
 using Service::DSP::DSP_DSP;
@@ -65,13 +66,7 @@ private:
     std::array<std::vector<u8>, num_dsp_pipe> pipe_data{};
 
     HLE::DspMemory dsp_memory;
-    std::array<HLE::Source, HLE::num_sources> sources{{
-        HLE::Source(0),  HLE::Source(1),  HLE::Source(2),  HLE::Source(3),  HLE::Source(4),
-        HLE::Source(5),  HLE::Source(6),  HLE::Source(7),  HLE::Source(8),  HLE::Source(9),
-        HLE::Source(10), HLE::Source(11), HLE::Source(12), HLE::Source(13), HLE::Source(14),
-        HLE::Source(15), HLE::Source(16), HLE::Source(17), HLE::Source(18), HLE::Source(19),
-        HLE::Source(20), HLE::Source(21), HLE::Source(22), HLE::Source(23),
-    }};
+    HLE::SourceMixer sources;
     HLE::Mixers mixers;
 
     DspHle& parent;
@@ -85,9 +80,7 @@ private:
 DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory) : parent(parent_) {
     dsp_memory.raw_memory.fill(0);
 
-    for (auto& source : sources) {
-        source.SetMemory(memory);
-    }
+    sources.SetMemory(memory);
 
 #if defined(HAVE_MF) && defined(HAVE_FFMPEG)
     decoder = std::make_unique<HLE::WMFDecoder>(memory);
@@ -366,16 +359,11 @@ const StereoFrame16& DspHle::Impl::GenerateCurrentFrame() {
     HLE::SharedMemory& read = ReadRegion();
     HLE::SharedMemory& write = WriteRegion();
 
-    std::array<QuadFrame32, 3> intermediate_mixes = {};
-
-    // Generate intermediate mixes
-    for (std::size_t i = 0; i < HLE::num_sources; i++) {
-        write.source_statuses.status[i] =
-            sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
-        for (std::size_t mix = 0; mix < 3; mix++) {
-            sources[i].MixInto(intermediate_mixes[mix], mix);
-        }
-    }
+    // Generate intermediate mixes. The settings are read here so that the source workers never
+    // touch them.
+    const std::array<QuadFrame32, 3> intermediate_mixes =
+        sources.Tick(read.source_configurations, read.adpcm_coefficients, write.source_statuses,
+                     Settings::values.enable_polyphase_interpolation);
 
     // Generate final mix
     write.dsp_status = mixers.Tick(read.dsp_configuration, read.intermediate_mix_samples,
@@ -8,6 +8,7 @@
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
+#include "audio_core/mix.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
@@ -15,11 +16,11 @@
 namespace AudioCore::HLE {
 
 SourceStatus::Status Source::Tick(SourceConfiguration::Configuration& config,
-                                  const s16_le (&adpcm_coeffs)[16]) {
+                                  const s16_le (&adpcm_coeffs)[16], bool polyphase_enabled) {
     ParseConfig(config, adpcm_coeffs);
 
     if (state.enabled) {
-        GenerateFrame();
+        GenerateFrame(polyphase_enabled);
     }
 
     return GetCurrentStatus();
@@ -29,14 +30,8 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
     if (!state.enabled)
         return;
 
-    const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
-    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
-    }
+    // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+    Mix::MixStereoIntoQuad(dest, current_frame, state.gain.at(intermediate_mix_id));
 }
 
 void Source::Reset() {
@@ -251,7 +246,7 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
     config.dirty_raw = 0;
 }
 
-void Source::GenerateFrame() {
+void Source::GenerateFrame(bool polyphase_enabled) {
     current_frame.fill({});
 
     if (state.current_buffer.empty() && !DequeueBuffer()) {
@@ -279,11 +274,13 @@ void Source::GenerateFrame() {
                                 current_frame, frame_position);
             break;
         case InterpolationMode::Polyphase:
-            // TODO(merry): Implement polyphase interpolation
-            // LOG_DEBUG(Audio_DSP, "Polyphase interpolation unimplemented; falling back to
-            // linear");
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
+            if (polyphase_enabled) {
+                AudioInterp::Polyphase(state.interp_state, state.current_buffer,
+                                       state.rate_multiplier, current_frame, frame_position);
+            } else {
+                AudioInterp::Linear(state.interp_state, state.current_buffer,
+                                    state.rate_multiplier, current_frame, frame_position);
+            }
             break;
         default:
             UNIMPLEMENTED();
@@ -46,11 +46,13 @@ public:
      * @param config The new configuration we've got for this Source from the application.
      * @param adpcm_coeffs ADPCM coefficients to use if config tells us to use them (may contain
      * invalid values otherwise).
+     * @param polyphase_enabled Whether sources requesting polyphase interpolation get it, rather
+     * than falling back to linear interpolation.
      * @return The current status of this Source. This is given back to the emulated application via
      * SharedMemory.
      */
     SourceStatus::Status Tick(SourceConfiguration::Configuration& config,
-                              const s16_le (&adpcm_coeffs)[16]);
+                              const s16_le (&adpcm_coeffs)[16], bool polyphase_enabled);
 
     /**
      * Mix this source's output into dest, using the gains for the `intermediate_mix_id`-th
@@ -144,7 +146,7 @@ private:
     /// INTERNAL: Update our internal state based on the current config.
     void ParseConfig(SourceConfiguration::Configuration& config, const s16_le (&adpcm_coeffs)[16]);
     /// INTERNAL: Generate the current audio output for this frame based on our internal state.
-    void GenerateFrame();
+    void GenerateFrame(bool polyphase_enabled);
     /// INTERNAL: Dequeues a buffer and does preprocessing on it (decoding, resampling). Puts it
     /// into current_buffer.
     bool DequeueBuffer();
@@ -0,0 +1,78 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <thread>
+#include "audio_core/hle/source_mixer.h"
+#include "common/thread_pool.h"
+
+namespace AudioCore::HLE {
+
+SourceMixer::SourceMixer() = default;
+SourceMixer::~SourceMixer() = default;
+
+void SourceMixer::SetMemory(Memory::MemorySystem& memory) {
+    for (auto& source : sources) {
+        source.SetMemory(memory);
+    }
+}
+
+std::array<QuadFrame32, 3> SourceMixer::Tick(SourceConfiguration& configs,
+                                             const AdpcmCoefficients& adpcm_coeffs,
+                                             SourceStatus& statuses, bool polyphase_enabled) {
+    const auto num_enabled = static_cast<std::size_t>(
+        std::count_if(std::begin(configs.config), std::end(configs.config),
+                      [](const auto& config) { return config.enable != 0; }));
+
+    if (num_enabled >= parallel_threshold) {
+        if (!pool) {
+            // Leave one core for the thread calling Tick
+            const u32 num_threads = std::clamp(std::thread::hardware_concurrency(), 2u, 4u) - 1;
+            pool = std::make_unique<Common::ThreadPool>(num_threads, "DspHle Sources");
+        }
+        pool->ParallelFor(num_sources, sources_per_partition,
+                          [&](std::size_t begin, std::size_t end) {
+                              TickPartitions(configs, adpcm_coeffs, statuses, polyphase_enabled,
+                                             begin, end);
+                          });
+    } else {
+        TickPartitions(configs, adpcm_coeffs, statuses, polyphase_enabled, 0, num_sources);
+    }
+
+    std::array<QuadFrame32, 3> intermediate_mixes = partial_mixes[0];
+    for (std::size_t partition = 1; partition < num_partitions; partition++) {
+        for (std::size_t mix = 0; mix < 3; mix++) {
+            for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+                for (std::size_t channel = 0; channel < 4; channel++) {
+                    intermediate_mixes[mix][samplei][channel] +=
+                        partial_mixes[partition][mix][samplei][channel];
+                }
+            }
+        }
+    }
+    return intermediate_mixes;
+}
+
+void SourceMixer::TickPartitions(SourceConfiguration& configs,
+                                 const AdpcmCoefficients& adpcm_coeffs, SourceStatus& statuses,
+                                 bool polyphase_enabled, std::size_t begin, std::size_t end) {
+    // Sources only touch their own configuration and state.
+    for (std::size_t partition_begin = begin; partition_begin < end;
+         partition_begin += sources_per_partition) {
+        auto& mixes = partial_mixes[partition_begin / sources_per_partition];
+        for (auto& mix : mixes) {
+            mix.fill({});
+        }
+
+        for (std::size_t i = partition_begin; i < partition_begin + sources_per_partition; i++) {
+            statuses.status[i] =
+                sources[i].Tick(configs.config[i], adpcm_coeffs.coeff[i], polyphase_enabled);
+            for (std::size_t mix = 0; mix < 3; mix++) {
+                sources[i].MixInto(mixes[mix], mix);
+            }
+        }
+    }
+}
+
+} // namespace AudioCore::HLE
@@ -0,0 +1,75 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include "audio_core/audio_types.h"
+#include "audio_core/hle/common.h"
+#include "audio_core/hle/shared_memory.h"
+#include "audio_core/hle/source.h"
+
+namespace Common {
+class ThreadPool;
+}
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace AudioCore::HLE {
+
+/**
+ * Ticks all sources of the DSP and mixes them into the three intermediate mixes. Sources are
+ * ticked in fixed partitions that each mix into their own buffers, and the partitions are summed in
+ * a fixed order, so a frame is the same whether or not the partitions ran in parallel.
+ */
+class SourceMixer final {
+public:
+    /// Sources are ticked in partitions of this size
+    static constexpr std::size_t sources_per_partition = 6;
+    static constexpr std::size_t num_partitions = num_sources / sources_per_partition;
+    static_assert(num_sources % sources_per_partition == 0);
+
+    /// Minimum number of enabled sources for which ticking them in parallel pays off
+    static constexpr std::size_t parallel_threshold = 8;
+
+    SourceMixer();
+    ~SourceMixer();
+
+    /// Sets the memory system the sources read their buffers from
+    void SetMemory(Memory::MemorySystem& memory);
+
+    /**
+     * Ticks every source for one audio frame. The calling thread takes part in a parallel tick and
+     * waits for it to finish.
+     * @param configs The source configurations from the application.
+     * @param adpcm_coeffs The ADPCM coefficients of every source.
+     * @param statuses Receives the status of every source.
+     * @param polyphase_enabled Whether sources requesting polyphase interpolation get it.
+     * @return The three intermediate mixes.
+     */
+    std::array<QuadFrame32, 3> Tick(SourceConfiguration& configs,
+                                    const AdpcmCoefficients& adpcm_coeffs, SourceStatus& statuses,
+                                    bool polyphase_enabled);
+
+private:
+    void TickPartitions(SourceConfiguration& configs, const AdpcmCoefficients& adpcm_coeffs,
+                        SourceStatus& statuses, bool polyphase_enabled, std::size_t begin,
+                        std::size_t end);
+
+    std::array<Source, num_sources> sources{{
+        Source(0),  Source(1),  Source(2),  Source(3),  Source(4),  Source(5),
+        Source(6),  Source(7),  Source(8),  Source(9),  Source(10), Source(11),
+        Source(12), Source(13), Source(14), Source(15), Source(16), Source(17),
+        Source(18), Source(19), Source(20), Source(21), Source(22), Source(23),
+    }};
+    std::array<std::array<QuadFrame32, 3>, num_partitions> partial_mixes{};
+
+    /// Workers ticking partitions in parallel, started by the first busy frame
+    std::unique_ptr<Common::ThreadPool> pool;
+};
+
+} // namespace AudioCore::HLE
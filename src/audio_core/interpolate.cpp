@@ -3,6 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
 
@@ -73,4 +79,172 @@ void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& outp
                     });
 }
 
+namespace {
+
+constexpr std::size_t polyphase_phase_bits = 5;
+constexpr std::size_t polyphase_phases = 1 << polyphase_phase_bits;
+/// Filter coefficients are fixed point with this many fractional bits.
+constexpr int polyphase_coeff_bits = 14;
+
+/// Filter bank for one cutoff, with coefficients for each of polyphase_phases fractional positions
+struct PolyphaseBank {
+    /// Highest rate this bank is used for
+    float max_rate;
+    alignas(16) std::array<std::array<s16, polyphase_taps>, polyphase_phases> coeffs;
+};
+
+constexpr std::array<float, 6> polyphase_bank_rates = {{1.0f, 1.25f, 1.5f, 2.0f, 3.0f, 4.0f}};
+
+PolyphaseBank MakePolyphaseBank(float max_rate) {
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double half_width = polyphase_taps / 2.0;
+    // Leave a little room below Nyquist for the transition band of the short filter.
+    const double cutoff = 0.95 / max_rate;
+
+    PolyphaseBank bank;
+    bank.max_rate = max_rate;
+    for (std::size_t phase = 0; phase < polyphase_phases; phase++) {
+        // The interpolated point lies between taps polyphase_taps / 2 - 1 and polyphase_taps / 2.
+        const double fraction = static_cast<double>(phase) / polyphase_phases;
+        std::array<double, polyphase_taps> taps;
+        double sum = 0.0;
+        for (std::size_t tap = 0; tap < polyphase_taps; tap++) {
+            const double t = static_cast<double>(tap) - (half_width - 1.0) - fraction;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(pi * cutoff * t) / (pi * cutoff * t);
+            // Blackman window over [-half_width, half_width]
+            const double w = (t + half_width) / (2.0 * half_width);
+            const double window =
+                0.42 - 0.5 * std::cos(2.0 * pi * w) + 0.08 * std::cos(4.0 * pi * w);
+            taps[tap] = sinc * window;
+            sum += taps[tap];
+        }
+        // Normalize each phase to unity gain at DC
+        for (std::size_t tap = 0; tap < polyphase_taps; tap++) {
+            bank.coeffs[phase][tap] =
+                static_cast<s16>(std::lround(taps[tap] / sum * (1 << polyphase_coeff_bits)));
+        }
+    }
+    return bank;
+}
+
+const PolyphaseBank& GetPolyphaseBank(float rate) {
+    static const auto banks = [] {
+        std::array<PolyphaseBank, polyphase_bank_rates.size()> banks;
+        for (std::size_t i = 0; i < banks.size(); i++) {
+            banks[i] = MakePolyphaseBank(polyphase_bank_rates[i]);
+        }
+        return banks;
+    }();
+
+    for (const auto& bank : banks) {
+        if (rate <= bank.max_rate) {
+            return bank;
+        }
+    }
+    return banks.back();
+}
+
+#if !defined(ARCHITECTURE_x86_64)
+s16 RoundFilterSum(s32 sum) {
+    constexpr s32 rounding = 1 << (polyphase_coeff_bits - 1);
+    return static_cast<s16>(std::clamp((sum + rounding) >> polyphase_coeff_bits, -32768, 32767));
+}
+#endif
+
+/// Applies one phase of the filter to polyphase_taps samples of each channel.
+std::array<s16, 2> PolyphaseSample(const s16* left, const s16* right, const s16* coeffs) {
+#if defined(ARCHITECTURE_x86_64)
+    static_assert(polyphase_taps == 8);
+    const __m128i c = _mm_load_si128(reinterpret_cast<const __m128i*>(coeffs));
+    const __m128i l = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left)), c);
+    const __m128i r = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right)), c);
+    // Horizontally add both channels at once, leaving the left sum in lane 0 and right in lane 1.
+    __m128i sum = _mm_add_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r));
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+    const __m128i rounding = _mm_set1_epi32(1 << (polyphase_coeff_bits - 1));
+    sum = _mm_srai_epi32(_mm_add_epi32(sum, rounding), polyphase_coeff_bits);
+    const u32 packed = static_cast<u32>(_mm_cvtsi128_si32(_mm_packs_epi32(sum, sum)));
+    return {static_cast<s16>(packed & 0xFFFF), static_cast<s16>(packed >> 16)};
+#elif defined(ARCHITECTURE_ARM64)
+    static_assert(polyphase_taps == 8);
+    const int16x8_t c = vld1q_s16(coeffs);
+    const int16x8_t l = vld1q_s16(left);
+    const int16x8_t r = vld1q_s16(right);
+    const s32 sum_l = vaddvq_s32(
+        vmlal_s16(vmull_s16(vget_low_s16(l), vget_low_s16(c)), vget_high_s16(l), vget_high_s16(c)));
+    const s32 sum_r = vaddvq_s32(
+        vmlal_s16(vmull_s16(vget_low_s16(r), vget_low_s16(c)), vget_high_s16(r), vget_high_s16(c)));
+    return {RoundFilterSum(sum_l), RoundFilterSum(sum_r)};
+#else
+    s32 sum_l = 0;
+    s32 sum_r = 0;
+    for (std::size_t tap = 0; tap < polyphase_taps; tap++) {
+        sum_l += left[tap] * coeffs[tap];
+        sum_r += right[tap] * coeffs[tap];
+    }
+    return {RoundFilterSum(sum_l), RoundFilterSum(sum_r)};
+#endif
+}
+
+} // Anonymous namespace
+
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi) {
+    ASSERT(rate > 0);
+
+    if (input.empty())
+        return;
+
+    constexpr std::size_t history_size = polyphase_taps - 1;
+    const PolyphaseBank& bank = GetPolyphaseBank(rate);
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    u64 fposition = state.fposition;
+    s16* const left = state.polyphase_buffer[0].data();
+    s16* const right = state.polyphase_buffer[1].data();
+
+    while (outputi < output.size() && !input.empty()) {
+        // Deinterleave the history and as much input as the rest of this frame can consume, up to
+        // a chunk at a time, into contiguous per-channel buffers for the filter.
+        const u64 end_position = fposition + step_size * (output.size() - outputi);
+        const std::size_t available = std::min<std::size_t>(
+            {input.size(), end_position / scale_factor + 1, polyphase_chunk_size});
+        const std::size_t total = history_size + available;
+        for (std::size_t i = 0; i < history_size; i++) {
+            left[i] = state.polyphase_history[i][0];
+            right[i] = state.polyphase_history[i][1];
+        }
+        auto it = input.begin();
+        for (std::size_t i = history_size; i < total; i++, ++it) {
+            left[i] = (*it)[0];
+            right[i] = (*it)[1];
+        }
+
+        while (outputi < output.size()) {
+            const std::size_t inputi = static_cast<std::size_t>(fposition / scale_factor);
+            if (inputi + polyphase_taps > total) {
+                break;
+            }
+
+            const u64 phase = (fposition & scale_mask) >> (24 - polyphase_phase_bits);
+            output[outputi++] =
+                PolyphaseSample(left + inputi, right + inputi, bank.coeffs[phase].data());
+
+            fposition += step_size;
+        }
+
+        // Keep the samples the next output still depends on as history. Running out of chunk
+        // consumes all of it, so every iteration either fills the frame or makes progress.
+        const std::size_t consumed =
+            std::min<std::size_t>(static_cast<std::size_t>(fposition / scale_factor), available);
+        for (std::size_t i = 0; i < history_size; i++) {
+            state.polyphase_history[i] = {left[consumed + i], right[consumed + i]};
+        }
+        fposition -= consumed * scale_factor;
+
+        input.erase(input.begin(), std::next(input.begin(), consumed));
+    }
+
+    state.fposition = fposition;
+}
+
 } // namespace AudioCore::AudioInterp
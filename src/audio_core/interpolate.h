@@ -14,10 +14,19 @@ namespace AudioCore::AudioInterp {
 /// A variable length buffer of signed PCM16 stereo samples.
 using AudioCore::StereoBuffer16;
 
+/// Number of input samples each output sample of Polyphase is computed from.
+constexpr std::size_t polyphase_taps = 8;
+/// Number of input samples Polyphase deinterleaves at once.
+constexpr std::size_t polyphase_chunk_size = 256;
+
 struct State {
     /// Two historical samples.
     std::array<s16, 2> xn1 = {}; ///< x[n-1]
     std::array<s16, 2> xn2 = {}; ///< x[n-2]
+    /// Historical samples used by Polyphase, oldest first.
+    std::array<std::array<s16, 2>, polyphase_taps - 1> polyphase_history = {};
+    /// Per-channel scratch space Polyphase deinterleaves the history and input into.
+    std::array<std::array<s16, polyphase_taps - 1 + polyphase_chunk_size>, 2> polyphase_buffer = {};
     /// Current fractional position.
     u64 fposition = 0;
 };
@@ -46,4 +55,17 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi);
 
+/**
+ * Windowed sinc interpolation using precomputed polyphase filter banks. The cutoff of the filter
+ * is lowered when decimating to suppress aliasing. There is a polyphase_taps / 2 sample predelay.
+ * @param state Interpolation state.
+ * @param input Input buffer.
+ * @param rate Stretch factor. Must be a positive non-zero value.
+ *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
+ * @param output The resampled audio buffer.
+ * @param outputi The index of output to start writing to.
+ */
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi);
+
 } // namespace AudioCore::AudioInterp
@@ -4,6 +4,8 @@
 
 #include <array>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #include <teakra/teakra.h>
 #include "audio_core/lle/lle.h"
@@ -11,6 +13,7 @@
 #include "common/bit_field.h"
 #include "common/swap.h"
 #include "common/thread.h"
+#include "common/threadsafe_queue.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/lock.h"
@@ -139,46 +142,179 @@ struct DspLle::Impl final {
     Core::TimingEventType* teakra_slice_event;
     std::atomic<bool> loaded = false;
 
+    static constexpr u32 DspDataOffset = 0x40000;
+    static constexpr u32 TeakraSlice = 20000;
+
+    // In multithreaded mode Teakra runs on its own thread, ahead of the emulated CPU by at most
+    // MaxLeadSlices slices. The emulation thread only waits for it when it falls more than
+    // MaxLagSlices behind, or when the guest accesses DSP registers or pipes, in which case the
+    // Teakra thread is paused and the emulation thread steps Teakra itself.
+    static constexpr u64 MaxLeadSlices = 4;
+    static constexpr u64 MaxLagSlices = 8;
+
     const bool multithread;
     std::thread teakra_thread;
-    Common::Barrier teakra_slice_barrier{2};
     std::atomic<bool> stop_signal = false;
-    std::size_t stop_generation;
 
-    static constexpr u32 DspDataOffset = 0x40000;
-    static constexpr u32 TeakraSlice = 20000;
+    /// Held by the thread currently executing Teakra
+    std::mutex teakra_mutex;
+    std::unique_lock<std::mutex> exclusive_lock{teakra_mutex, std::defer_lock};
+    /// Nesting depth of ExclusiveAccess on the emulation thread
+    std::size_t exclusive_depth = 0;
+
+    std::mutex progress_mutex;
+    std::condition_variable progress_cv;
+    std::atomic<u64> slices_allowed = 0;
+    std::atomic<u64> slices_run = 0;
+
+    struct PendingInterrupt {
+        Service::DSP::DSP_DSP::InterruptType type;
+        DspPipe pipe;
+    };
+
+    std::weak_ptr<Service::DSP::DSP_DSP> dsp_dsp;
+    /// Semaphore writes from the emulation thread, applied before the next Teakra slice
+    Common::SPSCQueue<u16> semaphore_writes;
+    /// Interrupts raised by Teakra, signalled on the emulation thread
+    Common::SPSCQueue<PendingInterrupt> pending_interrupts;
+
+    /// Gives the emulation thread exclusive access to Teakra for its lifetime
+    class ExclusiveAccess {
+    public:
+        explicit ExclusiveAccess(Impl& impl) : impl(impl) {
+            impl.AcquireTeakra();
+        }
+        ~ExclusiveAccess() {
+            impl.ReleaseTeakra();
+        }
+
+    private:
+        Impl& impl;
+    };
+
+    void AcquireTeakra() {
+        if (!multithread) {
+            return;
+        }
+        if (exclusive_depth++ == 0) {
+            exclusive_lock.lock();
+            ApplySemaphoreWrites();
+        }
+    }
+
+    void ReleaseTeakra() {
+        if (!multithread) {
+            return;
+        }
+        if (--exclusive_depth == 0) {
+            exclusive_lock.unlock();
+            DrainInterrupts();
+        }
+    }
+
+    void NotifyProgress() {
+        // Acquire the mutex and then immediately release it as a fence, so that waiters cannot
+        // miss the update between checking their condition and going to sleep.
+        {
+            std::lock_guard lock{progress_mutex};
+        }
+        progress_cv.notify_all();
+    }
+
+    void ApplySemaphoreWrites() {
+        u16 value;
+        while (semaphore_writes.Pop(value)) {
+            teakra.SetSemaphore(value);
+        }
+    }
+
+    void SetSemaphore(u16 value) {
+        if (multithread) {
+            semaphore_writes.Push(value);
+        } else {
+            teakra.SetSemaphore(value);
+        }
+    }
+
+    void SignalInterruptNow(const PendingInterrupt& interrupt) {
+        std::lock_guard lock(HLE::g_hle_lock);
+        if (auto locked = dsp_dsp.lock()) {
+            locked->SignalInterrupt(interrupt.type, interrupt.pipe);
+        }
+    }
+
+    void SignalInterrupt(Service::DSP::DSP_DSP::InterruptType type, DspPipe pipe) {
+        if (multithread) {
+            pending_interrupts.Push(PendingInterrupt{type, pipe});
+        } else {
+            SignalInterruptNow({type, pipe});
+        }
+    }
+
+    void DrainInterrupts() {
+        PendingInterrupt interrupt;
+        while (pending_interrupts.Pop(interrupt)) {
+            SignalInterruptNow(interrupt);
+        }
+    }
 
     void TeakraThread() {
+        Common::SetCurrentThreadName("Teakra");
         while (true) {
-            teakra.Run(TeakraSlice);
-            teakra_slice_barrier.Sync();
-            if (stop_signal) {
-                if (stop_generation == teakra_slice_barrier.Generation())
+            {
+                std::unique_lock lock{progress_mutex};
+                progress_cv.wait(lock,
+                                 [this] { return stop_signal || slices_run < slices_allowed; });
+                if (stop_signal) {
                     break;
+                }
             }
+            {
+                std::lock_guard lock{teakra_mutex};
+                ApplySemaphoreWrites();
+                RunTeakraSlice();
+            }
+            NotifyProgress();
         }
+    }
+
+    void StartTeakraThread() {
+        slices_run = 0;
+        slices_allowed = MaxLeadSlices;
         stop_signal = false;
+        teakra_thread = std::thread(&Impl::TeakraThread, this);
     }
 
     void StopTeakraThread() {
         if (teakra_thread.joinable()) {
-            stop_generation = teakra_slice_barrier.Generation() + 1;
             stop_signal = true;
-            teakra_slice_barrier.Sync();
+            NotifyProgress();
             teakra_thread.join();
         }
     }
 
+    /// Runs one slice of Teakra on the calling thread, which must have access to it
     void RunTeakraSlice() {
+        teakra.Run(TeakraSlice);
         if (multithread) {
-            teakra_slice_barrier.Sync();
-        } else {
-            teakra.Run(TeakraSlice);
+            ++slices_run;
         }
     }
 
     void TeakraSliceEvent(u64 late) {
-        RunTeakraSlice();
+        if (multithread) {
+            const u64 allowed = ++slices_allowed;
+            NotifyProgress();
+            {
+                std::unique_lock lock{progress_mutex};
+                progress_cv.wait(lock, [this, allowed] {
+                    return stop_signal || slices_run + MaxLeadSlices + MaxLagSlices >= allowed;
+                });
+            }
+            DrainInterrupts();
+        } else {
+            RunTeakraSlice();
+        }
         u64 next = TeakraSlice * 2; // DSP runs at clock rate half of the CPU rate
         if (next < late)
             next = 0;
@@ -328,9 +464,11 @@ struct DspLle::Impl final {
         Core::System::GetInstance().CoreTiming().ScheduleEvent(TeakraSlice, teakra_slice_event, 0);
 
         if (multithread) {
-            teakra_thread = std::thread(&Impl::TeakraThread, this);
+            StartTeakraThread();
         }
 
+        ExclusiveAccess access{*this};
+
         // Wait for initialization
         if (dsp.recv_data_on_start) {
             for (u8 i = 0; i < 3; ++i) {
@@ -357,18 +495,22 @@ struct DspLle::Impl final {
 
         loaded = false;
 
-        // Send finalization signal via command/reply register 2
-        constexpr u16 FinalizeSignal = 0x8000;
-        while (!teakra.SendDataIsEmpty(2))
-            RunTeakraSlice();
+        {
+            ExclusiveAccess access{*this};
 
-        teakra.SendData(2, FinalizeSignal);
+            // Send finalization signal via command/reply register 2
+            constexpr u16 FinalizeSignal = 0x8000;
+            while (!teakra.SendDataIsEmpty(2))
+                RunTeakraSlice();
 
-        // Wait for completion
-        while (!teakra.RecvDataIsReady(2))
-            RunTeakraSlice();
+            teakra.SendData(2, FinalizeSignal);
 
-        teakra.RecvData(2); // discard the value
+            // Wait for completion
+            while (!teakra.RecvDataIsReady(2))
+                RunTeakraSlice();
+
+            teakra.RecvData(2); // discard the value
+        }
 
         Core::System::GetInstance().CoreTiming().UnscheduleEvent(teakra_slice_event, 0);
         StopTeakraThread();
@@ -376,6 +518,7 @@ struct DspLle::Impl final {
 };
 
 u16 DspLle::RecvData(u32 register_number) {
+    Impl::ExclusiveAccess access{*impl};
     while (!impl->teakra.RecvDataIsReady(register_number)) {
         impl->RunTeakraSlice();
     }
@@ -383,22 +526,26 @@ u16 DspLle::RecvData(u32 register_number) {
 }
 
 bool DspLle::RecvDataIsReady(u32 register_number) const {
+    Impl::ExclusiveAccess access{*impl};
     return impl->teakra.RecvDataIsReady(register_number);
 }
 
 void DspLle::SetSemaphore(u16 semaphore_value) {
-    impl->teakra.SetSemaphore(semaphore_value);
+    impl->SetSemaphore(semaphore_value);
 }
 
 std::vector<u8> DspLle::PipeRead(DspPipe pipe_number, u32 length) {
+    Impl::ExclusiveAccess access{*impl};
     return impl->ReadPipe(static_cast<u8>(pipe_number), static_cast<u16>(length));
 }
 
 std::size_t DspLle::GetPipeReadableSize(DspPipe pipe_number) const {
+    Impl::ExclusiveAccess access{*impl};
     return impl->GetPipeReadableSize(static_cast<u8>(pipe_number));
 }
 
 void DspLle::PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer) {
+    Impl::ExclusiveAccess access{*impl};
     impl->WritePipe(static_cast<u8>(pipe_number), buffer);
 }
 
@@ -407,28 +554,22 @@ std::array<u8, Memory::DSP_RAM_SIZE>& DspLle::GetDspMemory() {
 }
 
 void DspLle::SetServiceToInterrupt(std::weak_ptr<Service::DSP::DSP_DSP> dsp) {
-    impl->teakra.SetRecvDataHandler(0, [this, dsp]() {
+    impl->dsp_dsp = std::move(dsp);
+
+    impl->teakra.SetRecvDataHandler(0, [this]() {
         if (!impl->loaded)
             return;
 
-        std::lock_guard lock(HLE::g_hle_lock);
-        if (auto locked = dsp.lock()) {
-            locked->SignalInterrupt(Service::DSP::DSP_DSP::InterruptType::Zero,
-                                    static_cast<DspPipe>(0));
-        }
+        impl->SignalInterrupt(Service::DSP::DSP_DSP::InterruptType::Zero, static_cast<DspPipe>(0));
     });
-    impl->teakra.SetRecvDataHandler(1, [this, dsp]() {
+    impl->teakra.SetRecvDataHandler(1, [this]() {
         if (!impl->loaded)
             return;
 
-        std::lock_guard lock(HLE::g_hle_lock);
-        if (auto locked = dsp.lock()) {
-            locked->SignalInterrupt(Service::DSP::DSP_DSP::InterruptType::One,
-                                    static_cast<DspPipe>(0));
-        }
+        impl->SignalInterrupt(Service::DSP::DSP_DSP::InterruptType::One, static_cast<DspPipe>(0));
     });
 
-    auto ProcessPipeEvent = [this, dsp](bool event_from_data) {
+    auto ProcessPipeEvent = [this](bool event_from_data) {
         if (!impl->loaded)
             return;
 
@@ -452,11 +593,8 @@ void DspLle::SetServiceToInterrupt(std::weak_ptr<Service::DSP::DSP_DSP> dsp) {
                 // pipe 0 is for debug. 3DS automatically drains this pipe and discards the data
                 impl->ReadPipe(pipe, impl->GetPipeReadableSize(pipe));
             } else {
-                std::lock_guard lock(HLE::g_hle_lock);
-                if (auto locked = dsp.lock()) {
-                    locked->SignalInterrupt(Service::DSP::DSP_DSP::InterruptType::Pipe,
-                                            static_cast<DspPipe>(pipe));
-                }
+                impl->SignalInterrupt(Service::DSP::DSP_DSP::InterruptType::Pipe,
+                                      static_cast<DspPipe>(pipe));
             }
         }
     };
@@ -0,0 +1,176 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstddef>
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
+#include "audio_core/mix.h"
+
+namespace AudioCore::Mix {
+
+// The vectorized kernels process four samples at a time and rely on truncating float to integer
+// conversions and saturating 16 bit additions, so they produce the same output as the scalar ones.
+static_assert(samples_per_frame % 4 == 0);
+
+#if !defined(ARCHITECTURE_x86_64) && !defined(ARCHITECTURE_ARM64)
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
+                                           const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+#endif
+
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                       const std::array<float, 4>& gains) {
+#if defined(ARCHITECTURE_x86_64)
+    const __m128 gain = _mm_loadu_ps(gains.data());
+    const auto mix_sample = [&](std::size_t samplei, __m128i sample) {
+        // sample holds the stereo pair in every 32 bit lane; widen it to L R L R.
+        const __m128i widened = _mm_srai_epi32(_mm_unpacklo_epi16(sample, sample), 16);
+        const __m128i scaled = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(widened), gain));
+        __m128i* out = reinterpret_cast<__m128i*>(dest[samplei].data());
+        _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), scaled));
+    };
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        const __m128i samples =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source[samplei].data()));
+        mix_sample(samplei + 0, _mm_shuffle_epi32(samples, _MM_SHUFFLE(0, 0, 0, 0)));
+        mix_sample(samplei + 1, _mm_shuffle_epi32(samples, _MM_SHUFFLE(1, 1, 1, 1)));
+        mix_sample(samplei + 2, _mm_shuffle_epi32(samples, _MM_SHUFFLE(2, 2, 2, 2)));
+        mix_sample(samplei + 3, _mm_shuffle_epi32(samples, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+#elif defined(ARCHITECTURE_ARM64)
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        const int16x4x2_t samples = vld2_s16(source[samplei].data());
+        const float32x4_t left = vcvtq_f32_s32(vmovl_s16(samples.val[0]));
+        const float32x4_t right = vcvtq_f32_s32(vmovl_s16(samples.val[1]));
+        int32x4x4_t out = vld4q_s32(dest[samplei].data());
+        out.val[0] = vaddq_s32(out.val[0], vcvtq_s32_f32(vmulq_n_f32(left, gains[0])));
+        out.val[1] = vaddq_s32(out.val[1], vcvtq_s32_f32(vmulq_n_f32(right, gains[1])));
+        out.val[2] = vaddq_s32(out.val[2], vcvtq_s32_f32(vmulq_n_f32(left, gains[2])));
+        out.val[3] = vaddq_s32(out.val[3], vcvtq_s32_f32(vmulq_n_f32(right, gains[3])));
+        vst4q_s32(dest[samplei].data(), out);
+    }
+#else
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        dest[samplei][0] += static_cast<s32>(gains[0] * source[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * source[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * source[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * source[samplei][1]);
+    }
+#endif
+}
+
+void DownmixQuadIntoStereo(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+#if defined(ARCHITECTURE_x86_64)
+    const __m128 scale = _mm_set1_ps(gain);
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        const auto load = [&](std::size_t i) {
+            return _mm_cvtepi32_ps(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(source[samplei + i].data())));
+        };
+        __m128 channel0 = load(0), channel1 = load(1), channel2 = load(2), channel3 = load(3);
+        _MM_TRANSPOSE4_PS(channel0, channel1, channel2, channel3);
+
+        const __m128i left = _mm_cvttps_epi32(
+            _mm_add_ps(_mm_mul_ps(scale, channel0), _mm_mul_ps(scale, channel2)));
+        const __m128i right = _mm_cvttps_epi32(
+            _mm_add_ps(_mm_mul_ps(scale, channel1), _mm_mul_ps(scale, channel3)));
+        const __m128i packed = _mm_packs_epi32(left, right);
+        const __m128i stereo = _mm_unpacklo_epi16(packed, _mm_srli_si128(packed, 8));
+
+        __m128i* out = reinterpret_cast<__m128i*>(dest[samplei].data());
+        _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), stereo));
+    }
+#elif defined(ARCHITECTURE_ARM64)
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        const int32x4x4_t samples = vld4q_s32(source[samplei].data());
+        const auto scaled = [&](int channel) {
+            return vmulq_n_f32(vcvtq_f32_s32(samples.val[channel]), gain);
+        };
+        const int32x4_t left = vcvtq_s32_f32(vaddq_f32(scaled(0), scaled(2)));
+        const int32x4_t right = vcvtq_s32_f32(vaddq_f32(scaled(1), scaled(3)));
+
+        int16x4x2_t out = vld2_s16(dest[samplei].data());
+        out.val[0] = vqadd_s16(out.val[0], vqmovn_s32(left));
+        out.val[1] = vqadd_s16(out.val[1], vqmovn_s32(right));
+        vst2_s16(dest[samplei].data(), out);
+    }
+#else
+    std::transform(dest.begin(), dest.end(), source.begin(), dest.begin(),
+                   [gain](const std::array<s16, 2>& accumulator,
+                          const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+                       // Downmix to stereo
+                       s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+                       s16 right =
+                           ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+                       // Mix into current frame
+                       return AddAndClampToS16(accumulator, {left, right});
+                   });
+#endif
+}
+
+void DownmixQuadIntoMono(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+#if defined(ARCHITECTURE_x86_64)
+    const __m128 scale = _mm_set1_ps(gain);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        const auto load = [&](std::size_t i) {
+            return _mm_cvtepi32_ps(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(source[samplei + i].data())));
+        };
+        __m128 channel0 = load(0), channel1 = load(1), channel2 = load(2), channel3 = load(3);
+        _MM_TRANSPOSE4_PS(channel0, channel1, channel2, channel3);
+
+        // Summed in the same order as the scalar path so that rounding matches.
+        __m128 sum = _mm_add_ps(_mm_mul_ps(scale, channel0), _mm_mul_ps(scale, channel1));
+        sum = _mm_add_ps(sum, _mm_mul_ps(scale, channel2));
+        sum = _mm_add_ps(sum, _mm_mul_ps(scale, channel3));
+        const __m128i mono = _mm_cvttps_epi32(_mm_mul_ps(sum, half));
+        const __m128i packed = _mm_packs_epi32(mono, mono);
+
+        __m128i* out = reinterpret_cast<__m128i*>(dest[samplei].data());
+        _mm_storeu_si128(out,
+                         _mm_adds_epi16(_mm_loadu_si128(out), _mm_unpacklo_epi16(packed, packed)));
+    }
+#elif defined(ARCHITECTURE_ARM64)
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        const int32x4x4_t samples = vld4q_s32(source[samplei].data());
+        const auto scaled = [&](int channel) {
+            return vmulq_n_f32(vcvtq_f32_s32(samples.val[channel]), gain);
+        };
+        // Summed in the same order as the scalar path so that rounding matches.
+        float32x4_t sum = vaddq_f32(scaled(0), scaled(1));
+        sum = vaddq_f32(sum, scaled(2));
+        sum = vaddq_f32(sum, scaled(3));
+        const int16x4_t mono = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(sum, 0.5f)));
+
+        int16x4x2_t out = vld2_s16(dest[samplei].data());
+        out.val[0] = vqadd_s16(out.val[0], mono);
+        out.val[1] = vqadd_s16(out.val[1], mono);
+        vst2_s16(dest[samplei].data(), out);
+    }
+#else
+    std::transform(
+        dest.begin(), dest.end(), source.begin(), dest.begin(),
+        [gain](const std::array<s16, 2>& accumulator,
+               const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+            // Downmix to mono
+            s16 mono = ClampToS16(static_cast<s32>(
+                (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+            // Mix into current frame
+            return AddAndClampToS16(accumulator, {mono, mono});
+        });
+#endif
+}
+
+} // namespace AudioCore::Mix
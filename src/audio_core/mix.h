@@ -0,0 +1,38 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "audio_core/audio_types.h"
+
+namespace AudioCore::Mix {
+
+/**
+ * Applies per-channel gains to a stereo frame and accumulates it into a quadraphonic frame.
+ * Channels 0 and 2 of dest receive the left input channel, channels 1 and 3 the right.
+ * @param dest The QuadFrame32 to mix into.
+ * @param source The stereo frame to mix.
+ * @param gains Gain of each of the four output channels.
+ */
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                       const std::array<float, 4>& gains);
+
+/**
+ * Downmixes a quadraphonic frame to stereo and mixes it into dest with saturation.
+ * @param dest The StereoFrame16 to mix into.
+ * @param source The quadraphonic frame to downmix.
+ * @param gain Gain applied to every channel of source.
+ */
+void DownmixQuadIntoStereo(StereoFrame16& dest, const QuadFrame32& source, float gain);
+
+/**
+ * Downmixes a quadraphonic frame to mono and mixes it into both channels of dest with saturation.
+ * @param dest The StereoFrame16 to mix into.
+ * @param source The quadraphonic frame to downmix.
+ * @param gain Gain applied to every channel of source.
+ */
+void DownmixQuadIntoMono(StereoFrame16& dest, const QuadFrame32& source, float gain);
+
+} // namespace AudioCore::Mix
@@ -9,12 +9,16 @@
 #include <SoundTouch.h>
 #include "audio_core/audio_types.h"
 #include "audio_core/time_stretch.h"
+#include "audio_core/wsola.h"
 #include "common/logging/log.h"
+#include "core/settings.h"
 
 namespace AudioCore {
 
 TimeStretcher::TimeStretcher()
-    : sample_rate(native_sample_rate), sound_touch(std::make_unique<soundtouch::SoundTouch>()) {
+    : sample_rate(native_sample_rate), method(Settings::AudioStretchMethod::SoundTouch),
+      sound_touch(std::make_unique<soundtouch::SoundTouch>()),
+      wsola(std::make_unique<WSOLA>(native_sample_rate)) {
     sound_touch->setChannels(2);
     sound_touch->setSampleRate(native_sample_rate);
     sound_touch->setPitch(1.0);
@@ -27,9 +31,25 @@ TimeStretcher::~TimeStretcher() {
 
 void TimeStretcher::SetOutputSampleRate(unsigned int sample_rate) {
     sound_touch->setSampleRate(sample_rate);
+    wsola->SetSampleRate(sample_rate);
     sample_rate = native_sample_rate;
 }
 
+void TimeStretcher::SetMethod(Settings::AudioStretchMethod new_method) {
+    if (method == new_method) {
+        return;
+    }
+    method = new_method;
+    Clear();
+}
+
+std::size_t TimeStretcher::NumBufferedSamples() const {
+    if (method == Settings::AudioStretchMethod::WSOLA) {
+        return wsola->NumSamples();
+    }
+    return sound_touch->numSamples();
+}
+
 std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
                                    std::size_t num_out) {
     const double time_delta = static_cast<double>(num_out) / sample_rate; // seconds
@@ -37,7 +57,7 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
 
     const double max_latency = 0.25; // seconds
     const double max_backlog = sample_rate * max_latency;
-    const double backlog_fullness = sound_touch->numSamples() / max_backlog;
+    const double backlog_fullness = NumBufferedSamples() / max_backlog;
     if (backlog_fullness > 4.0) {
         // Too many samples in backlog: Don't push anymore on
         num_in = 0;
@@ -59,21 +79,29 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
     // Place a lower limit of 5% speed. When a game boots up, there will be
     // many silence samples. These do not need to be timestretched.
     stretch_ratio = std::max(stretch_ratio, 0.05);
-    sound_touch->setTempo(stretch_ratio);
 
     LOG_TRACE(Audio, "{:5}/{:5} ratio:{:0.6f} backlog:{:0.6f}", num_in, num_out, stretch_ratio,
               backlog_fullness);
 
+    if (method == Settings::AudioStretchMethod::WSOLA) {
+        wsola->SetTempo(stretch_ratio);
+        wsola->PutSamples(in, num_in);
+        return wsola->ReceiveSamples(out, num_out);
+    }
+
+    sound_touch->setTempo(stretch_ratio);
     sound_touch->putSamples(in, static_cast<u32>(num_in));
     return sound_touch->receiveSamples(out, static_cast<u32>(num_out));
 }
 
 void TimeStretcher::Clear() {
     sound_touch->clear();
+    wsola->Clear();
 }
 
 void TimeStretcher::Flush() {
     sound_touch->flush();
+    wsola->Flush();
 }
 
 } // namespace AudioCore
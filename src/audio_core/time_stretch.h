@@ -13,8 +13,14 @@ namespace soundtouch {
 class SoundTouch;
 }
 
+namespace Settings {
+enum class AudioStretchMethod : u32;
+}
+
 namespace AudioCore {
 
+class WSOLA;
+
 class TimeStretcher {
 public:
     TimeStretcher();
@@ -22,6 +28,9 @@ public:
 
     void SetOutputSampleRate(unsigned int sample_rate);
 
+    /// Selects the stretching implementation, discarding buffered audio if it changes
+    void SetMethod(Settings::AudioStretchMethod method);
+
     /// @param in       Input sample buffer
     /// @param num_in   Number of input frames in `in`
     /// @param out      Output sample buffer
@@ -34,8 +43,12 @@ public:
     void Flush();
 
 private:
+    std::size_t NumBufferedSamples() const;
+
     unsigned int sample_rate;
+    Settings::AudioStretchMethod method;
     std::unique_ptr<soundtouch::SoundTouch> sound_touch;
+    std::unique_ptr<WSOLA> wsola;
     double stretch_ratio = 1.0;
 };
 
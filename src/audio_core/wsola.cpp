@@ -0,0 +1,147 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "audio_core/wsola.h"
+
+namespace AudioCore {
+
+// Durations in milliseconds, matching the defaults SoundTouch uses for its own search.
+constexpr unsigned int sequence_ms = 40;
+constexpr unsigned int seek_ms = 15;
+constexpr unsigned int overlap_ms = 8;
+
+WSOLA::WSOLA(unsigned int sample_rate) {
+    SetSampleRate(sample_rate);
+}
+
+void WSOLA::SetSampleRate(unsigned int sample_rate) {
+    sequence_length = sample_rate * sequence_ms / 1000;
+    seek_length = sample_rate * seek_ms / 1000;
+    overlap_length = sample_rate * overlap_ms / 1000;
+    Clear();
+}
+
+void WSOLA::SetTempo(double new_tempo) {
+    tempo = new_tempo;
+}
+
+void WSOLA::PutSamples(const s16* in, std::size_t num_frames) {
+    input.insert(input.end(), in, in + num_frames * 2);
+    ProcessSequences();
+}
+
+std::size_t WSOLA::ReceiveSamples(s16* out, std::size_t max_frames) {
+    const std::size_t num_frames = std::min(max_frames, NumSamples());
+    std::memcpy(out, output.data(), num_frames * 2 * sizeof(s16));
+    output.erase(output.begin(), output.begin() + num_frames * 2);
+    return num_frames;
+}
+
+std::size_t WSOLA::NumSamples() const {
+    return output.size() / 2;
+}
+
+void WSOLA::Clear() {
+    input.clear();
+    output.clear();
+    overlap.assign(overlap_length * 2, 0);
+    have_overlap = false;
+    skip_fraction = 0.0;
+}
+
+void WSOLA::Flush() {
+    // The input starts where the previous sequence's tail was taken from, so it has to be
+    // crossfaded like a new sequence rather than appended after the tail.
+    auto rest = input.begin();
+    if (have_overlap) {
+        if (InputFrames() >= overlap_length) {
+            CrossfadeOverlap(input.data());
+            rest += overlap_length * 2;
+        } else {
+            output.insert(output.end(), overlap.begin(), overlap.end());
+            rest = input.end();
+        }
+    }
+    output.insert(output.end(), rest, input.end());
+    input.clear();
+    have_overlap = false;
+    skip_fraction = 0.0;
+}
+
+std::size_t WSOLA::InputFrames() const {
+    return input.size() / 2;
+}
+
+std::size_t WSOLA::SeekBestOffset() const {
+    // Correlate the channel sums of every other frame; the search only needs to find the
+    // waveform's alignment, not match it sample for sample.
+    constexpr std::size_t stride = 2;
+
+    std::vector<s32> reference(overlap_length / stride);
+    for (std::size_t i = 0; i < reference.size(); i++) {
+        reference[i] = overlap[i * stride * 2] + overlap[i * stride * 2 + 1];
+    }
+
+    std::size_t best_offset = 0;
+    double best_score = -1.0e30;
+    for (std::size_t offset = 0; offset < seek_length; offset++) {
+        const s16* candidate = input.data() + offset * 2;
+        s64 correlation = 0;
+        s64 energy = 0;
+        for (std::size_t i = 0; i < reference.size(); i++) {
+            const s32 sample = candidate[i * stride * 2] + candidate[i * stride * 2 + 1];
+            correlation += static_cast<s64>(reference[i]) * sample;
+            energy += static_cast<s64>(sample) * sample;
+        }
+        const double score = correlation / std::sqrt(static_cast<double>(energy) + 1.0);
+        if (score > best_score) {
+            best_score = score;
+            best_offset = offset;
+        }
+    }
+    return best_offset;
+}
+
+void WSOLA::CrossfadeOverlap(const s16* in) {
+    // Linearly crossfade from the previous sequence's tail into `in`.
+    for (std::size_t i = 0; i < overlap_length; i++) {
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const s32 fade_out = overlap[i * 2 + channel] * static_cast<s32>(overlap_length - i);
+            const s32 fade_in = in[i * 2 + channel] * static_cast<s32>(i);
+            output.push_back(
+                static_cast<s16>((fade_out + fade_in) / static_cast<s32>(overlap_length)));
+        }
+    }
+}
+
+void WSOLA::ProcessSequences() {
+    while (InputFrames() >= seek_length + sequence_length) {
+        std::size_t offset = 0;
+        if (have_overlap) {
+            offset = SeekBestOffset();
+            CrossfadeOverlap(input.data() + offset * 2);
+        } else {
+            output.insert(output.end(), input.begin(), input.begin() + overlap_length * 2);
+        }
+
+        const auto sequence = input.begin() + offset * 2;
+        output.insert(output.end(), sequence + overlap_length * 2,
+                      sequence + (sequence_length - overlap_length) * 2);
+        std::copy(sequence + (sequence_length - overlap_length) * 2,
+                  sequence + sequence_length * 2, overlap.begin());
+        have_overlap = true;
+
+        // Each sequence produces sequence_length - overlap_length frames of output, so advance
+        // the input by tempo times that.
+        skip_fraction += tempo * static_cast<double>(sequence_length - overlap_length);
+        const auto skip = static_cast<std::size_t>(skip_fraction);
+        skip_fraction -= static_cast<double>(skip);
+        input.erase(input.begin(), input.begin() + std::min(skip, InputFrames()) * 2);
+    }
+}
+
+} // namespace AudioCore
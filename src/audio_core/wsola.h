@@ -0,0 +1,66 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * Lightweight waveform similarity overlap-add (WSOLA) time stretcher for interleaved stereo PCM16.
+ * Input is cut into fixed length sequences. Each sequence is placed where it best matches the tail
+ * of the previous one within a small seek window, and the two are crossfaded.
+ */
+class WSOLA {
+public:
+    explicit WSOLA(unsigned int sample_rate);
+
+    /// Sets the sample rate the sequence, seek and overlap durations are derived from
+    void SetSampleRate(unsigned int sample_rate);
+
+    /// Sets the tempo; values above 1.0 consume input faster than output is produced
+    void SetTempo(double tempo);
+
+    /// @param in         Interleaved stereo input samples
+    /// @param num_frames Number of frames in `in`
+    void PutSamples(const s16* in, std::size_t num_frames);
+
+    /// @param out        Interleaved stereo output buffer
+    /// @param max_frames Maximum number of frames to write to `out`
+    /// @returns Number of frames written to `out`
+    std::size_t ReceiveSamples(s16* out, std::size_t max_frames);
+
+    /// @returns Number of frames ready to be received
+    std::size_t NumSamples() const;
+
+    /// Discards all buffered input and output
+    void Clear();
+
+    /// Makes all buffered input available as output without stretching it
+    void Flush();
+
+private:
+    std::size_t InputFrames() const;
+    void ProcessSequences();
+    std::size_t SeekBestOffset() const;
+    /// Appends overlap_length frames fading from the stored overlap into `in`
+    void CrossfadeOverlap(const s16* in);
+
+    std::size_t sequence_length = 0; ///< Frames
+    std::size_t seek_length = 0;     ///< Frames
+    std::size_t overlap_length = 0;  ///< Frames
+    double tempo = 1.0;
+    double skip_fraction = 0.0;
+
+    std::vector<s16> input;
+    std::vector<s16> output;
+    /// Tail of the previous sequence, crossfaded with the start of the next one
+    std::vector<s16> overlap;
+    bool have_overlap = false;
+};
+
+} // namespace AudioCore
@@ -187,6 +187,12 @@ void Config::ReadValues() {
     Settings::values.sink_id = sdl2_config->GetString("Audio", "output_engine", "auto");
     Settings::values.enable_audio_stretching =
         sdl2_config->GetBoolean("Audio", "enable_audio_stretching", true);
+    Settings::values.audio_target_latency =
+        static_cast<u32>(sdl2_config->GetInteger("Audio", "audio_target_latency", 50));
+    Settings::values.audio_stretch_method = static_cast<Settings::AudioStretchMethod>(
+        sdl2_config->GetInteger("Audio", "audio_stretch_method", 0));
+    Settings::values.enable_polyphase_interpolation =
+        sdl2_config->GetBoolean("Audio", "enable_polyphase_interpolation", true);
     Settings::values.audio_device_id = sdl2_config->GetString("Audio", "output_device", "auto");
     Settings::values.volume = static_cast<float>(sdl2_config->GetReal("Audio", "volume", 1));
     Settings::values.mic_input_device =
@@ -295,6 +301,9 @@ void Config::ReadValues() {
         sdl2_config->GetString("Video Dumping", "audio_encoder_options", "");
     Settings::values.audio_bitrate =
         sdl2_config->GetInteger("Video Dumping", "audio_bitrate", 64000);
+
+    Settings::values.offline_dumping =
+        sdl2_config->GetBoolean("Video Dumping", "offline_dumping", false);
 }
 
 void Config::Reload() {
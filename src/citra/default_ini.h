@@ -228,6 +228,20 @@ output_engine =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# How much audio, in milliseconds, to keep buffered ahead of the output device when
+# audio-stretching is disabled. Lower values reduce latency but are more prone to stutter.
+# 10 - 60, 50 (default)
+audio_target_latency =
+
+# Which implementation the audio-stretching effect uses.
+# 0 (default): SoundTouch, 1: WSOLA (lower quality, cheaper on the CPU)
+audio_stretch_method =
+
+# Whether sources requesting polyphase interpolation get a windowed sinc filter.
+# Disabling this falls back to the cheaper linear interpolation.
+# 0: No, 1 (default): Yes
+enable_polyphase_interpolation =
+
 # Which audio device to use.
 # auto (default): Auto-select
 output_device =
@@ -330,5 +344,10 @@ audio_encoder_options =
 
 # Audio bitrate, default: 64000
 audio_bitrate =
+
+# Whether to render dumps offline. The frame limiter is bypassed and audio goes only to the
+# dump, not to the output device, so dumping runs as fast as the host allows.
+# 0 (default): No, 1: Yes
+offline_dumping =
 )";
 }
@@ -111,6 +111,12 @@ void Config::ReadAudioValues() {
                                    .toStdString();
     Settings::values.enable_audio_stretching =
         ReadSetting(QStringLiteral("enable_audio_stretching"), true).toBool();
+    Settings::values.audio_target_latency =
+        ReadSetting(QStringLiteral("audio_target_latency"), 50).toUInt();
+    Settings::values.audio_stretch_method = static_cast<Settings::AudioStretchMethod>(
+        ReadSetting(QStringLiteral("audio_stretch_method"), 0).toInt());
+    Settings::values.enable_polyphase_interpolation =
+        ReadSetting(QStringLiteral("enable_polyphase_interpolation"), true).toBool();
     Settings::values.audio_device_id =
         ReadSetting(QStringLiteral("output_device"), QStringLiteral("auto"))
             .toString()
@@ -535,6 +541,9 @@ void Config::ReadVideoDumpingValues() {
     Settings::values.audio_bitrate =
         ReadSetting(QStringLiteral("audio_bitrate"), 64000).toULongLong();
 
+    Settings::values.offline_dumping =
+        ReadSetting(QStringLiteral("offline_dumping"), false).toBool();
+
     qt_config->endGroup();
 }
 
@@ -687,6 +696,11 @@ void Config::SaveAudioValues() {
                  QStringLiteral("auto"));
     WriteSetting(QStringLiteral("enable_audio_stretching"),
                  Settings::values.enable_audio_stretching, true);
+    WriteSetting(QStringLiteral("audio_target_latency"), Settings::values.audio_target_latency, 50);
+    WriteSetting(QStringLiteral("audio_stretch_method"),
+                 static_cast<int>(Settings::values.audio_stretch_method), 0);
+    WriteSetting(QStringLiteral("enable_polyphase_interpolation"),
+                 Settings::values.enable_polyphase_interpolation, true);
     WriteSetting(QStringLiteral("output_device"),
                  QString::fromStdString(Settings::values.audio_device_id), QStringLiteral("auto"));
     WriteSetting(QStringLiteral("volume"), Settings::values.volume, 1.0f);
@@ -1001,6 +1015,8 @@ void Config::SaveVideoDumpingValues() {
     WriteSetting(QStringLiteral("audio_bitrate"),
                  static_cast<unsigned long long>(Settings::values.audio_bitrate), 64000);
 
+    WriteSetting(QStringLiteral("offline_dumping"), Settings::values.offline_dumping, false);
+
     qt_config->endGroup();
 }
 
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <vector>
 #include <QApplication>
 #include <QClipboard>
 #include <QComboBox>
@@ -27,9 +28,11 @@
 namespace {
 QImage LoadTexture(const u8* src, const Pica::Texture::TextureInfo& info) {
     QImage decoded_image(info.width, info.height, QImage::Format_ARGB32);
+    std::vector<Common::Vec4<u8>> texels(info.width * info.height);
+    Pica::Texture::DecodeTexture(src, info, texels.data(), true);
     for (u32 y = 0; y < info.height; ++y) {
         for (u32 x = 0; x < info.width; ++x) {
-            Common::Vec4<u8> color = Pica::Texture::LookupTexture(src, x, y, info, true);
+            const Common::Vec4<u8>& color = texels[x + y * info.width];
             decoded_image.setPixel(x, y, qRgba(color.r(), color.g(), color.b(), color.a()));
         }
     }
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <vector>
 #include <QBoxLayout>
 #include <QComboBox>
 #include <QDebug>
@@ -588,9 +589,11 @@ void GraphicsSurfaceWidget::OnUpdate() {
         info.format = static_cast<Pica::TexturingRegs::TextureFormat>(surface_format);
         info.SetDefaultStride();
 
+        std::vector<Common::Vec4<u8>> texels(surface_width * surface_height);
+        Pica::Texture::DecodeTexture(buffer, info, texels.data(), true);
         for (unsigned int y = 0; y < surface_height; ++y) {
             for (unsigned int x = 0; x < surface_width; ++x) {
-                Common::Vec4<u8> color = Pica::Texture::LookupTexture(buffer, x, y, info, true);
+                const Common::Vec4<u8>& color = texels[x + y * surface_width];
                 decoded_image.setPixel(x, y, qRgba(color.r(), color.g(), color.b(), color.a()));
             }
         }
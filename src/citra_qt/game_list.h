@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <QMenu>
 #include <QString>
 #include <QVector>
@@ -29,6 +30,10 @@ class QTreeView;
 class QToolButton;
 class QVBoxLayout;
 
+namespace Core {
+class GameLibrary;
+}
+
 enum class GameListOpenTarget {
     SAVE_DATA = 0,
     EXT_DATA = 1,
@@ -115,6 +120,7 @@ private:
     GameListWorker* current_worker = nullptr;
     QFileSystemWatcher* watcher = nullptr;
     CompatibilityList compatibility_list;
+    std::unique_ptr<Core::GameLibrary> game_library;
 
     friend class GameListSearchField;
 };
@@ -15,8 +15,7 @@
 #include "citra_qt/uisettings.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
-#include "core/hle/service/am/am.h"
-#include "core/hle/service/fs/archive.h"
+#include "core/game_library.h"
 #include "core/loader/loader.h"
 
 namespace {
@@ -27,93 +26,54 @@ bool HasSupportedFileExtension(const std::string& file_name) {
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(QVector<UISettings::GameDir>& game_dirs,
-                               const CompatibilityList& compatibility_list)
-    : game_dirs(game_dirs), compatibility_list(compatibility_list) {}
+                               const CompatibilityList& compatibility_list,
+                               Core::GameLibrary& game_library)
+    : game_dirs(game_dirs), compatibility_list(compatibility_list), game_library(game_library) {}
 
 GameListWorker::~GameListWorker() = default;
 
 void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
                                              GameListDir* parent_dir) {
-    const auto callback = [this, recursion, parent_dir](u64* num_entries_out,
-                                                        const std::string& directory,
-                                                        const std::string& virtual_name) -> bool {
+    std::vector<std::string> subdirectories;
+    const std::vector<Core::GameEntry> entries = game_library.Scan(
+        dir_path, recursion, HasSupportedFileExtension, &subdirectories, &stop_processing);
+    for (const std::string& subdirectory : subdirectories) {
+        watch_list.append(QString::fromStdString(subdirectory));
+    }
+
+    for (const Core::GameEntry& entry : entries) {
         if (stop_processing) {
-            // Breaks the callback loop.
-            return false;
+            return;
         }
 
-        const std::string physical_name = directory + DIR_SEP + virtual_name;
-        const bool is_dir = FileUtil::IsDirectory(physical_name);
-        if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader) {
-                return true;
-            }
-
-            bool executable = false;
-            const auto res = loader->IsExecutable(executable);
-            if (!executable && res != Loader::ResultStatus::ErrorEncrypted) {
-                return true;
-            }
-
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            u64 extdata_id = 0;
-            loader->ReadExtdataId(extdata_id);
-
-            std::vector<u8> smdh;
-            // Look for an update icon if available
-            if (!(program_id & ~0x00040000FFFFFFFF)) {
-                std::string update_path = Service::AM::GetTitleContentPath(
-                    Service::FS::MediaType::SDMC, program_id | 0x0000000E00000000);
-                if (FileUtil::Exists(update_path)) {
-                    std::unique_ptr<Loader::AppLoader> update_loader =
-                        Loader::GetLoader(update_path);
-                    if (update_loader) {
-                        update_loader->ReadIcon(smdh);
-                    }
-                }
-            }
-
-            if (!Loader::IsValidSMDH(smdh)) {
-                // Read the original smdh if there is no valid update smdh
-                loader->ReadIcon(smdh);
-            }
-
-            if (!Loader::IsValidSMDH(smdh) && UISettings::values.game_list_hide_no_icon) {
-                // Skip this invalid entry
-                return true;
-            }
-
-            auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
-
-            // The game list uses this as compatibility number for untested games
-            QString compatibility(QStringLiteral("99"));
-            if (it != compatibility_list.end())
-                compatibility = it->second.first;
-
-            emit EntryReady(
-                {
-                    new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                         extdata_id),
-                    new GameListItemCompat(compatibility),
-                    new GameListItemRegion(smdh),
-                    new GameListItem(
-                        QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
-                },
-                parent_dir);
-
-        } else if (is_dir && recursion > 0) {
-            watch_list.append(QString::fromStdString(physical_name));
-            AddFstEntriesToGameList(physical_name, recursion - 1, parent_dir);
+        if (!entry.IsListable()) {
+            continue;
         }
 
-        return true;
-    };
+        if (!Loader::IsValidSMDH(entry.smdh) && UISettings::values.game_list_hide_no_icon) {
+            // Skip this invalid entry
+            continue;
+        }
 
-    FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
+        auto it = FindMatchingCompatibilityEntry(compatibility_list, entry.program_id);
+
+        // The game list uses this as compatibility number for untested games
+        QString compatibility(QStringLiteral("99"));
+        if (it != compatibility_list.end())
+            compatibility = it->second.first;
+
+        emit EntryReady(
+            {
+                new GameListItemPath(QString::fromStdString(entry.path), entry.smdh,
+                                     entry.program_id, entry.extdata_id),
+                new GameListItemCompat(compatibility),
+                new GameListItemRegion(entry.smdh),
+                new GameListItem(
+                    QString::fromStdString(Loader::GetFileTypeString(entry.file_type))),
+                new GameListItemSize(entry.size),
+            },
+            parent_dir);
+    }
 }
 
 void GameListWorker::run() {
@@ -153,6 +113,11 @@ void GameListWorker::run() {
                                     game_list_dir);
         }
     };
+    if (!stop_processing) {
+        // Only a complete scan knows which indexed files are gone
+        game_library.Prune();
+        game_library.Save();
+    }
     emit Finished(watch_list);
 }
 
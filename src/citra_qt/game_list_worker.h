@@ -19,6 +19,10 @@
 
 class QStandardItem;
 
+namespace Core {
+class GameLibrary;
+}
+
 /**
  * Asynchronous worker object for populating the game list.
  * Communicates with other threads through Qt's signal/slot system.
@@ -28,7 +32,7 @@ class GameListWorker : public QObject, public QRunnable {
 
 public:
     GameListWorker(QVector<UISettings::GameDir>& game_dirs,
-                   const CompatibilityList& compatibility_list);
+                   const CompatibilityList& compatibility_list, Core::GameLibrary& game_library);
     ~GameListWorker() override;
 
     /// Starts the processing of directory tree information.
@@ -58,6 +62,7 @@ private:
 
     QVector<UISettings::GameDir>& game_dirs;
     const CompatibilityList& compatibility_list;
+    Core::GameLibrary& game_library;
 
     QStringList watch_list;
     std::atomic_bool stop_processing;
@@ -282,8 +282,13 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    audio_latency_label = new QLabel();
+    audio_latency_label->setToolTip(
+        tr("Audio buffered ahead of the audio output. Underruns cause crackling, overruns "
+           "mean emulated audio was dropped."));
 
-    for (auto& label : {emu_speed_label, game_fps_label, emu_frametime_label}) {
+    for (auto& label :
+         {emu_speed_label, game_fps_label, emu_frametime_label, audio_latency_label}) {
         label->setVisible(false);
         label->setFrameStyle(QFrame::NoFrame);
         label->setContentsMargins(4, 0, 4, 0);
@@ -1124,6 +1129,7 @@ void GMainWindow::ShutdownGame() {
     emu_speed_label->setVisible(false);
     game_fps_label->setVisible(false);
     emu_frametime_label->setVisible(false);
+    audio_latency_label->setVisible(false);
 
     UpdateSaveStates();
 
@@ -2030,10 +2036,19 @@ void GMainWindow::UpdateStatusBar() {
     }
     game_fps_label->setText(tr("Game: %1 FPS").arg(results.game_fps, 0, 'f', 0));
     emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    if (results.audio_underruns != 0 || results.audio_overruns != 0) {
+        audio_latency_label->setText(tr("Audio: %1 ms (%2 underruns, %3 overruns)")
+                                         .arg(results.audio_latency_ms, 0, 'f', 0)
+                                         .arg(results.audio_underruns)
+                                         .arg(results.audio_overruns));
+    } else {
+        audio_latency_label->setText(tr("Audio: %1 ms").arg(results.audio_latency_ms, 0, 'f', 0));
+    }
 
     emu_speed_label->setVisible(true);
     game_fps_label->setVisible(true);
     emu_frametime_label->setVisible(true);
+    audio_latency_label->setVisible(true);
 }
 
 void GMainWindow::HideMouseCursor() {
@@ -2169,8 +2184,8 @@ static bool IsSingleFileDropEvent(const QMimeData* mime) {
     return mime->hasUrls() && mime->urls().length() == 1;
 }
 
-static const std::array<std::string, 8> AcceptedExtensions = {"cci",  "3ds", "cxi", "bin",
-                                                              "3dsx", "app", "elf", "axf"};
+static const std::array<std::string, 10> AcceptedExtensions = {
+    "cci", "3ds", "cxi", "bin", "3dsx", "app", "elf", "axf", "zcci", "zcxi"};
 
 static bool IsCorrectFileExtension(const QMimeData* mime) {
     const QString& filename = mime->urls().at(0).toLocalFile();
@@ -2345,6 +2360,9 @@ void GMainWindow::RetranslateStatusBar() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    audio_latency_label->setToolTip(
+        tr("Audio buffered ahead of the audio output. Underruns cause crackling, overruns "
+           "mean emulated audio was dropped."));
 
     multiplayer_state->retranslateUi();
 }
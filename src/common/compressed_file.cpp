@@ -0,0 +1,277 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <minilzo.h>
+#include "common/compressed_file.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+
+namespace FileUtil {
+
+namespace {
+/// Largest block size accepted when opening an image, to bound memory use on corrupt headers
+constexpr u32 max_block_size = 0x1000000;
+
+constexpr std::size_t CompressBound(std::size_t size) {
+    return size + size / 16 + 64 + 3;
+}
+
+bool InitLZO() {
+    static const bool initialized = lzo_init() == LZO_E_OK;
+    if (!initialized) {
+        LOG_ERROR(Common_Filesystem, "lzo_init() failed");
+    }
+    return initialized;
+}
+} // Anonymous namespace
+
+bool IsCompressedImagePath(std::string_view path) {
+    const auto dot = path.find_last_of('.');
+    if (dot == std::string_view::npos) {
+        return false;
+    }
+    const std::string extension = Common::ToLower(std::string(path.substr(dot)));
+    return extension == ".zcci" || extension == ".zcxi";
+}
+
+bool CompressImage(IOFile& source, IOFile& dest, u32 block_size,
+                   const std::function<void(u64, u64)>& progress) {
+    if (!InitLZO() || block_size == 0 || block_size > max_block_size) {
+        return false;
+    }
+
+    const u64 total_size = source.GetSize();
+    const u64 block_count = (total_size + block_size - 1) / block_size;
+    if (block_count > std::numeric_limits<u32>::max()) {
+        return false;
+    }
+
+    CompressedImageHeader header{};
+    header.magic = compressed_image_magic;
+    header.version = compressed_image_version;
+    header.block_size = block_size;
+    header.block_count = static_cast<u32>(block_count);
+    header.uncompressed_size = total_size;
+    if (dest.WriteObject(header) != 1) {
+        return false;
+    }
+
+    std::vector<u8> input(block_size);
+    std::vector<u8> output(CompressBound(block_size));
+    std::vector<lzo_align_t> work_memory(
+        (LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+    std::vector<u64_le> block_offsets;
+    block_offsets.reserve(block_count + 1);
+
+    u64 offset = sizeof(CompressedImageHeader);
+    source.Seek(0, SEEK_SET);
+    for (u64 block = 0; block < block_count; block++) {
+        const auto length =
+            static_cast<std::size_t>(std::min<u64>(block_size, total_size - block * block_size));
+        if (source.ReadBytes(input.data(), length) != length) {
+            LOG_ERROR(Common_Filesystem, "Failed to read block {} of the source image", block);
+            return false;
+        }
+
+        lzo_uint compressed_length = 0;
+        if (lzo1x_1_compress(input.data(), length, output.data(), &compressed_length,
+                             work_memory.data()) != LZO_E_OK) {
+            return false;
+        }
+
+        // Store blocks which did not shrink as-is; readers tell them apart by their size.
+        const bool store_raw = compressed_length >= length;
+        const u8* data = store_raw ? input.data() : output.data();
+        const std::size_t stored_length = store_raw ? length : compressed_length;
+        if (dest.WriteBytes(data, stored_length) != stored_length) {
+            return false;
+        }
+
+        block_offsets.push_back(offset);
+        offset += stored_length;
+        if (progress) {
+            progress(block * block_size + length, total_size);
+        }
+    }
+    block_offsets.push_back(offset);
+
+    header.index_offset = offset;
+    if (dest.WriteArray(block_offsets.data(), block_offsets.size()) != block_offsets.size()) {
+        return false;
+    }
+    dest.Seek(0, SEEK_SET);
+    return dest.WriteObject(header) == 1 && dest.Flush();
+}
+
+std::unique_ptr<IOHandler> CompressedIOHandler::Open(std::unique_ptr<IOHandler> raw) {
+    if (!raw || !InitLZO()) {
+        return nullptr;
+    }
+
+    CompressedImageHeader header;
+    if (raw->ReadAt(&header, sizeof(header), 0) != sizeof(header) ||
+        header.magic != compressed_image_magic || header.version != compressed_image_version ||
+        header.block_size == 0 || header.block_size > max_block_size ||
+        (header.uncompressed_size + header.block_size - 1) / header.block_size !=
+            header.block_count) {
+        LOG_ERROR(Common_Filesystem, "Invalid compressed image header");
+        return nullptr;
+    }
+
+    const std::size_t index_size = (std::size_t{header.block_count} + 1) * sizeof(u64_le);
+    std::vector<u64_le> index(header.block_count + 1);
+    if (raw->ReadAt(index.data(), index_size, header.index_offset) != index_size) {
+        LOG_ERROR(Common_Filesystem, "Failed to read compressed image index");
+        return nullptr;
+    }
+
+    std::vector<u64> block_offsets(index.begin(), index.end());
+    for (u32 block = 0; block < header.block_count; block++) {
+        const u64 stored_size = block_offsets[block + 1] - block_offsets[block];
+        if (block_offsets[block + 1] < block_offsets[block] ||
+            stored_size > CompressBound(header.block_size)) {
+            LOG_ERROR(Common_Filesystem, "Corrupt compressed image index at block {}", block);
+            return nullptr;
+        }
+    }
+
+    return std::unique_ptr<IOHandler>(
+        new CompressedIOHandler(std::move(raw), header, std::move(block_offsets)));
+}
+
+CompressedIOHandler::CompressedIOHandler(std::unique_ptr<IOHandler> raw,
+                                         const CompressedImageHeader& header,
+                                         std::vector<u64> block_offsets)
+    : raw(std::move(raw)), header(header), block_offsets(std::move(block_offsets)) {}
+
+std::size_t CompressedIOHandler::Read(void* buf, std::size_t size, std::size_t count) {
+    if (size == 0) {
+        return 0;
+    }
+    u64 offset;
+    {
+        std::lock_guard lock{mutex};
+        offset = position;
+    }
+    const std::size_t read = ReadAt(buf, size * count, offset);
+    std::lock_guard lock{mutex};
+    position = offset + read;
+    return read / size;
+}
+
+std::size_t CompressedIOHandler::Write(const void* buf, std::size_t size, std::size_t count) {
+    return 0;
+}
+
+std::size_t CompressedIOHandler::ReadAt(void* buf, std::size_t size, u64 offset) {
+    if (offset >= header.uncompressed_size) {
+        return 0;
+    }
+    size = static_cast<std::size_t>(std::min<u64>(size, header.uncompressed_size - offset));
+
+    std::lock_guard lock{mutex};
+    std::size_t copied = 0;
+    while (copied < size) {
+        const u64 current = offset + copied;
+        const auto index = static_cast<u32>(current / header.block_size);
+        const std::vector<u8>* block = GetBlock(index);
+        if (block == nullptr) {
+            break;
+        }
+        const auto begin = static_cast<std::size_t>(current % header.block_size);
+        const std::size_t length = std::min(block->size() - begin, size - copied);
+        std::memcpy(static_cast<u8*>(buf) + copied, block->data() + begin, length);
+        copied += length;
+    }
+    return copied;
+}
+
+bool CompressedIOHandler::Seek(s64 offset, int whence) {
+    std::lock_guard lock{mutex};
+    s64 base = 0;
+    if (whence == SEEK_CUR) {
+        base = static_cast<s64>(position);
+    } else if (whence == SEEK_END) {
+        base = static_cast<s64>(header.uncompressed_size);
+    }
+    if (base + offset < 0) {
+        return false;
+    }
+    position = static_cast<u64>(base + offset);
+    return true;
+}
+
+u64 CompressedIOHandler::Tell() {
+    std::lock_guard lock{mutex};
+    return position;
+}
+
+u64 CompressedIOHandler::GetSize() {
+    return header.uncompressed_size;
+}
+
+bool CompressedIOHandler::Resize(u64 size) {
+    return false;
+}
+
+bool CompressedIOHandler::Flush() {
+    return true;
+}
+
+int CompressedIOHandler::GetDescriptor() {
+    // The raw descriptor does not hold the uncompressed data, so it must not be mapped.
+    return -1;
+}
+
+const std::vector<u8>* CompressedIOHandler::GetBlock(u32 index) {
+    const auto it = std::find_if(cache.begin(), cache.end(), [index](const CachedBlock& block) {
+        return block.index == index;
+    });
+    if (it != cache.end()) {
+        cache.splice(cache.begin(), cache, it);
+        return &cache.front().data;
+    }
+
+    const u64 stored_size = block_offsets[index + 1] - block_offsets[index];
+    const u64 block_start = u64{index} * header.block_size;
+    const auto length = static_cast<std::size_t>(
+        std::min<u64>(header.block_size, header.uncompressed_size - block_start));
+
+    // Reuse the least recently used entry's storage once the cache is full.
+    if (cache.size() < cache_block_count) {
+        cache.emplace_front();
+    } else {
+        cache.splice(cache.begin(), cache, std::prev(cache.end()));
+    }
+    CachedBlock& block = cache.front();
+    block.index = index;
+    block.data.resize(length);
+
+    bool ok;
+    if (stored_size == length) {
+        ok = raw->ReadAt(block.data.data(), length, block_offsets[index]) == length;
+    } else {
+        compressed_buffer.resize(stored_size);
+        lzo_uint decompressed_length = length;
+        ok = raw->ReadAt(compressed_buffer.data(), stored_size, block_offsets[index]) ==
+                 stored_size &&
+             lzo1x_decompress_safe(compressed_buffer.data(), stored_size, block.data.data(),
+                                   &decompressed_length, nullptr) == LZO_E_OK &&
+             decompressed_length == length;
+    }
+
+    if (!ok) {
+        LOG_ERROR(Common_Filesystem, "Failed to read compressed image block {}", index);
+        cache.pop_front();
+        return nullptr;
+    }
+    return &block.data;
+}
+
+} // namespace FileUtil
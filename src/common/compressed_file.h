@@ -0,0 +1,102 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/swap.h"
+
+namespace FileUtil {
+
+/**
+ * Compressed game image format. The image is split into fixed-size blocks which are compressed
+ * independently with LZO1X, so any offset can be read by decompressing a single block:
+ *
+ *   CompressedImageHeader
+ *   block data...
+ *   u64_le block_offsets[block_count + 1]   (at header.index_offset)
+ *
+ * Block i occupies [block_offsets[i], block_offsets[i + 1]). A block whose stored size equals its
+ * uncompressed size is stored as-is, which keeps incompressible (e.g. encrypted) data cheap.
+ */
+struct CompressedImageHeader {
+    u32_le magic;
+    u32_le version;
+    u32_le block_size;
+    u32_le block_count;
+    u64_le uncompressed_size;
+    u64_le index_offset;
+};
+static_assert(sizeof(CompressedImageHeader) == 32, "CompressedImageHeader has incorrect size");
+
+constexpr u32 compressed_image_magic = 0x4D495A43; // "CZIM"
+constexpr u32 compressed_image_version = 1;
+/// Matches the RomFS reader's cache block; larger blocks compress slightly better but make small
+/// random reads decompress more data.
+constexpr u32 default_compressed_block_size = 0x10000;
+
+/// Whether path names a compressed image (.zcci or .zcxi), based on its extension.
+bool IsCompressedImagePath(std::string_view path);
+
+/**
+ * Compresses source into dest, which must be empty and opened for writing.
+ * @param progress Called after every block with the number of bytes processed and the total
+ * @return Whether the image was written successfully
+ */
+bool CompressImage(IOFile& source, IOFile& dest, u32 block_size = default_compressed_block_size,
+                   const std::function<void(u64, u64)>& progress = {});
+
+/**
+ * Read-only IOHandler presenting the uncompressed contents of a compressed image. Blocks are
+ * decompressed on demand into a small LRU cache. ReadAt is thread-safe.
+ */
+class CompressedIOHandler : public IOHandler {
+public:
+    static constexpr std::size_t cache_block_count = 8;
+
+    /// Wraps a handler of a compressed image, or returns nullptr if the image is invalid.
+    static std::unique_ptr<IOHandler> Open(std::unique_ptr<IOHandler> raw);
+
+    std::size_t Read(void* buf, std::size_t size, std::size_t count) override;
+    std::size_t Write(const void* buf, std::size_t size, std::size_t count) override;
+    std::size_t ReadAt(void* buf, std::size_t size, u64 offset) override;
+    bool Seek(s64 offset, int whence) override;
+    u64 Tell() override;
+    u64 GetSize() override;
+    bool Resize(u64 size) override;
+    bool Flush() override;
+    int GetDescriptor() override;
+
+private:
+    struct CachedBlock {
+        u32 index;
+        std::vector<u8> data;
+    };
+
+    CompressedIOHandler(std::unique_ptr<IOHandler> raw, const CompressedImageHeader& header,
+                        std::vector<u64> block_offsets);
+
+    /// Returns the decompressed block, or nullptr on a read or decompression error. Must be
+    /// called with mutex held.
+    const std::vector<u8>* GetBlock(u32 index);
+
+    std::unique_ptr<IOHandler> raw;
+    CompressedImageHeader header;
+    std::vector<u64> block_offsets;
+
+    std::mutex mutex;
+    /// Most recently used first
+    std::list<CachedBlock> cache;
+    std::vector<u8> compressed_buffer;
+    u64 position = 0;
+};
+
+} // namespace FileUtil
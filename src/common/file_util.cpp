@@ -10,11 +10,13 @@
 #include "common/assert.h"
 #include "common/common_funcs.h"
 #include "common/common_paths.h"
+#include "common/compressed_file.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
 
 #include <cctype>
 #include <cerrno>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <dirent.h>
@@ -23,6 +25,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 // This namespace has various generic functions related to files and paths.
@@ -30,6 +33,72 @@
 // REMEMBER: strdup considered harmful!
 namespace FileUtil {
 
+namespace {
+
+/// Plain stdio handler, used when the frontend has not registered a factory (tools and tests)
+class StdioIOHandler : public IOHandler {
+public:
+    explicit StdioIOHandler(std::FILE* file) : file(file) {}
+
+    ~StdioIOHandler() override {
+        std::fclose(file);
+    }
+
+    std::size_t Read(void* buf, std::size_t size, std::size_t count) override {
+        return std::fread(buf, size, count, file);
+    }
+
+    std::size_t Write(const void* buf, std::size_t size, std::size_t count) override {
+        return std::fwrite(buf, size, count, file);
+    }
+
+    std::size_t ReadAt(void* buf, std::size_t size, u64 offset) override {
+        std::size_t total = 0;
+        while (total < size) {
+            const ssize_t result = pread(fileno(file), static_cast<u8*>(buf) + total,
+                                         size - total, static_cast<off_t>(offset + total));
+            if (result <= 0) {
+                break;
+            }
+            total += static_cast<std::size_t>(result);
+        }
+        return total;
+    }
+
+    bool Seek(s64 offset, int whence) override {
+        return 0 == fseeko(file, offset, whence);
+    }
+
+    u64 Tell() override {
+        return ftello(file);
+    }
+
+    u64 GetSize() override {
+        struct stat buf;
+        if (fstat(fileno(file), &buf) == 0) {
+            return buf.st_size;
+        }
+        return 0;
+    }
+
+    bool Resize(u64 size) override {
+        return 0 == ftruncate(fileno(file), size);
+    }
+
+    bool Flush() override {
+        return 0 == std::fflush(file);
+    }
+
+    int GetDescriptor() override {
+        return fileno(file);
+    }
+
+private:
+    std::FILE* file;
+};
+
+} // Anonymous namespace
+
 static std::unique_ptr<IOFactory> s_io_factory;
 void RegisterIOFactory(std::unique_ptr<IOFactory> factory) {
     s_io_factory = std::move(factory);
@@ -522,6 +591,9 @@ IOFile::IOFile(const std::string& filename, const char openmode[]) {
     Open(filename, openmode);
 }
 
+IOFile::IOFile(std::unique_ptr<IOHandler> handler)
+    : m_file(std::move(handler)), m_good(m_file != nullptr) {}
+
 IOFile::~IOFile() {
     Close();
 }
@@ -531,12 +603,37 @@ IOFile::IOFile(IOFile&& other) noexcept {
     std::swap(m_good, other.m_good);
 }
 
+IOFile& IOFile::operator=(IOFile&& other) noexcept {
+    std::swap(m_file, other.m_file);
+    std::swap(m_good, other.m_good);
+    return *this;
+}
+
 bool IOFile::Open(const std::string& filename, const char openmode[]) {
-    m_file = s_io_factory->Open(filename, openmode);
+    if (s_io_factory) {
+        m_file = s_io_factory->Open(filename, openmode);
+    } else if (std::FILE* file = std::fopen(filename.c_str(), openmode)) {
+        m_file = std::make_unique<StdioIOHandler>(file);
+    } else {
+        m_file.reset();
+    }
+    // Compressed images are transparently decompressed when opened for reading.
+    if (m_file && IsCompressedImagePath(filename) && std::strcmp(openmode, "rb") == 0) {
+        m_file = CompressedIOHandler::Open(std::move(m_file));
+    }
     m_good = m_file != nullptr;
     return m_good;
 }
 
+bool IOFile::Sync() {
+    if (!IsOpen() || !Flush()) {
+        return false;
+    }
+    // Handlers without a descriptor have nothing more to sync
+    const int fd = GetDescriptor();
+    return fd < 0 || fsync(fd) == 0;
+}
+
 void IOFile::ReadAllLines(std::vector<std::string>& lines) {
     if (!IsGood()) {
         return;
@@ -561,4 +658,31 @@ void IOFile::ReadAllLines(std::vector<std::string>& lines) {
     }
 }
 
+MappedFile::MappedFile(const IOFile& file) {
+    const int fd = file.GetDescriptor();
+    if (fd < 0) {
+        return;
+    }
+    struct stat file_info;
+    if (fstat(fd, &file_info) != 0 || file_info.st_size <= 0 ||
+        static_cast<u64>(file_info.st_size) > std::numeric_limits<std::size_t>::max()) {
+        return;
+    }
+
+    const auto file_size = static_cast<std::size_t>(file_info.st_size);
+    void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        LOG_WARNING(Common_Filesystem, "Failed to map file: {}", GetLastErrorMsg());
+        return;
+    }
+    data = static_cast<u8*>(mapping);
+    size = file_size;
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(data, size);
+    }
+}
+
 } // namespace FileUtil
@@ -163,11 +163,20 @@ public:
     virtual ~IOHandler() = default;
     virtual std::size_t Read(void* buf, std::size_t size, std::size_t count) = 0;
     virtual std::size_t Write(const void* buf, std::size_t size, std::size_t count) = 0;
+    /// Reads size bytes at offset without using or moving the file position
+    virtual std::size_t ReadAt(void* buf, std::size_t size, u64 offset) = 0;
     virtual bool Seek(s64 offset, int whence) = 0;
     virtual u64 Tell() = 0;
     virtual u64 GetSize() = 0;
     virtual bool Resize(u64 size) = 0;
     virtual bool Flush() = 0;
+    /// Returns the underlying file descriptor, or -1 if there is none
+    virtual int GetDescriptor() = 0;
+    /// Called before the handler is destroyed. Returns false if data it still held could not be
+    /// written out.
+    virtual bool Close() {
+        return true;
+    }
 };
 
 class IOFactory {
@@ -184,14 +193,20 @@ class IOFile : public NonCopyable {
 public:
     IOFile() = default;
     IOFile(const std::string& filename, const char openmode[]);
+    /// Wraps a handler which was opened by other means than a path and open mode
+    explicit IOFile(std::unique_ptr<IOHandler> handler);
     IOFile(IOFile&& other) noexcept;
+    IOFile& operator=(IOFile&& other) noexcept;
     ~IOFile();
 
     bool Open(const std::string& filename, const char openmode[]);
 
-    void Close() {
+    /// Returns false if data the file still held could not be written out
+    bool Close() {
+        const bool success = !m_file || m_file->Close();
         m_file.reset();
         m_good = false;
+        return success;
     }
 
     void ReadAllLines(std::vector<std::string>& lines);
@@ -228,6 +243,19 @@ public:
         return ReadArray(reinterpret_cast<char*>(data), length);
     }
 
+    /**
+     * Reads length bytes starting at offset without moving the file position. Unlike Seek followed
+     * by ReadBytes, this may be called from several threads at once.
+     */
+    template <typename T>
+    std::size_t ReadBytesAt(T* data, std::size_t length, u64 offset) const {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+        if (!IsOpen()) {
+            return 0;
+        }
+        return m_file->ReadAt(data, length, offset);
+    }
+
     template <typename T>
     std::size_t WriteBytes(const T* data, std::size_t length) {
         static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
@@ -276,11 +304,46 @@ public:
         return m_file->Flush();
     }
 
+    /// Flushes, then waits until the file contents reach the storage device, where possible
+    bool Sync();
+
+    int GetDescriptor() const {
+        return IsOpen() ? m_file->GetDescriptor() : -1;
+    }
+
 private:
     std::unique_ptr<FileUtil::IOHandler> m_file;
     bool m_good = false;
 };
 
+/**
+ * Read-only memory mapping of a whole file. The mapping stays valid after the IOFile it was
+ * created from is closed.
+ */
+class MappedFile : public NonCopyable {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const IOFile& file);
+    ~MappedFile();
+
+    /// Whether the mapping succeeded; callers are expected to fall back to IOFile otherwise
+    bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    const u8* GetData() const {
+        return data;
+    }
+
+    std::size_t GetSize() const {
+        return size;
+    }
+
+private:
+    u8* data = nullptr;
+    std::size_t size = 0;
+};
+
 } // namespace FileUtil
 
 // To deal with Windows being dumb at unicode:
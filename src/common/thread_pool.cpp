@@ -0,0 +1,112 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(std::size_t num_threads, std::string name_) : name(std::move(name_)) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex};
+        stop = true;
+    }
+    task_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Push(Task task) {
+    {
+        std::lock_guard lock{mutex};
+        tasks.push(std::move(task));
+    }
+    task_cv.notify_one();
+}
+
+void ThreadPool::WaitForIdle() {
+    std::unique_lock lock{mutex};
+    idle_cv.wait(lock, [this] { return tasks.empty() && busy_workers == 0; });
+}
+
+void ThreadPool::ParallelFor(std::size_t count, std::size_t granularity,
+                             const std::function<void(std::size_t, std::size_t)>& func) {
+    if (count == 0) {
+        return;
+    }
+
+    // The calling thread processes one of the chunks itself instead of idling
+    const std::size_t num_units = (count + granularity - 1) / granularity;
+    const std::size_t num_chunks = std::min(num_units, NumThreads() + 1);
+    const std::size_t units_per_chunk = (num_units + num_chunks - 1) / num_chunks;
+    const std::size_t chunk_size = units_per_chunk * granularity;
+
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    std::size_t remaining = 0;
+
+    std::size_t begin = chunk_size;
+    for (; begin < count; begin += chunk_size) {
+        const std::size_t end = std::min(begin + chunk_size, count);
+        {
+            std::lock_guard lock{done_mutex};
+            ++remaining;
+        }
+        Push([&, begin, end] {
+            func(begin, end);
+            std::lock_guard lock{done_mutex};
+            if (--remaining == 0) {
+                done_cv.notify_one();
+            }
+        });
+    }
+
+    func(0, std::min(chunk_size, count));
+
+    std::unique_lock lock{done_mutex};
+    done_cv.wait(lock, [&] { return remaining == 0; });
+}
+
+void ThreadPool::WorkerLoop() {
+    SetCurrentThreadName(name.c_str());
+
+    while (true) {
+        Task task;
+        {
+            std::unique_lock lock{mutex};
+            task_cv.wait(lock, [this] { return stop || !tasks.empty(); });
+            if (stop && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+            ++busy_workers;
+        }
+
+        task();
+
+        {
+            std::lock_guard lock{mutex};
+            --busy_workers;
+            if (tasks.empty() && busy_workers == 0) {
+                idle_cv.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace Common
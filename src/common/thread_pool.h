@@ -0,0 +1,68 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+/// A fixed number of worker threads executing queued tasks in FIFO order
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * Creates the pool and starts its workers.
+     * @param num_threads Number of worker threads, 0 selects one per hardware thread
+     * @param name Name given to the worker threads
+     */
+    explicit ThreadPool(std::size_t num_threads = 0, std::string name = "ThreadPool");
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Queues a task for execution on one of the workers
+    void Push(Task task);
+
+    /// Blocks until all queued tasks have finished executing
+    void WaitForIdle();
+
+    /**
+     * Splits the index range [0, count) into contiguous chunks and calls func(begin, end) for
+     * each of them, spread across the workers and the calling thread. Blocks until all chunks
+     * are done.
+     * @param count Number of indices to process
+     * @param granularity Chunk boundaries are placed at multiples of this value
+     * @param func Function processing the indices [begin, end)
+     */
+    void ParallelFor(std::size_t count, std::size_t granularity,
+                     const std::function<void(std::size_t, std::size_t)>& func);
+
+    std::size_t NumThreads() const {
+        return workers.size();
+    }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<Task> tasks;
+    std::mutex mutex;
+    std::condition_variable task_cv;
+    std::condition_variable idle_cv;
+    std::size_t busy_workers = 0;
+    bool stop = false;
+    std::string name;
+};
+
+} // namespace Common
@@ -17,6 +17,10 @@
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/custom_tex_cache.h"
+#include "core/dumping/backend.h"
+#ifdef ENABLE_FFMPEG_VIDEO_DUMPER
+#include "core/dumping/ffmpeg_backend.h"
+#endif
 #include "core/file_sys/archive_source_sd_savedata.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/client_port.h"
@@ -397,7 +401,15 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
 }
 
 PerfStats::Results System::GetAndResetPerfStats() {
-    return perf_stats->GetAndResetStats(timing->GetGlobalTimeUs());
+    PerfStats::Results results = perf_stats->GetAndResetStats(timing->GetGlobalTimeUs());
+    if (dsp_core) {
+        const AudioCore::AudioFifo::Stats audio = dsp_core->GetAndResetFifoStats();
+        results.audio_underruns = audio.underruns;
+        results.audio_overruns = audio.overruns;
+        results.audio_latency_ms =
+            audio.occupancy * 1000.0 / static_cast<double>(AudioCore::native_sample_rate);
+    }
+    return results;
 }
 
 System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mode, u8 n3ds_mode) {
@@ -440,8 +452,17 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
 
     memory->SetDSP(*dsp_core);
 
+#ifdef ENABLE_FFMPEG_VIDEO_DUMPER
+    video_dumper = std::make_unique<VideoDumper::FFmpegBackend>();
+#else
+    video_dumper = std::make_unique<VideoDumper::NullBackend>();
+#endif
+    dsp_core->SetVideoDumper(video_dumper.get());
+
     dsp_core->SetSink(Settings::values.sink_id, Settings::values.audio_device_id);
     dsp_core->EnableStretching(Settings::values.enable_audio_stretching);
+    dsp_core->SetStretchMethod(Settings::values.audio_stretch_method);
+    dsp_core->SetTargetLatency(Settings::values.audio_target_latency);
 
     telemetry_session = std::make_unique<Core::TelemetrySession>();
 
@@ -517,6 +538,14 @@ const Cheats::CheatEngine& System::CheatEngine() const {
     return *cheat_engine;
 }
 
+VideoDumper::Backend& System::VideoDumper() {
+    return *video_dumper;
+}
+
+const VideoDumper::Backend& System::VideoDumper() const {
+    return *video_dumper;
+}
+
 Core::CustomTexCache& System::CustomTexCache() {
     return *custom_tex_cache;
 }
@@ -563,6 +592,7 @@ void System::Shutdown() {
     service_manager.reset();
     cpu_cores = {};
     dsp_core.reset();
+    video_dumper.reset();
     kernel.reset();
     timing.reset();
     memory.reset();
@@ -51,6 +51,10 @@ namespace Cheats {
 class CheatEngine;
 }
 
+namespace VideoDumper {
+class Backend;
+}
+
 namespace Core {
 
 class Timing;
@@ -220,6 +224,12 @@ public:
     /// Gets a const reference to the cheat engine
     const Cheats::CheatEngine& CheatEngine() const;
 
+    /// Gets a reference to the video dumper backend
+    VideoDumper::Backend& VideoDumper();
+
+    /// Gets a const reference to the video dumper backend
+    const VideoDumper::Backend& VideoDumper() const;
+
     /// Gets a reference to the custom texture cache system
     Core::CustomTexCache& CustomTexCache();
 
@@ -293,6 +303,9 @@ private:
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
+    /// Video dumper backend
+    std::unique_ptr<VideoDumper::Backend> video_dumper;
+
     /// Telemetry session for this emulation session
     std::unique_ptr<Core::TelemetrySession> telemetry_session;
 
@@ -431,16 +431,15 @@ bool FFmpegBackend::StartDumping(const std::string& path, const std::string& for
     if (audio_processing_thread.joinable())
         audio_processing_thread.join();
     audio_processing_thread = std::thread([&] {
-        VariableAudioFrame channel0, channel1;
         while (true) {
-            channel0 = audio_frame_queues[0].PopWait();
-            channel1 = audio_frame_queues[1].PopWait();
-            if (channel0.empty()) {
-                // An empty frame marks the end of frame data
+            const AudioChunk chunk = audio_chunk_queue.PopWait();
+            if (chunk.sample_count == 0) {
+                // An empty chunk marks the end of audio data
+                FlushAudioBuffer();
                 ffmpeg.FlushAudio();
                 break;
             }
-            ffmpeg.ProcessAudioFrame(channel0, channel1);
+            ProcessAudioChunk(chunk);
         }
     });
 
@@ -457,42 +456,42 @@ void FFmpegBackend::AddVideoFrame(const VideoFrame& frame) {
 }
 
 void FFmpegBackend::AddAudioFrame(const AudioCore::StereoFrame16& frame) {
-    std::array<std::array<s16, 160>, 2> refactored_frame;
-    for (std::size_t i = 0; i < frame.size(); i++) {
-        refactored_frame[0][i] = frame[i][0];
-        refactored_frame[1][i] = frame[i][1];
-    }
-
-    for (auto i : {0, 1}) {
-        audio_buffers[i].insert(audio_buffers[i].end(), refactored_frame[i].begin(),
-                                refactored_frame[i].end());
+    std::lock_guard lock{audio_mutex};
+    if (!is_dumping) {
+        return;
     }
-    CheckAudioBuffer();
+    audio_chunk_queue.Push(AudioChunk{frame, frame.size()});
 }
 
 void FFmpegBackend::AddAudioSample(const std::array<s16, 2>& sample) {
-    for (auto i : {0, 1}) {
-        audio_buffers[i].push_back(sample[i]);
+    std::lock_guard lock{audio_mutex};
+    if (!is_dumping) {
+        return;
+    }
+    pending_audio.samples[pending_audio.sample_count++] = sample;
+    if (pending_audio.sample_count == pending_audio.samples.size()) {
+        audio_chunk_queue.Push(pending_audio);
+        pending_audio.sample_count = 0;
     }
-    CheckAudioBuffer();
 }
 
 void FFmpegBackend::StopDumping() {
-    is_dumping = false;
+    {
+        // The DSP may still be adding audio on the emulation thread. Stop accepting it and end the
+        // audio queue under the producers' lock, so that nothing is pushed after the end marker.
+        std::lock_guard lock{audio_mutex};
+        is_dumping = false;
+        // Add remaining samples to the audio queue, then flush it
+        if (pending_audio.sample_count != 0) {
+            audio_chunk_queue.Push(pending_audio);
+            pending_audio.sample_count = 0;
+        }
+        audio_chunk_queue.Push(AudioChunk{});
+    }
     VideoCore::g_renderer->CleanupVideoDumping();
 
     // Flush the video processing queue
     AddVideoFrame(VideoFrame());
-    for (auto i : {0, 1}) {
-        // Add remaining data to audio queue
-        if (audio_buffers[i].size() >= 0) {
-            VariableAudioFrame buffer(audio_buffers[i].begin(), audio_buffers[i].end());
-            audio_frame_queues[i].Push(std::move(buffer));
-            audio_buffers[i].clear();
-        }
-        // Flush the audio processing queue
-        audio_frame_queues[i].Push(VariableAudioFrame());
-    }
     // Wait until processing ends
     processing_ended.Wait();
 }
@@ -513,18 +512,40 @@ void FFmpegBackend::EndDumping() {
     processing_ended.Set();
 }
 
-void FFmpegBackend::CheckAudioBuffer() {
+void FFmpegBackend::ProcessAudioChunk(const AudioChunk& chunk) {
     for (auto i : {0, 1}) {
-        const std::size_t frame_size = ffmpeg.GetAudioFrameSize();
-        // Add audio data to the queue when there is enough to form a frame
-        while (audio_buffers[i].size() >= frame_size) {
-            VariableAudioFrame buffer(audio_buffers[i].begin(),
-                                      audio_buffers[i].begin() + frame_size);
-            audio_frame_queues[i].Push(std::move(buffer));
-
-            audio_buffers[i].erase(audio_buffers[i].begin(), audio_buffers[i].begin() + frame_size);
+        audio_buffers[i].reserve(audio_buffers[i].size() + chunk.sample_count);
+        for (std::size_t j = 0; j < chunk.sample_count; j++) {
+            audio_buffers[i].push_back(chunk.samples[j][i]);
         }
     }
+    CheckAudioBuffer();
+}
+
+void FFmpegBackend::CheckAudioBuffer() {
+    const std::size_t frame_size = ffmpeg.GetAudioFrameSize();
+    // Send audio data to the encoder when there is enough to form a frame
+    std::size_t offset = 0;
+    while (audio_buffers[0].size() - offset >= frame_size) {
+        VariableAudioFrame channel0(audio_buffers[0].begin() + offset,
+                                    audio_buffers[0].begin() + offset + frame_size);
+        VariableAudioFrame channel1(audio_buffers[1].begin() + offset,
+                                    audio_buffers[1].begin() + offset + frame_size);
+        ffmpeg.ProcessAudioFrame(channel0, channel1);
+        offset += frame_size;
+    }
+    for (auto i : {0, 1}) {
+        audio_buffers[i].erase(audio_buffers[i].begin(), audio_buffers[i].begin() + offset);
+    }
+}
+
+void FFmpegBackend::FlushAudioBuffer() {
+    if (!audio_buffers[0].empty()) {
+        ffmpeg.ProcessAudioFrame(audio_buffers[0], audio_buffers[1]);
+    }
+    for (auto i : {0, 1}) {
+        audio_buffers[i].clear();
+    }
 }
 
 } // namespace VideoDumper
@@ -154,8 +154,9 @@ private:
 
 /**
  * FFmpeg video dumping backend.
- * This class implements a double buffer, and an audio queue to keep audio data
- * before enough data is received to form a frame.
+ * This class implements a double buffer for video, and an audio queue which hands DSP output to
+ * the audio processing thread. Deinterleaving and grouping samples into encoder-sized frames both
+ * happen on that thread, so the emulation thread only pays for a queue push per DSP frame.
  */
 class FFmpegBackend : public Backend {
 public:
@@ -171,7 +172,15 @@ public:
     Layout::FramebufferLayout GetLayout() const override;
 
 private:
+    /// A block of interleaved DSP output. A block with no samples marks the end of audio data.
+    struct AudioChunk {
+        AudioCore::StereoFrame16 samples;
+        std::size_t sample_count;
+    };
+
+    void ProcessAudioChunk(const AudioChunk& chunk);
     void CheckAudioBuffer();
+    void FlushAudioBuffer();
     void EndDumping();
 
     std::atomic_bool is_dumping = false; ///< Whether the backend is currently dumping
@@ -184,10 +193,14 @@ private:
     Common::Event event1, event2;
     std::thread video_processing_thread;
 
-    /// An audio buffer used to temporarily hold audio data, before the size is big enough
-    /// to be sent to the encoder as a frame
+    /// Serializes the DSP adding audio with StopDumping ending the audio queue
+    std::mutex audio_mutex;
+    /// Samples added one at a time (by DSP LLE) are collected here before being queued
+    AudioChunk pending_audio{};
+    Common::SPSCQueue<AudioChunk> audio_chunk_queue;
+    /// Per-channel audio buffers used by the audio processing thread to temporarily hold audio
+    /// data, before the size is big enough to be sent to the encoder as a frame
     std::array<VariableAudioFrame, 2> audio_buffers;
-    std::array<Common::SPSCQueue<VariableAudioFrame>, 2> audio_frame_queues;
     std::thread audio_processing_thread;
 
     Common::Event processing_ended;
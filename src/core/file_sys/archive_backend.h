@@ -159,16 +159,26 @@ public:
     virtual u64 GetFreeBytes() const = 0;
 
     u64 GetOpenDelayNs() {
-        if (delay_generator != nullptr) {
-            return delay_generator->GetOpenDelayNs();
-        }
-        LOG_ERROR(Service_FS, "Delay generator was not initalized. Using default");
-        delay_generator = std::make_unique<DefaultDelayGenerator>();
-        return delay_generator->GetOpenDelayNs();
+        return GetDelayGenerator().GetOpenDelayNs();
+    }
+
+    /// Get the amount of time a 3ds needs to create, delete or rename a file or directory, or
+    /// to open a directory
+    u64 GetMetadataDelayNs() {
+        return GetDelayGenerator().GetMetadataDelayNs();
     }
 
 protected:
     std::unique_ptr<DelayGenerator> delay_generator;
+
+private:
+    DelayGenerator& GetDelayGenerator() {
+        if (delay_generator == nullptr) {
+            LOG_ERROR(Service_FS, "Delay generator was not initalized. Using default");
+            delay_generator = std::make_unique<DefaultDelayGenerator>();
+        }
+        return *delay_generator;
+    }
 };
 
 class ArchiveFactory : NonCopyable {
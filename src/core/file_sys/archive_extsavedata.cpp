@@ -14,6 +14,7 @@
 #include "core/file_sys/errors.h"
 #include "core/file_sys/path_parser.h"
 #include "core/file_sys/savedata_archive.h"
+#include "core/file_sys/write_back_cache.h"
 #include "core/hle/service/fs/archive.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -56,19 +57,10 @@ private:
     u64 size{};
 };
 
-class ExtSaveDataDelayGenerator : public DelayGenerator {
+class ExtSaveDataDelayGenerator : public MediaDelayGenerator {
 public:
-    u64 GetReadDelayNs(std::size_t length) override {
-        // This is the delay measured for a savedata read,
-        // not for extsaveData
-        // For now we will take that
-        static constexpr u64 slope(183);
-        static constexpr u64 offset(524879);
-        static constexpr u64 minimum(631826);
-        u64 ipc_delay_nanoseconds =
-            std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-        return ipc_delay_nanoseconds;
-    }
+    // The reads were measured for savedata, not for extsaveData. For now we will take that
+    ExtSaveDataDelayGenerator() : MediaDelayGenerator(sdmc_delay_profile) {}
 
     u64 GetOpenDelayNs() override {
         // This is the delay measured on N3DS with
@@ -139,7 +131,7 @@ public:
             break; // Expected 'success' case
         }
 
-        FileUtil::IOFile file(full_path, "r+b");
+        FileUtil::IOFile file = WriteBackCache::GetInstance().Open(full_path, true);
         if (!file.IsOpen()) {
             LOG_CRITICAL(Service_FS, "(unreachable) Unknown error opening {}", full_path);
             return ERROR_FILE_NOT_FOUND;
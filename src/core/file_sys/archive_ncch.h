@@ -75,8 +75,12 @@ public:
                                  const u8* buffer) override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
-    void Close() const override {}
-    void Flush() const override {}
+    bool Close() const override {
+        return true;
+    }
+    bool Flush() const override {
+        return true;
+    }
 
 private:
     std::vector<u8> file_buffer;
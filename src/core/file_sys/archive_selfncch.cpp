@@ -66,9 +66,13 @@ public:
         return false;
     }
 
-    void Close() const override {}
+    bool Close() const override {
+        return true;
+    }
 
-    void Flush() const override {}
+    bool Flush() const override {
+        return true;
+    }
 
 private:
     std::shared_ptr<std::vector<u8>> data;
@@ -12,6 +12,7 @@
 #include "core/file_sys/archive_systemsavedata.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/savedata_archive.h"
+#include "core/file_sys/write_back_cache.h"
 #include "core/hle/service/fs/archive.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -59,7 +60,7 @@ ResultVal<std::unique_ptr<ArchiveBackend>> ArchiveFactory_SystemSaveData::Open(c
         // TODO(Subv): Check error code, this one is probably wrong
         return ERR_NOT_FORMATTED;
     }
-    auto archive = std::make_unique<SaveDataArchive>(fullpath);
+    auto archive = std::make_unique<SaveDataArchive>(fullpath, nand_delay_profile);
     return MakeResult<std::unique_ptr<ArchiveBackend>>(std::move(archive));
 }
 
@@ -67,6 +68,7 @@ ResultCode ArchiveFactory_SystemSaveData::Format(const Path& path,
                                                  const FileSys::ArchiveFormatInfo& format_info,
                                                  u64 program_id) {
     std::string fullpath = GetSystemSaveDataPath(base_path, path);
+    WriteBackCache::GetInstance().Release(fullpath);
     FileUtil::DeleteDirRecursively(fullpath);
     FileUtil::CreateFullPath(fullpath);
     return RESULT_SUCCESS;
@@ -2,28 +2,53 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <algorithm>
 #include "core/file_sys/delay_generator.h"
 
 namespace FileSys {
 
+// The read delays were measured on O3DS and O2DS with
+// https://gist.github.com/B3n30/ac40eac20603f519ff106107f4ac9182
+// and the open delays with
+// https://gist.github.com/FearlessTobi/eb1d70619c65c7e6f02141d71e79a36e (romfs) and
+// https://gist.github.com/FearlessTobi/c37e143c314789251f98f2c45cd706d2 (sdmc and savedata).
+// From the results the average of each length was taken.
+// Writes were not measured yet, so the read delays are used for now.
+
+const MediaDelayProfile game_card_delay_profile{
+    {94, 582778, 663124},
+    {94, 582778, 663124},
+    9438006,
+};
+
+const MediaDelayProfile sdmc_delay_profile{
+    {183, 524879, 631826},
+    {183, 524879, 631826},
+    269082,
+};
+
+// NAND was not measured yet, so the SD card delays are used for now.
+const MediaDelayProfile nand_delay_profile = sdmc_delay_profile;
+
 DelayGenerator::~DelayGenerator() = default;
 
-u64 DefaultDelayGenerator::GetReadDelayNs(std::size_t length) {
-    // This is the delay measured for a romfs read.
-    // For now we will take that as a default
-    static constexpr u64 slope(94);
-    static constexpr u64 offset(582778);
-    static constexpr u64 minimum(663124);
-    u64 IPCDelayNanoseconds = std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-    return IPCDelayNanoseconds;
+u64 DelayGenerator::GetWriteDelayNs(std::size_t length) {
+    return GetReadDelayNs(length);
+}
+
+u64 DelayGenerator::GetMetadataDelayNs() {
+    return GetOpenDelayNs();
+}
+
+u64 MediaDelayGenerator::GetReadDelayNs(std::size_t length) {
+    return profile.read.GetDelayNs(length);
+}
+
+u64 MediaDelayGenerator::GetOpenDelayNs() {
+    return profile.open;
 }
 
-u64 DefaultDelayGenerator::GetOpenDelayNs() {
-    // This is the delay measured for a romfs open.
-    // For now we will take that as a default
-    static constexpr u64 IPCDelayNanoseconds(9438006);
-    return IPCDelayNanoseconds;
+u64 MediaDelayGenerator::GetWriteDelayNs(std::size_t length) {
+    return profile.write.GetDelayNs(length);
 }
 
 } // namespace FileSys
@@ -4,24 +4,64 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include "common/common_types.h"
 
 namespace FileSys {
 
+/// Delay of an operation on length bytes: max(length * slope + offset, minimum) nanoseconds
+struct LinearDelay {
+    u64 slope;
+    u64 offset;
+    u64 minimum;
+
+    constexpr u64 GetDelayNs(std::size_t length) const {
+        return std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
+    }
+};
+
+/// Delays of the file operations on one storage medium
+struct MediaDelayProfile {
+    LinearDelay read;
+    LinearDelay write;
+    u64 open;
+};
+
+extern const MediaDelayProfile game_card_delay_profile;
+extern const MediaDelayProfile sdmc_delay_profile;
+extern const MediaDelayProfile nand_delay_profile;
+
 class DelayGenerator {
 public:
     virtual ~DelayGenerator();
     virtual u64 GetReadDelayNs(std::size_t length) = 0;
     virtual u64 GetOpenDelayNs() = 0;
 
-    // TODO (B3N30): Add getter for all other file/directory io operations
+    /// Defaults to the read delay, as writes have not been measured yet
+    virtual u64 GetWriteDelayNs(std::size_t length);
+
+    /// Delay of creating, deleting or renaming a file or directory, or of opening a directory.
+    /// Defaults to the open delay, as these have not been measured yet.
+    virtual u64 GetMetadataDelayNs();
 };
 
-class DefaultDelayGenerator : public DelayGenerator {
+/// Delay generator of an archive on the given storage medium
+class MediaDelayGenerator : public DelayGenerator {
 public:
+    explicit MediaDelayGenerator(const MediaDelayProfile& profile) : profile(profile) {}
+
     u64 GetReadDelayNs(std::size_t length) override;
     u64 GetOpenDelayNs() override;
+    u64 GetWriteDelayNs(std::size_t length) override;
+
+private:
+    const MediaDelayProfile& profile;
+};
+
+class DefaultDelayGenerator : public MediaDelayGenerator {
+public:
+    DefaultDelayGenerator() : MediaDelayGenerator(game_card_delay_profile) {}
 };
 
 } // namespace FileSys
@@ -48,8 +48,8 @@ bool DiskFile::SetSize(const u64 size) const {
     return true;
 }
 
-void DiskFile::Close() const {
-    file->Close();
+bool DiskFile::Close() const {
+    return file->Close();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -34,10 +34,10 @@ public:
                                  const u8* buffer) override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
-    void Close() const override;
+    bool Close() const override;
 
-    void Flush() const override {
-        file->Flush();
+    bool Flush() const override {
+        return file->Flush();
     }
 
 protected:
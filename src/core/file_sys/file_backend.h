@@ -41,27 +41,37 @@ public:
     virtual ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
                                          const u8* buffer) = 0;
 
+    /**
+     * Get a pointer to the file data, for backends which hold it in host memory. Callers can then
+     * copy it straight to its destination instead of reading it into an intermediate buffer.
+     * @param offset Offset in bytes of the data
+     * @param length Length in bytes of the data
+     * @return Pointer to the data, or nullptr if the backend does not support it
+     */
+    virtual const u8* GetDirectPointer(u64 offset, std::size_t length) const {
+        return nullptr;
+    }
+
     /**
      * Get the amount of time a 3ds needs to read those data
      * @param length Length in bytes of data read from file
      * @return Nanoseconds for the delay
      */
     u64 GetReadDelayNs(std::size_t length) {
-        if (delay_generator != nullptr) {
-            return delay_generator->GetReadDelayNs(length);
-        }
-        LOG_ERROR(Service_FS, "Delay generator was not initalized. Using default");
-        delay_generator = std::make_unique<DefaultDelayGenerator>();
-        return delay_generator->GetReadDelayNs(length);
+        return GetDelayGenerator().GetReadDelayNs(length);
+    }
+
+    /**
+     * Get the amount of time a 3ds needs to write those data
+     * @param length Length in bytes of data written to file
+     * @return Nanoseconds for the delay
+     */
+    u64 GetWriteDelayNs(std::size_t length) {
+        return GetDelayGenerator().GetWriteDelayNs(length);
     }
 
     u64 GetOpenDelayNs() {
-        if (delay_generator != nullptr) {
-            return delay_generator->GetOpenDelayNs();
-        }
-        LOG_ERROR(Service_FS, "Delay generator was not initalized. Using default");
-        delay_generator = std::make_unique<DefaultDelayGenerator>();
-        return delay_generator->GetOpenDelayNs();
+        return GetDelayGenerator().GetOpenDelayNs();
     }
 
     /**
@@ -81,15 +91,25 @@ public:
      * Close the file
      * @return true if the file closed correctly
      */
-    virtual void Close() const = 0;
+    virtual bool Close() const = 0;
 
     /**
      * Flushes the file
+     * @return true if the data written so far is not known to be lost
      */
-    virtual void Flush() const = 0;
+    virtual bool Flush() const = 0;
 
 protected:
     std::unique_ptr<DelayGenerator> delay_generator;
+
+private:
+    DelayGenerator& GetDelayGenerator() {
+        if (delay_generator == nullptr) {
+            LOG_ERROR(Service_FS, "Delay generator was not initalized. Using default");
+            delay_generator = std::make_unique<DefaultDelayGenerator>();
+        }
+        return *delay_generator;
+    }
 };
 
 } // namespace FileSys
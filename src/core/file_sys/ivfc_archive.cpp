@@ -100,6 +100,10 @@ ResultVal<std::size_t> IVFCFile::Read(const u64 offset, const std::size_t length
     return MakeResult<std::size_t>(romfs_file->ReadFile(offset, length, buffer));
 }
 
+const u8* IVFCFile::GetDirectPointer(const u64 offset, const std::size_t length) const {
+    return romfs_file->GetDirectPointer(offset, length);
+}
+
 ResultVal<std::size_t> IVFCFile::Write(const u64 offset, const std::size_t length, const bool flush,
                                        const u8* buffer) {
     LOG_ERROR(Service_FS, "Attempted to write to IVFC file");
@@ -133,6 +137,12 @@ ResultVal<std::size_t> IVFCFileInMemory::Read(const u64 offset, const std::size_
     return MakeResult<std::size_t>(read_length);
 }
 
+const u8* IVFCFileInMemory::GetDirectPointer(const u64 offset, const std::size_t length) const {
+    if (offset > data_size || length > data_size - offset)
+        return nullptr;
+    return romfs_file.data() + data_offset + offset;
+}
+
 ResultVal<std::size_t> IVFCFileInMemory::Write(const u64 offset, const std::size_t length,
                                                const bool flush, const u8* buffer) {
     LOG_ERROR(Service_FS, "Attempted to write to IVFC file");
@@ -21,67 +21,19 @@
 
 namespace FileSys {
 
-class IVFCDelayGenerator : public DelayGenerator {
-    u64 GetReadDelayNs(std::size_t length) override {
-        // This is the delay measured for a romfs read.
-        // For now we will take that as a default
-        static constexpr u64 slope(94);
-        static constexpr u64 offset(582778);
-        static constexpr u64 minimum(663124);
-        u64 IPCDelayNanoseconds = std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-        return IPCDelayNanoseconds;
-    }
-
-    u64 GetOpenDelayNs() override {
-        // This is the delay measured for a romfs open.
-        // For now we will take that as a default
-        static constexpr u64 IPCDelayNanoseconds(9438006);
-        return IPCDelayNanoseconds;
-    }
+class IVFCDelayGenerator : public MediaDelayGenerator {
+public:
+    IVFCDelayGenerator() : MediaDelayGenerator(game_card_delay_profile) {}
 };
 
-class RomFSDelayGenerator : public DelayGenerator {
+class RomFSDelayGenerator : public MediaDelayGenerator {
 public:
-    u64 GetReadDelayNs(std::size_t length) override {
-        // The delay was measured on O3DS and O2DS with
-        // https://gist.github.com/B3n30/ac40eac20603f519ff106107f4ac9182
-        // from the results the average of each length was taken.
-        static constexpr u64 slope(94);
-        static constexpr u64 offset(582778);
-        static constexpr u64 minimum(663124);
-        u64 IPCDelayNanoseconds = std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-        return IPCDelayNanoseconds;
-    }
-
-    u64 GetOpenDelayNs() override {
-        // This is the delay measured on O3DS and O2DS with
-        // https://gist.github.com/FearlessTobi/eb1d70619c65c7e6f02141d71e79a36e
-        // from the results the average of each length was taken.
-        static constexpr u64 IPCDelayNanoseconds(9438006);
-        return IPCDelayNanoseconds;
-    }
+    RomFSDelayGenerator() : MediaDelayGenerator(game_card_delay_profile) {}
 };
 
-class ExeFSDelayGenerator : public DelayGenerator {
+class ExeFSDelayGenerator : public MediaDelayGenerator {
 public:
-    u64 GetReadDelayNs(std::size_t length) override {
-        // The delay was measured on O3DS and O2DS with
-        // https://gist.github.com/B3n30/ac40eac20603f519ff106107f4ac9182
-        // from the results the average of each length was taken.
-        static constexpr u64 slope(94);
-        static constexpr u64 offset(582778);
-        static constexpr u64 minimum(663124);
-        u64 IPCDelayNanoseconds = std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-        return IPCDelayNanoseconds;
-    }
-
-    u64 GetOpenDelayNs() override {
-        // This is the delay measured on O3DS and O2DS with
-        // https://gist.github.com/FearlessTobi/eb1d70619c65c7e6f02141d71e79a36e
-        // from the results the average of each length was taken.
-        static constexpr u64 IPCDelayNanoseconds(9438006);
-        return IPCDelayNanoseconds;
-    }
+    ExeFSDelayGenerator() : MediaDelayGenerator(game_card_delay_profile) {}
 };
 
 /**
@@ -117,12 +69,17 @@ public:
     IVFCFile(std::shared_ptr<RomFSReader> file, std::unique_ptr<DelayGenerator> delay_generator_);
 
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
+    const u8* GetDirectPointer(u64 offset, std::size_t length) const override;
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
                                  const u8* buffer) override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
-    void Close() const override {}
-    void Flush() const override {}
+    bool Close() const override {
+        return true;
+    }
+    bool Flush() const override {
+        return true;
+    }
 
 private:
     std::shared_ptr<RomFSReader> romfs_file;
@@ -142,12 +99,17 @@ public:
                      std::unique_ptr<DelayGenerator> delay_generator_);
 
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
+    const u8* GetDirectPointer(u64 offset, std::size_t length) const override;
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
                                  const u8* buffer) override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
-    void Close() const override {}
-    void Flush() const override {}
+    bool Close() const override {
+        return true;
+    }
+    bool Flush() const override {
+        return true;
+    }
 
 private:
     std::vector<u8> romfs_file;
@@ -4,12 +4,17 @@
 
 #include <algorithm>
 #include <cstring>
+#include <functional>
+#include <optional>
+#include <fmt/format.h>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/string_util.h"
 #include "common/swap.h"
+#include "core/cache_file.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/patch.h"
 
@@ -21,6 +26,10 @@ struct FileRelocationInfo {
     std::string replace_file_path; // Type 1
     std::vector<u8> patched_file;  // Type 2
     u64 size;                      // Relocated file size
+
+    // Type 1. Mapped lazily on first read; stays null if mapping failed
+    std::shared_ptr<const FileUtil::MappedFile> replace_file_mapping;
+    bool replace_file_mapped = false;
 };
 struct LayeredFS::File {
     std::string name;
@@ -51,6 +60,47 @@ struct FileMetadata {
 };
 static_assert(sizeof(FileMetadata) == 0x20, "Size of FileMetadata is not correct");
 
+/// Bump whenever the cached layout or the metadata building changes
+constexpr u32 layered_fs_cache_version = 2;
+
+namespace {
+/// Appends the relative path, size and modification time of every file under directory, in a
+/// stable order, so that any added, removed or modified file changes the result.
+void AppendDirectoryFingerprint(std::string directory, std::string& out) {
+    if (directory.empty()) {
+        return;
+    }
+    if (directory.back() != '/' && directory.back() != '\\') {
+        directory += DIR_SEP;
+    }
+
+    std::vector<std::string> entries;
+    std::function<void(const std::string&)> scan = [&](const std::string& relative) {
+        FileUtil::ForeachDirectoryEntry(
+            nullptr, directory + relative,
+            [&](u64* /*num_entries_out*/, const std::string& parent,
+                const std::string& virtual_name) {
+                const auto path = parent + virtual_name;
+                if (FileUtil::IsDirectory(path)) {
+                    scan(relative + virtual_name + DIR_SEP);
+                } else {
+                    entries.push_back(fmt::format("{}{}:{}:{}", relative, virtual_name,
+                                                  FileUtil::GetSize(path),
+                                                  FileUtil::GetFileModificationTimestamp(path)));
+                }
+                return true;
+            });
+    };
+    scan("");
+
+    std::sort(entries.begin(), entries.end());
+    for (const auto& entry : entries) {
+        out += entry;
+        out += '\0';
+    }
+}
+} // Anonymous namespace
+
 LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path_,
                      std::string patch_ext_path_, bool load_relocations_)
     : romfs(std::move(romfs_)), patch_path(std::move(patch_path_)),
@@ -63,6 +113,13 @@ void LayeredFS::Load() {
 
     ASSERT_MSG(header.header_length == sizeof(header), "Header size is incorrect");
 
+    // Only patched RomFS are cached; dumping needs the directory tree, which the cache lacks.
+    const u64 fingerprint = load_relocations ? ComputeFingerprint() : 0;
+    if (load_relocations && LoadCache(fingerprint)) {
+        LOG_INFO(Service_FS, "Loaded cached LayeredFS for {}", patch_path);
+        return;
+    }
+
     // TODO: is root always the first directory in table?
     root.parent = &root;
     LoadDirectory(root, 0);
@@ -73,6 +130,10 @@ void LayeredFS::Load() {
     }
 
     RebuildMetadata();
+
+    if (load_relocations) {
+        SaveCache(fingerprint);
+    }
 }
 
 LayeredFS::~LayeredFS() = default;
@@ -478,6 +539,217 @@ void LayeredFS::RebuildMetadata() {
                 header.file_metadata_table.length);
 }
 
+namespace {
+/**
+ * Looks up a directory or file entry of the original RomFS through its hash table, the way the
+ * game would, without loading the directory tree.
+ * @param name Name of the entry
+ * @param parent_offset Metadata offset of the directory containing the entry
+ * @param metadata Receives the metadata of the entry
+ * @return The offset of the entry in the metadata table, if it was found
+ */
+template <typename Metadata>
+std::optional<u32> FindOriginalEntry(RomFSReader& romfs, const RomFSHeader::Descriptor& hash_table,
+                       const RomFSHeader::Descriptor& metadata_table, const std::string& name,
+                       u32 parent_offset, Metadata& metadata) {
+    const u32 num_buckets = hash_table.length / sizeof(u32_le);
+    if (num_buckets == 0) {
+        return std::nullopt;
+    }
+
+    const std::u16string u16name = Common::UTF8ToUTF16(name);
+    const u32 bucket = CalcHash(name, parent_offset) % num_buckets;
+    u32_le offset;
+    romfs.ReadFile(hash_table.offset + bucket * sizeof(u32_le), sizeof(offset),
+                   reinterpret_cast<u8*>(&offset));
+    while (offset != 0xFFFFFFFF && offset < metadata_table.length) {
+        romfs.ReadFile(metadata_table.offset + offset, sizeof(metadata),
+                       reinterpret_cast<u8*>(&metadata));
+        if (metadata.parent_directory_offset == parent_offset &&
+            metadata.name_length == u16name.size() * 2) {
+            std::vector<u16_le> buffer(u16name.size());
+            romfs.ReadFile(metadata_table.offset + offset + sizeof(metadata),
+                           metadata.name_length, reinterpret_cast<u8*>(buffer.data()));
+            if (std::equal(buffer.begin(), buffer.end(), u16name.begin(),
+                           [](u16_le a, char16_t b) { return static_cast<u16>(a) == b; })) {
+                return offset;
+            }
+        }
+        offset = metadata.hash_bucket_next;
+    }
+    return std::nullopt;
+}
+
+/// Looks up a file of the original RomFS by its path, which starts with '/'
+bool FindOriginalFile(RomFSReader& romfs, const RomFSHeader& header, const std::string& path,
+                      FileMetadata& metadata) {
+    u32 directory_offset = 0; // The root directory
+    std::size_t begin = 1;
+    for (std::size_t end = path.find('/', begin); end != std::string::npos;
+         end = path.find('/', begin)) {
+        DirectoryMetadata directory;
+        const auto offset =
+            FindOriginalEntry(romfs, header.directory_hash_table, header.directory_metadata_table,
+                              path.substr(begin, end - begin), directory_offset, directory);
+        if (!offset) {
+            return false;
+        }
+        directory_offset = *offset;
+        begin = end + 1;
+    }
+    return FindOriginalEntry(romfs, header.file_hash_table, header.file_metadata_table,
+                             path.substr(begin), directory_offset, metadata)
+        .has_value();
+}
+} // Anonymous namespace
+
+u64 LayeredFS::ComputeFingerprint() {
+    // The original metadata stands in for the contents of unpatched files: they are only ever
+    // read through their recorded offsets, which are part of it. Patched files are baked into the
+    // cache, so their original contents are hashed as well.
+    std::vector<u8> original_metadata(header.file_data_offset);
+    romfs->ReadFile(0, original_metadata.size(), original_metadata.data());
+
+    const u64 metadata_hash = Common::ComputeHash64(original_metadata.data(),
+                                                    static_cast<u32>(original_metadata.size()));
+    std::string state = fmt::format("{}:{}:{}:{}", romfs->GetSize(), metadata_hash, patch_path,
+                                    patch_ext_path);
+    state += '\0';
+    AppendDirectoryFingerprint(patch_path, state);
+    state += '\0';
+    AppendDirectoryFingerprint(patch_ext_path, state);
+    state += '\0';
+    AppendPatchedFileHashes(state);
+    return Common::ComputeHash64(state.data(), static_cast<u32>(state.size()));
+}
+
+void LayeredFS::AppendPatchedFileHashes(std::string& out) {
+    if (!FileUtil::Exists(patch_ext_path)) {
+        return;
+    }
+
+    // Same lookup as LoadExtRelocations, which may not have run yet
+    std::string ext_path = patch_ext_path;
+    if (ext_path.back() == '/' || ext_path.back() == '\\') {
+        ext_path.erase(ext_path.size() - 1, 1);
+    }
+
+    FileUtil::FSTEntry result;
+    FileUtil::ScanDirectoryTree(ext_path, result, 256);
+
+    std::vector<std::string> entries;
+    for (const auto& entry : result.children) {
+        const auto path = entry.physicalName.substr(ext_path.size());
+        if (path.size() < 4 || FileUtil::IsDirectory(entry.physicalName)) {
+            continue;
+        }
+        const auto extension = path.substr(path.size() - 4);
+        const auto file_path = path.substr(0, path.size() - 4);
+        FileMetadata metadata;
+        if ((extension != ".ips" && extension != ".bps") ||
+            !FindOriginalFile(*romfs, header, file_path, metadata)) {
+            continue;
+        }
+
+        std::vector<u8> original(metadata.file_data_length);
+        romfs->ReadFile(header.file_data_offset + metadata.file_data_offset, original.size(),
+                        original.data());
+        entries.push_back(fmt::format(
+            "{}:{}", file_path,
+            Common::ComputeHash64(original.data(), static_cast<u32>(original.size()))));
+    }
+
+    std::sort(entries.begin(), entries.end());
+    for (const auto& entry : entries) {
+        out += entry;
+        out += '\0';
+    }
+}
+
+std::string LayeredFS::GetCachePath() const {
+    const u64 path_hash =
+        Common::ComputeHash64(patch_path.data(), static_cast<u32>(patch_path.size()));
+    return fmt::format("{}layeredfs{}{:016X}.cache",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), DIR_SEP, path_hash);
+}
+
+bool LayeredFS::LoadCache(u64 fingerprint) {
+    const auto path = GetCachePath();
+    if (!FileUtil::Exists(path)) {
+        return false;
+    }
+
+    Core::CacheFile file(path, Core::CacheFile::MODE_LOAD);
+    u32 version = 0;
+    file.DoHeader(version);
+    u64 cached_fingerprint = 0;
+    file.Do(cached_fingerprint);
+    if (!file.IsGood() || version != layered_fs_cache_version ||
+        cached_fingerprint != fingerprint) {
+        LOG_INFO(Service_FS, "LayeredFS cache for {} is stale, rebuilding", patch_path);
+        return false;
+    }
+
+    file.Do(metadata);
+    file.Do(current_data_offset);
+    u32 count = 0;
+    file.Do(count);
+    for (u32 i = 0; i < count && file.IsGood(); i++) {
+        auto entry = std::make_unique<File>();
+        u64 data_offset = 0;
+        file.Do(data_offset);
+        file.Do(entry->path);
+        file.Do(entry->relocation.type);
+        file.Do(entry->relocation.original_offset);
+        file.Do(entry->relocation.replace_file_path);
+        file.Do(entry->relocation.patched_file);
+        file.Do(entry->relocation.size);
+        data_offset_map.emplace(data_offset, entry.get());
+        cached_files.push_back(std::move(entry));
+    }
+
+    if (!file.IsGood() || data_offset_map.size() != count) {
+        LOG_ERROR(Service_FS, "LayeredFS cache for {} is corrupt, rebuilding", patch_path);
+        metadata.clear();
+        current_data_offset = 0;
+        data_offset_map.clear();
+        cached_files.clear();
+        return false;
+    }
+    return true;
+}
+
+void LayeredFS::SaveCache(u64 fingerprint) {
+    const auto path = GetCachePath();
+    if (!FileUtil::CreateFullPath(path)) {
+        LOG_ERROR(Service_FS, "Could not create path {}", path);
+        return;
+    }
+
+    Core::CacheFile file(path, Core::CacheFile::MODE_SAVE);
+    u32 version = layered_fs_cache_version;
+    file.DoHeader(version);
+    file.Do(fingerprint);
+    file.Do(metadata);
+    file.Do(current_data_offset);
+    auto count = static_cast<u32>(data_offset_map.size());
+    file.Do(count);
+    for (auto& [offset, entry] : data_offset_map) {
+        u64 data_offset = offset;
+        file.Do(data_offset);
+        file.Do(entry->path);
+        file.Do(entry->relocation.type);
+        file.Do(entry->relocation.original_offset);
+        file.Do(entry->relocation.replace_file_path);
+        file.Do(entry->relocation.patched_file);
+        file.Do(entry->relocation.size);
+    }
+
+    if (!file.IsGood()) {
+        LOG_ERROR(Service_FS, "Could not write LayeredFS cache {}", path);
+    }
+}
+
 std::size_t LayeredFS::GetSize() const {
     return metadata.size() + current_data_offset;
 }
@@ -517,8 +789,24 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
             romfs->ReadFile(relocation.original_offset + relative_offset, to_read,
                             buffer + read_size);
         } else if (relocation.type == 1) { // replace
-            FileUtil::IOFile replace_file(relocation.replace_file_path, "rb");
-            if (replace_file) {
+            std::shared_ptr<const FileUtil::MappedFile> mapping;
+            {
+                std::lock_guard lock{replacement_mutex};
+                if (!relocation.replace_file_mapped) {
+                    relocation.replace_file_mapped = true;
+                    auto mapped = std::make_shared<const FileUtil::MappedFile>(
+                        FileUtil::IOFile(relocation.replace_file_path, "rb"));
+                    if (mapped->IsOpen()) {
+                        relocation.replace_file_mapping = std::move(mapped);
+                    }
+                }
+                mapping = relocation.replace_file_mapping;
+            }
+
+            if (mapping && mapping->GetSize() >= relative_offset + to_read) {
+                std::memcpy(buffer + read_size, mapping->GetData() + relative_offset, to_read);
+            } else if (FileUtil::IOFile replace_file(relocation.replace_file_path, "rb");
+                       replace_file) {
                 replace_file.Seek(relative_offset, SEEK_SET);
                 replace_file.ReadBytes(buffer + read_size, to_read);
             } else {
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -37,6 +38,9 @@ static_assert(sizeof(RomFSHeader) == 0x28, "Size of RomFSHeader is not correct")
  * patch_ext_path: Path for RomFS extensions. Files present in this path:
  *  - When with an extension of ".stub", remove the corresponding file in the RomFS.
  *  - When with an extension of ".ips" or ".bps", patch the file in the RomFS.
+ *
+ * The rebuilt metadata and relocations are cached on disk, keyed by the RomFS metadata and the
+ * names, sizes and modification times of everything in the patch paths.
  */
 class LayeredFS : public RomFSReader {
 public:
@@ -94,6 +98,20 @@ private:
 
     void RebuildMetadata();
 
+    // Hashes the RomFS metadata, the state of the patch directories and the original contents of
+    // the files patched by IPS/BPS patches. Patched files are looked up through the original hash
+    // tables, so this does not need the directory tree.
+    u64 ComputeFingerprint();
+
+    void AppendPatchedFileHashes(std::string& out);
+
+    std::string GetCachePath() const;
+
+    // Restores the metadata and relocations saved by SaveCache if the fingerprint matches
+    bool LoadCache(u64 fingerprint);
+
+    void SaveCache(u64 fingerprint);
+
     void Load();
 
     std::shared_ptr<RomFSReader> romfs;
@@ -108,6 +126,9 @@ private:
     std::map<u64, File*> data_offset_map; // assigned data offset -> file
     std::vector<u8> metadata;             // Includes header, hash table and metadata
 
+    std::vector<std::unique_ptr<File>> cached_files; // Files restored from the cache
+    std::mutex replacement_mutex;                    // Guards lazily mapping replacement files
+
     // Used for rebuilding header
     std::vector<u32_le> directory_hash_table;
     std::vector<u32_le> file_hash_table;
@@ -8,8 +8,11 @@
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include <cryptopp/sha.h>
+#include "common/common_paths.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "core/cache_file.h"
 #include "core/core.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/ncch_container.h"
@@ -25,6 +28,7 @@ namespace FileSys {
 
 static const int kMaxSections = 8;   ///< Maximum number of sections (files) in an ExeFs
 static const int kBlockSize = 0x200; ///< Size of ExeFS blocks (in bytes)
+static const u32 kCodeCacheVersion = 1; ///< Bump when decompression or patching output changes
 
 u64 GetModId(u64 program_id) {
     constexpr u64 UPDATE_MASK = 0x0000000e'00000000;
@@ -34,48 +38,47 @@ u64 GetModId(u64 program_id) {
     return program_id;
 }
 
-/**
- * Get the decompressed size of an LZSS compressed ExeFS file
- * @param buffer Buffer of compressed file
- * @param size Size of compressed buffer
- * @return Size of decompressed buffer
- */
-static u32 LZSS_GetDecompressedSize(const u8* buffer, u32 size) {
+u32 LZSS_GetDecompressedSize(const u8* buffer, u32 size) {
     u32 offset_size;
     std::memcpy(&offset_size, buffer + size - sizeof(u32), sizeof(u32));
     return offset_size + size;
 }
 
-/**
- * Decompress ExeFS file (compressed with LZSS)
- * @param compressed Compressed buffer
- * @param compressed_size Size of compressed buffer
- * @param decompressed Decompressed buffer
- * @param decompressed_size Size of decompressed buffer
- * @return True on success, otherwise false
- */
-static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decompressed,
-                            u32 decompressed_size) {
+bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decompressed,
+                     u32 decompressed_size) {
+    if (compressed_size < 8 || decompressed_size < compressed_size)
+        return false;
+
     const u8* footer = compressed + compressed_size - 8;
 
     u32 buffer_top_and_bottom;
     std::memcpy(&buffer_top_and_bottom, footer, sizeof(u32));
 
+    const u32 header_size = (buffer_top_and_bottom >> 24) & 0xFF;
+    if (header_size > compressed_size)
+        return false;
+
     u32 out = decompressed_size;
-    u32 index = compressed_size - ((buffer_top_and_bottom >> 24) & 0xFF);
+    u32 index = compressed_size - header_size;
     u32 stop_index = compressed_size - (buffer_top_and_bottom & 0xFFFFFF);
 
-    memset(decompressed, 0, decompressed_size);
     memcpy(decompressed, compressed, compressed_size);
+    memset(decompressed + compressed_size, 0, decompressed_size - compressed_size);
 
     while (index > stop_index) {
         u8 control = compressed[--index];
 
+        // Eight literals in a row, which is common in poorly compressible data
+        if (control == 0 && index - stop_index >= 8 && out >= 8) {
+            index -= 8;
+            out -= 8;
+            std::memcpy(decompressed + out, compressed + index, 8);
+            continue;
+        }
+
         for (unsigned i = 0; i < 8; i++) {
             if (index <= stop_index)
                 break;
-            if (index <= 0)
-                break;
             if (out <= 0)
                 break;
 
@@ -90,22 +93,23 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
                 segment_offset &= 0x0FFF;
                 segment_offset += 2;
 
-                // Check if compression is out of bounds
-                if (out < segment_size)
+                // Check if compression is out of bounds. The segment is copied backwards, so
+                // its first byte is read from the highest address.
+                if (out < segment_size || out + segment_offset >= decompressed_size)
                     return false;
 
-                for (unsigned j = 0; j < segment_size; j++) {
-                    // Check if compression is out of bounds
-                    if (out + segment_offset >= decompressed_size)
-                        return false;
-
-                    u8 data = decompressed[out + segment_offset];
-                    decompressed[--out] = data;
+                // Each byte is written segment_offset + 1 bytes below where it is read from
+                const u32 distance = segment_offset + 1;
+                out -= segment_size;
+                if (distance >= segment_size) {
+                    std::memcpy(decompressed + out, decompressed + out + distance, segment_size);
+                } else {
+                    // The source overlaps the bytes being written, which repeats a pattern
+                    for (u32 j = segment_size; j-- > 0;) {
+                        decompressed[out + j] = decompressed[out + j + distance];
+                    }
                 }
             } else {
-                // Check if compression is out of bounds
-                if (out < 1)
-                    return false;
                 decompressed[--out] = compressed[--index];
             }
             control <<= 1;
@@ -114,6 +118,65 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
     return true;
 }
 
+/**
+ * Get the path of a cached .code section
+ * @param program_id Program ID of the title the code belongs to
+ * @param stage Which stage of loading the cached code is from, "decompressed" or "patched"
+ * @return Path of the cache file
+ */
+static std::string GetCodeCachePath(u64 program_id, const char* stage) {
+    return fmt::format("{}code{}{:016X}.{}.cache",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), DIR_SEP, program_id,
+                       stage);
+}
+
+/**
+ * Load code from a cache file
+ * @param path Path of the cache file
+ * @param key Key the code must have been cached with
+ * @param code Receives the cached code
+ * @return True if the cache held code for this key
+ */
+static bool LoadCachedCode(const std::string& path, u64 key, std::vector<u8>& code) {
+    if (!FileUtil::Exists(path))
+        return false;
+
+    Core::CacheFile file(path, Core::CacheFile::MODE_LOAD);
+    u32 version = 0;
+    file.DoHeader(version);
+    u64 cached_key = 0;
+    file.Do(cached_key);
+    if (!file.IsGood() || version != kCodeCacheVersion || cached_key != key)
+        return false;
+
+    std::vector<u8> cached_code;
+    file.Do(cached_code);
+    if (!file.IsGood())
+        return false;
+
+    code = std::move(cached_code);
+    return true;
+}
+
+/**
+ * Save code to a cache file, replacing whatever it held before
+ * @param path Path of the cache file
+ * @param key Key to cache the code with
+ * @param code Code to cache
+ */
+static void SaveCachedCode(const std::string& path, u64 key, std::vector<u8>& code) {
+    if (!FileUtil::CreateFullPath(path))
+        return;
+
+    Core::CacheFile file(path, Core::CacheFile::MODE_SAVE);
+    u32 version = kCodeCacheVersion;
+    file.DoHeader(version);
+    file.Do(key);
+    file.Do(code);
+    if (!file.IsGood())
+        LOG_WARNING(Service_FS, "Could not write code cache {}", path);
+}
+
 NCCHContainer::NCCHContainer(const std::string& filepath, u32 ncch_offset, u32 partition)
     : ncch_offset(ncch_offset), partition(partition), filepath(filepath) {
     file.Open(filepath, "rb");
@@ -239,12 +302,19 @@ Loader::ResultStatus NCCHContainer::Load() {
                     }
                 }
 
-                SetKeyY(KeySlotID::NCCHSecure1, key_y_primary);
-                if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure1)) {
-                    LOG_ERROR(Service_FS, "Secure1 KeyX missing");
-                    failed_to_decrypt = true;
-                }
-                primary_key = GetNormalKey(KeySlotID::NCCHSecure1);
+                // The key slots are shared, so the normal keys are derived without setting KeyY
+                const auto generate_key = [&failed_to_decrypt](std::size_t slot_id,
+                                                               const AESKey& key_y,
+                                                               const char* name) {
+                    const auto key = GenerateNormalKey(slot_id, key_y);
+                    if (!key) {
+                        LOG_ERROR(Service_FS, "{} KeyX missing", name);
+                        failed_to_decrypt = true;
+                    }
+                    return key.value_or(AESKey{});
+                };
+
+                primary_key = generate_key(KeySlotID::NCCHSecure1, key_y_primary, "Secure1");
 
                 switch (ncch_header.secondary_key_slot) {
                 case 0:
@@ -253,30 +323,18 @@ Loader::ResultStatus NCCHContainer::Load() {
                     break;
                 case 1:
                     LOG_DEBUG(Service_FS, "Secure2 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure2, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure2)) {
-                        LOG_ERROR(Service_FS, "Secure2 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure2);
+                    secondary_key =
+                        generate_key(KeySlotID::NCCHSecure2, key_y_secondary, "Secure2");
                     break;
                 case 10:
                     LOG_DEBUG(Service_FS, "Secure3 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure3, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure3)) {
-                        LOG_ERROR(Service_FS, "Secure3 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure3);
+                    secondary_key =
+                        generate_key(KeySlotID::NCCHSecure3, key_y_secondary, "Secure3");
                     break;
                 case 11:
                     LOG_DEBUG(Service_FS, "Secure4 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure4, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure4)) {
-                        LOG_ERROR(Service_FS, "Secure4 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure4);
+                    secondary_key =
+                        generate_key(KeySlotID::NCCHSecure4, key_y_secondary, "Secure4");
                     break;
                 }
             }
@@ -428,6 +486,7 @@ Loader::ResultStatus NCCHContainer::Load() {
             }
 
             exefs_file.Open(filepath, "rb");
+            exefs_mapping = std::make_shared<const FileUtil::MappedFile>(exefs_file);
             has_exefs = true;
         }
 
@@ -457,6 +516,7 @@ Loader::ResultStatus NCCHContainer::LoadOverrides() {
     std::string exefsdir_override = filepath + ".exefsdir/";
     if (FileUtil::Exists(exefs_override)) {
         exefs_file.Open(exefs_override, "rb");
+        exefs_mapping = std::make_shared<const FileUtil::MappedFile>(exefs_file);
 
         if (exefs_file.ReadBytes(&exefs_header, sizeof(ExeFs_Header)) == sizeof(ExeFs_Header)) {
             LOG_DEBUG(Service_FS, "Loading ExeFS section from {}", exefs_override);
@@ -465,6 +525,7 @@ Loader::ResultStatus NCCHContainer::LoadOverrides() {
             has_exefs = true;
         } else {
             exefs_file.Open(filepath, "rb");
+            exefs_mapping = std::make_shared<const FileUtil::MappedFile>(exefs_file);
         }
     } else if (FileUtil::Exists(exefsdir_override) && FileUtil::IsDirectory(exefsdir_override)) {
         is_tainted = true;
@@ -483,6 +544,9 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
     if (result != Loader::ResultStatus::Success)
         return result;
 
+    if (std::strcmp(name, ".code") == 0)
+        code_hash.reset();
+
     // Check if we have files that can drop-in and replace
     result = LoadOverrideExeFSSection(name, buffer);
     if (result == Loader::ResultStatus::Success || !has_exefs)
@@ -524,7 +588,16 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
 
             s64 section_offset =
                 (section.offset + exefs_offset + sizeof(ExeFs_Header) + ncch_offset);
-            exefs_file.Seek(section_offset, SEEK_SET);
+
+            // Read straight out of the mapping when there is one, avoiding a copy through the
+            // file buffer.
+            const u8* mapped_section = nullptr;
+            if (exefs_mapping && exefs_mapping->IsOpen() &&
+                section_offset + section.size <= exefs_mapping->GetSize()) {
+                mapped_section = exefs_mapping->GetData() + section_offset;
+            } else {
+                exefs_file.Seek(section_offset, SEEK_SET);
+            }
 
             std::array<u8, 16> key;
             if (strcmp(section.name, "icon") == 0 || strcmp(section.name, "banner") == 0) {
@@ -537,35 +610,64 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                                                               exefs_ctr.data());
             dec.Seek(section.offset + sizeof(ExeFs_Header));
 
+            // Reads the whole section into dest, decrypting it if needed
+            const auto read_section = [&](u8* dest) {
+                if (mapped_section != nullptr) {
+                    if (is_encrypted) {
+                        dec.ProcessData(dest, mapped_section, section.size);
+                    } else {
+                        std::memcpy(dest, mapped_section, section.size);
+                    }
+                    return true;
+                }
+                if (exefs_file.ReadBytes(dest, section.size) != section.size)
+                    return false;
+                if (is_encrypted) {
+                    dec.ProcessData(dest, dest, section.size);
+                }
+                return true;
+            };
+
             if (strcmp(section.name, ".code") == 0 && is_compressed) {
                 // Section is compressed, read compressed .code section...
+                const u8* compressed = mapped_section;
                 std::unique_ptr<u8[]> temp_buffer;
-                try {
-                    temp_buffer.reset(new u8[section.size]);
-                } catch (std::bad_alloc&) {
-                    return Loader::ResultStatus::ErrorMemoryAllocationFailed;
-                }
+                if (compressed == nullptr || is_encrypted) {
+                    try {
+                        temp_buffer.reset(new u8[section.size]);
+                    } catch (std::bad_alloc&) {
+                        return Loader::ResultStatus::ErrorMemoryAllocationFailed;
+                    }
 
-                if (exefs_file.ReadBytes(&temp_buffer[0], section.size) != section.size)
-                    return Loader::ResultStatus::Error;
+                    if (!read_section(&temp_buffer[0]))
+                        return Loader::ResultStatus::Error;
+                    compressed = &temp_buffer[0];
+                }
 
-                if (is_encrypted) {
-                    dec.ProcessData(&temp_buffer[0], &temp_buffer[0], section.size);
+                // The caches are keyed on the data actually read rather than on the hash in the
+                // ExeFS header, which modified ExeFS images do not always update
+                code_hash = Common::ComputeHash64(compressed, section.size);
+                const std::string code_cache_path =
+                    GetCodeCachePath(ncch_header.program_id, "decompressed");
+                if (LoadCachedCode(code_cache_path, *code_hash, buffer)) {
+                    LOG_DEBUG(Service_FS, "Loaded decompressed .code from {}", code_cache_path);
+                    return Loader::ResultStatus::Success;
                 }
 
                 // Decompress .code section...
-                u32 decompressed_size = LZSS_GetDecompressedSize(&temp_buffer[0], section.size);
+                u32 decompressed_size = LZSS_GetDecompressedSize(compressed, section.size);
                 buffer.resize(decompressed_size);
-                if (!LZSS_Decompress(&temp_buffer[0], section.size, &buffer[0], decompressed_size))
+                if (!LZSS_Decompress(compressed, section.size, &buffer[0], decompressed_size))
                     return Loader::ResultStatus::ErrorInvalidFormat;
+
+                SaveCachedCode(code_cache_path, *code_hash, buffer);
             } else {
                 // Section is uncompressed...
                 buffer.resize(section.size);
-                if (exefs_file.ReadBytes(&buffer[0], section.size) != section.size)
+                if (!read_section(&buffer[0]))
                     return Loader::ResultStatus::Error;
-                if (is_encrypted) {
-                    dec.ProcessData(&buffer[0], &buffer[0], section.size);
-                }
+                if (strcmp(section.name, ".code") == 0)
+                    code_hash = Common::ComputeHash64(buffer.data(), section.size);
             }
 
             return Loader::ResultStatus::Success;
@@ -601,10 +703,27 @@ Loader::ResultStatus NCCHContainer::ApplyCodePatch(std::vector<u8>& code) const
         if (file.ReadBytes(patch.data(), patch.size()) != patch.size())
             return Loader::ResultStatus::Error;
 
+        // Patching is deterministic, so the result can be reused as long as neither the code
+        // (including the size of .bss) nor the patch changed
+        std::optional<u64> cache_key;
+        const std::string cache_path = GetCodeCachePath(ncch_header.program_id, "patched");
+        if (code_hash) {
+            const u64 patch_hash =
+                Common::ComputeHash64(patch.data(), static_cast<u32>(patch.size()));
+            const std::array<u64, 3> key_data{*code_hash, code.size(), patch_hash};
+            cache_key = Common::ComputeHash64(key_data.data(), sizeof(key_data));
+            if (LoadCachedCode(cache_path, *cache_key, code)) {
+                LOG_INFO(Service_FS, "File {} patching code.bin (cached)", info.path);
+                return Loader::ResultStatus::Success;
+            }
+        }
+
         LOG_INFO(Service_FS, "File {} patching code.bin", info.path);
         if (!info.patch_fn(patch, code))
             return Loader::ResultStatus::Error;
 
+        if (cache_key)
+            SaveCachedCode(cache_path, *cache_key, code);
         return Loader::ResultStatus::Success;
     }
     return Loader::ResultStatus::ErrorNotUsed;
@@ -689,8 +808,8 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
             std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner), romfs_offset,
                                                 romfs_size, secondary_key, romfs_ctr, 0x1000);
     } else {
-        direct_romfs = std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner),
-                                                           romfs_offset, romfs_size);
+        direct_romfs =
+            MakeUnencryptedRomFSReader(std::move(romfs_file_inner), romfs_offset, romfs_size);
     }
 
     const auto path =
@@ -731,8 +850,8 @@ Loader::ResultStatus NCCHContainer::ReadOverrideRomFS(std::shared_ptr<RomFSReade
         if (romfs_file_inner.IsOpen()) {
             LOG_WARNING(Service_FS, "File {} overriding built-in RomFS; LayeredFS not enabled",
                         split_filepath);
-            romfs_file = std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner), 0,
-                                                             romfs_file_inner.GetSize());
+            const std::size_t romfs_size = romfs_file_inner.GetSize();
+            romfs_file = MakeUnencryptedRomFSReader(std::move(romfs_file_inner), 0, romfs_size);
             return Loader::ResultStatus::Success;
         }
     }
@@ -1,22 +1,195 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include "core/file_sys/romfs_reader.h"
 
 namespace FileSys {
 
+namespace {
+/// Reads larger than this skip the cache, so that a single big read does not evict everything
+constexpr std::size_t cache_bypass_threshold =
+    DirectRomFSReader::cache_block_size * DirectRomFSReader::cache_block_count / 4;
+} // Anonymous namespace
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size)
+    : is_encrypted(false), file_offset(file_offset), crypto_offset(0), data_size(data_size),
+      file(std::move(file)) {}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size, const std::array<u8, 16>& key,
+                                     const std::array<u8, 16>& ctr, std::size_t crypto_offset)
+    : is_encrypted(true), file_offset(file_offset), crypto_offset(crypto_offset),
+      data_size(data_size), file(std::move(file)),
+      decryptor(std::make_unique<CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption>(
+          key.data(), key.size(), ctr.data())) {}
+
+DirectRomFSReader::~DirectRomFSReader() {
+    {
+        std::lock_guard lock{cache_mutex};
+        stop_read_ahead = true;
+    }
+    read_ahead_cv.notify_one();
+    if (read_ahead_thread.joinable()) {
+        read_ahead_thread.join();
+    }
+}
+
 std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
+    if (length == 0 || offset >= data_size)
         return 0; // Crypto++ does not like zero size buffer
-    file.Seek(file_offset + offset, SEEK_SET);
-    std::size_t read_length = std::min(length, static_cast<std::size_t>(data_size) - offset);
-    read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
-        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-        d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+    const std::size_t read_length = std::min(length, static_cast<std::size_t>(data_size) - offset);
+
+    if (read_length > cache_bypass_threshold) {
+        return ReadUncached(offset, read_length, buffer);
+    }
+
+    bool sequential;
+    {
+        std::lock_guard lock{cache_mutex};
+        sequential = offset == last_read_end;
+        last_read_end = offset + read_length;
+    }
+
+    const std::size_t first_block = offset / cache_block_size;
+    const std::size_t last_block = (offset + read_length - 1) / cache_block_size;
+    std::size_t copied = 0;
+    for (std::size_t index = first_block; index <= last_block; index++) {
+        const Block block = GetBlock(index);
+        const std::size_t block_start = index * cache_block_size;
+        const std::size_t begin = std::max(offset, block_start) - block_start;
+        if (begin >= block->size()) {
+            break;
+        }
+        const std::size_t size = std::min(block->size() - begin, read_length - copied);
+        std::memcpy(buffer + copied, block->data() + begin, size);
+        copied += size;
+        if (block->size() < cache_block_size) {
+            break; // Short read from the file
+        }
+    }
+
+    if (sequential) {
+        QueueReadAhead(last_block + 1);
+    }
+    return copied;
+}
+
+std::size_t DirectRomFSReader::ReadUncached(std::size_t offset, std::size_t length, u8* buffer) {
+    const std::size_t read_length = file.ReadBytesAt(buffer, length, file_offset + offset);
+    if (is_encrypted && read_length != 0) {
+        std::lock_guard lock{decryptor_mutex};
+        decryptor->Seek(crypto_offset + offset);
+        decryptor->ProcessData(buffer, buffer, read_length);
+    }
+    return read_length;
+}
+
+DirectRomFSReader::Block DirectRomFSReader::LookupBlock(std::size_t index) {
+    std::lock_guard lock{cache_mutex};
+    const auto it = cache.find(index);
+    if (it == cache.end()) {
+        return nullptr;
+    }
+    lru.splice(lru.begin(), lru, it->second.second);
+    return it->second.first;
+}
+
+DirectRomFSReader::Block DirectRomFSReader::GetBlock(std::size_t index) {
+    if (Block block = LookupBlock(index)) {
+        return block;
+    }
+
+    std::lock_guard load_lock{load_mutex};
+    // The other thread may have loaded the block while we were waiting.
+    if (Block block = LookupBlock(index)) {
+        return block;
+    }
+
+    const std::size_t offset = index * cache_block_size;
+    auto data = std::make_shared<std::vector<u8>>(
+        std::min(cache_block_size, static_cast<std::size_t>(data_size) - offset));
+    data->resize(ReadUncached(offset, data->size(), data->data()));
+    Block block = std::move(data);
+
+    std::lock_guard cache_lock{cache_mutex};
+    lru.push_front(index);
+    cache.emplace(index, std::make_pair(block, lru.begin()));
+    if (cache.size() > cache_block_count) {
+        cache.erase(lru.back());
+        lru.pop_back();
+    }
+    return block;
+}
+
+void DirectRomFSReader::QueueReadAhead(std::size_t first_index) {
+    const std::size_t block_total = (data_size + cache_block_size - 1) / cache_block_size;
+    {
+        std::lock_guard lock{cache_mutex};
+        for (std::size_t index = first_index;
+             index < std::min(first_index + read_ahead_blocks, block_total); index++) {
+            if (cache.count(index) == 0 &&
+                std::find(read_ahead_queue.begin(), read_ahead_queue.end(), index) ==
+                    read_ahead_queue.end()) {
+                read_ahead_queue.push_back(index);
+            }
+        }
+        if (read_ahead_queue.empty()) {
+            return;
+        }
+        // Most readers are only used for a handful of random reads, so the thread is only
+        // started once sequential access is seen.
+        if (!read_ahead_thread.joinable()) {
+            read_ahead_thread = std::thread(&DirectRomFSReader::ReadAheadThread, this);
+        }
+    }
+    read_ahead_cv.notify_one();
+}
+
+void DirectRomFSReader::ReadAheadThread() {
+    std::unique_lock lock{cache_mutex};
+    while (true) {
+        read_ahead_cv.wait(lock, [this] { return stop_read_ahead || !read_ahead_queue.empty(); });
+        if (stop_read_ahead) {
+            return;
+        }
+        const std::size_t index = read_ahead_queue.front();
+        read_ahead_queue.erase(read_ahead_queue.begin());
+
+        lock.unlock();
+        GetBlock(index);
+        lock.lock();
     }
+}
+
+MappedRomFSReader::MappedRomFSReader(std::shared_ptr<const FileUtil::MappedFile> mapping_,
+                                     std::size_t data_offset_, std::size_t data_size_)
+    : mapping(std::move(mapping_)), data_offset(std::min(data_offset_, mapping->GetSize())),
+      data_size(std::min(data_size_, mapping->GetSize() - data_offset)) {}
+
+std::size_t MappedRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
+    if (offset >= data_size)
+        return 0;
+    const std::size_t read_length = std::min(length, data_size - offset);
+    std::memcpy(buffer, mapping->GetData() + data_offset + offset, read_length);
     return read_length;
 }
 
+const u8* MappedRomFSReader::GetDirectPointer(std::size_t offset, std::size_t length) const {
+    if (offset > data_size || length > data_size - offset)
+        return nullptr;
+    return mapping->GetData() + data_offset + offset;
+}
+
+std::shared_ptr<RomFSReader> MakeUnencryptedRomFSReader(FileUtil::IOFile&& file,
+                                                        std::size_t file_offset,
+                                                        std::size_t data_size) {
+    auto mapping = std::make_shared<const FileUtil::MappedFile>(file);
+    if (mapping->IsOpen()) {
+        return std::make_shared<MappedRomFSReader>(std::move(mapping), file_offset, data_size);
+    }
+    return std::make_shared<DirectRomFSReader>(std::move(file), file_offset, data_size);
+}
+
 } // namespace FileSys
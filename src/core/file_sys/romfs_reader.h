@@ -1,9 +1,20 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
 
+namespace CryptoPP {
+class SymmetricCipher;
+}
+
 namespace FileSys {
 
 /**
@@ -15,24 +26,37 @@ public:
 
     virtual std::size_t GetSize() const = 0;
     virtual std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) = 0;
+
+    /**
+     * Gets a pointer to length bytes of RomFS data at offset, if the reader keeps them in host
+     * memory. This lets callers copy straight into their destination.
+     * @return Pointer to the data, or nullptr if unavailable or out of range
+     */
+    virtual const u8* GetDirectPointer(std::size_t offset, std::size_t length) const {
+        return nullptr;
+    }
 };
 
 /**
  * A RomFS reader that directly reads the RomFS file.
+ *
+ * Reads go through an LRU cache of decrypted blocks, and sequential access prefetches the
+ * following blocks on a background thread. ReadFile may be called from several threads.
  */
 class DirectRomFSReader : public RomFSReader {
 public:
-    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    static constexpr std::size_t cache_block_size = 0x10000;
+    static constexpr std::size_t cache_block_count = 32;
+    /// Number of blocks past a sequential read which are prefetched
+    static constexpr std::size_t read_ahead_blocks = 2;
+
+    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
 
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                       const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                      std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                      std::size_t crypto_offset);
 
-    ~DirectRomFSReader() override = default;
+    ~DirectRomFSReader() override;
 
     std::size_t GetSize() const override {
         return data_size;
@@ -41,13 +65,70 @@ public:
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override;
 
 private:
+    using Block = std::shared_ptr<const std::vector<u8>>;
+
+    /// Reads and decrypts data straight from the file, bypassing the cache.
+    std::size_t ReadUncached(std::size_t offset, std::size_t length, u8* buffer);
+
+    Block LookupBlock(std::size_t index);
+    Block GetBlock(std::size_t index);
+    void QueueReadAhead(std::size_t first_index);
+    void ReadAheadThread();
+
     bool is_encrypted;
-    FileUtil::IOFile file;
-    std::array<u8, 16> key;
-    std::array<u8, 16> ctr;
     u64 file_offset;
     u64 crypto_offset;
     u64 data_size;
+
+    /// Only accessed through positional reads, which are thread-safe
+    FileUtil::IOFile file;
+    /// AES-CTR decryptor reused across reads; only the keystream position changes
+    std::unique_ptr<CryptoPP::SymmetricCipher> decryptor;
+    std::mutex decryptor_mutex;
+    /// Serialises block loads so that a block requested by both threads is only read once
+    std::mutex load_mutex;
+
+    std::mutex cache_mutex;
+    /// Cached block indices, most recently used first
+    std::list<std::size_t> lru;
+    std::unordered_map<std::size_t, std::pair<Block, std::list<std::size_t>::iterator>> cache;
+    /// End offset of the previous read, used to detect sequential access
+    std::size_t last_read_end = 0;
+
+    std::condition_variable read_ahead_cv;
+    std::vector<std::size_t> read_ahead_queue;
+    bool stop_read_ahead = false;
+    std::thread read_ahead_thread;
+};
+
+/**
+ * A RomFS reader backed by a memory mapping of an unencrypted image, so that reads are a single
+ * copy out of the page cache.
+ */
+class MappedRomFSReader : public RomFSReader {
+public:
+    MappedRomFSReader(std::shared_ptr<const FileUtil::MappedFile> mapping, std::size_t data_offset,
+                      std::size_t data_size);
+
+    std::size_t GetSize() const override {
+        return data_size;
+    }
+
+    std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override;
+    const u8* GetDirectPointer(std::size_t offset, std::size_t length) const override;
+
+private:
+    std::shared_ptr<const FileUtil::MappedFile> mapping;
+    std::size_t data_offset;
+    std::size_t data_size;
 };
 
+/**
+ * Creates a reader for an unencrypted RomFS at file_offset in file, memory-mapping the file when
+ * possible and falling back to DirectRomFSReader otherwise.
+ */
+std::shared_ptr<RomFSReader> MakeUnencryptedRomFSReader(FileUtil::IOFile&& file,
+                                                        std::size_t file_offset,
+                                                        std::size_t data_size);
+
 } // namespace FileSys
@@ -7,33 +7,19 @@
 #include "core/file_sys/errors.h"
 #include "core/file_sys/path_parser.h"
 #include "core/file_sys/savedata_archive.h"
+#include "core/file_sys/write_back_cache.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // FileSys namespace
 
 namespace FileSys {
 
-class SaveDataDelayGenerator : public DelayGenerator {
-public:
-    u64 GetReadDelayNs(std::size_t length) override {
-        // The delay was measured on O3DS and O2DS with
-        // https://gist.github.com/B3n30/ac40eac20603f519ff106107f4ac9182
-        // from the results the average of each length was taken.
-        static constexpr u64 slope(183);
-        static constexpr u64 offset(524879);
-        static constexpr u64 minimum(631826);
-        u64 IPCDelayNanoseconds = std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-        return IPCDelayNanoseconds;
-    }
-
-    u64 GetOpenDelayNs() override {
-        // This is the delay measured on O3DS and O2DS with
-        // https://gist.github.com/FearlessTobi/c37e143c314789251f98f2c45cd706d2
-        // from the results the average of each length was taken.
-        static constexpr u64 IPCDelayNanoseconds(269082);
-        return IPCDelayNanoseconds;
-    }
-};
+SaveDataArchive::SaveDataArchive(const std::string& mount_point_,
+                                 const MediaDelayProfile& delay_profile_)
+    : mount_point(mount_point_), delay_profile(delay_profile_) {
+    delay_generator = std::make_unique<MediaDelayGenerator>(delay_profile);
+    WriteBackCache::GetInstance().RecoverJournals(mount_point);
+}
 
 ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& path,
                                                                   const Mode& mode) const {
@@ -83,13 +69,14 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
         break; // Expected 'success' case
     }
 
-    FileUtil::IOFile file(full_path, mode.write_flag ? "r+b" : "rb");
+    // Save files are written back in batches, see WriteBackCache
+    FileUtil::IOFile file = WriteBackCache::GetInstance().Open(full_path, mode.write_flag != 0);
     if (!file.IsOpen()) {
         LOG_CRITICAL(Service_FS, "(unreachable) Unknown error opening {}", full_path);
         return ERROR_FILE_NOT_FOUND;
     }
 
-    std::unique_ptr<DelayGenerator> delay_generator = std::make_unique<SaveDataDelayGenerator>();
+    auto delay_generator = std::make_unique<MediaDelayGenerator>(delay_profile);
     auto disk_file = std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator));
     return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
 }
@@ -120,6 +107,7 @@ ResultCode SaveDataArchive::DeleteFile(const Path& path) const {
         break; // Expected 'success' case
     }
 
+    WriteBackCache::GetInstance().Release(full_path);
     if (FileUtil::Delete(full_path)) {
         return RESULT_SUCCESS;
     }
@@ -147,6 +135,8 @@ ResultCode SaveDataArchive::RenameFile(const Path& src_path, const Path& dest_pa
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
+    WriteBackCache::GetInstance().Release(src_path_full);
+    WriteBackCache::GetInstance().Release(dest_path_full);
     if (FileUtil::Rename(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
@@ -188,6 +178,7 @@ static ResultCode DeleteDirectoryHelper(const Path& path, const std::string& mou
         break; // Expected 'success' case
     }
 
+    WriteBackCache::GetInstance().Release(full_path);
     if (deleter(full_path)) {
         return RESULT_SUCCESS;
     }
@@ -306,6 +297,8 @@ ResultCode SaveDataArchive::RenameDirectory(const Path& src_path, const Path& de
     const auto src_path_full = path_parser_src.BuildHostPath(mount_point);
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
+    WriteBackCache::GetInstance().Release(src_path_full);
+    WriteBackCache::GetInstance().Release(dest_path_full);
     if (FileUtil::Rename(src_path_full, dest_path_full)) {
         return RESULT_SUCCESS;
     }
@@ -343,6 +336,8 @@ ResultVal<std::unique_ptr<DirectoryBackend>> SaveDataArchive::OpenDirectory(
         break; // Expected 'success' case
     }
 
+    // Listed sizes come from the host files
+    WriteBackCache::GetInstance().Flush(full_path);
     auto directory = std::make_unique<DiskDirectory>(full_path);
     return MakeResult<std::unique_ptr<DirectoryBackend>>(std::move(directory));
 }
@@ -18,7 +18,13 @@ namespace FileSys {
 /// Archive backend for general save data archive type (SaveData and SystemSaveData)
 class SaveDataArchive : public ArchiveBackend {
 public:
-    explicit SaveDataArchive(const std::string& mount_point_) : mount_point(mount_point_) {}
+    /**
+     * Also recovers the save files of the archive from an interrupted write-back
+     * @param mount_point_ Host directory of the archive
+     * @param delay_profile_ Delays of the medium the archive is stored on
+     */
+    explicit SaveDataArchive(const std::string& mount_point_,
+                             const MediaDelayProfile& delay_profile_ = sdmc_delay_profile);
 
     std::string GetName() const override {
         return "SaveDataArchive: " + mount_point;
@@ -38,6 +44,7 @@ public:
 
 protected:
     std::string mount_point;
+    const MediaDelayProfile& delay_profile;
 };
 
 } // namespace FileSys
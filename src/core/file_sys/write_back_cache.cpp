@@ -0,0 +1,548 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <string_view>
+#include <utility>
+#include "common/common_paths.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/file_sys/write_back_cache.h"
+
+namespace FileSys {
+
+namespace {
+/// Buffered writes of a file are written back early past this size, to bound memory use
+constexpr std::size_t max_dirty_size = 0x400000;
+
+constexpr char journal_suffix[] = ".citra_journal";
+constexpr char temp_suffix[] = ".tmp";
+constexpr u32 journal_magic = 0x4C4E524A; // "JRNL"
+
+struct JournalHeader {
+    u32_le magic;
+    u32_le record_count;
+};
+static_assert(sizeof(JournalHeader) == 8, "JournalHeader has incorrect size");
+
+/// Followed by length bytes of data
+struct JournalRecord {
+    u64_le offset;
+    u64_le length;
+};
+static_assert(sizeof(JournalRecord) == 16, "JournalRecord has incorrect size");
+
+std::string GetJournalPath(const std::string& path) {
+    return path + journal_suffix;
+}
+
+bool EndsWith(const std::string& str, std::string_view suffix) {
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool IsAtOrBelow(const std::string& path, const std::string& parent) {
+    if (parent.empty() || path == parent) {
+        return true;
+    }
+    if (parent.back() == DIR_SEP_CHR) {
+        return path.compare(0, parent.size(), parent) == 0;
+    }
+    return path.size() > parent.size() && path[parent.size()] == DIR_SEP_CHR &&
+           path.compare(0, parent.size(), parent) == 0;
+}
+
+/**
+ * Applies a journal to its file.
+ * @return Whether the journal can be removed, i.e. it was applied or its file no longer exists.
+ * Files which are not valid journals are left alone.
+ */
+bool ReplayJournal(const std::string& journal_path, const std::string& path) {
+    std::vector<u8> journal;
+    {
+        FileUtil::IOFile file(journal_path, "rb");
+        if (!file.IsOpen()) {
+            return false;
+        }
+        journal.resize(file.GetSize());
+        if (file.ReadBytes(journal.data(), journal.size()) != journal.size()) {
+            return false;
+        }
+    }
+
+    JournalHeader header;
+    if (journal.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, journal.data(), sizeof(header));
+    if (header.magic != journal_magic) {
+        return false;
+    }
+
+    // Validate every record before touching the file
+    std::vector<std::pair<JournalRecord, std::size_t>> records;
+    std::size_t position = sizeof(header);
+    for (u32 i = 0; i < header.record_count; i++) {
+        JournalRecord record;
+        if (journal.size() - position < sizeof(record)) {
+            return false;
+        }
+        std::memcpy(&record, journal.data() + position, sizeof(record));
+        position += sizeof(record);
+        if (journal.size() - position < record.length) {
+            return false;
+        }
+        records.emplace_back(record, position);
+        position += static_cast<std::size_t>(record.length);
+    }
+
+    if (!FileUtil::Exists(path)) {
+        return true;
+    }
+    FileUtil::IOFile file(path, "r+b");
+    for (const auto& [record, data_position] : records) {
+        const auto length = static_cast<std::size_t>(record.length);
+        if (!file.Seek(record.offset, SEEK_SET) ||
+            file.WriteBytes(journal.data() + data_position, length) != length) {
+            LOG_ERROR(Service_FS, "Failed to replay journal {}", journal_path);
+            return false;
+        }
+    }
+    return file.Flush();
+}
+} // Anonymous namespace
+
+/// State of a host file shared by all of its handles
+class WriteBackCache::SharedFile {
+public:
+    SharedFile(std::string path, FileUtil::IOFile file, bool writable, Counters& counters)
+        : path(std::move(path)), file(std::move(file)), counters(counters), writable(writable) {
+        host_size = size = this->file.GetSize();
+    }
+
+    ~SharedFile() {
+        std::lock_guard lock{mutex};
+        FlushLocked();
+    }
+
+    std::size_t Read(void* data, std::size_t length, u64 offset) {
+        std::lock_guard lock{mutex};
+        if (offset >= size) {
+            return 0;
+        }
+        length = static_cast<std::size_t>(std::min<u64>(length, size - offset));
+        u8* const out = static_cast<u8*>(data);
+
+        // Bytes past the end of the host file can only come from buffered writes, which leave
+        // no gaps up to the logical size except for zero-filled ones.
+        const std::size_t from_host =
+            offset < host_size ? static_cast<std::size_t>(std::min<u64>(length, host_size - offset))
+                               : 0;
+        if (from_host != 0 && file.ReadBytesAt(out, from_host, offset) != from_host) {
+            return 0;
+        }
+        std::memset(out + from_host, 0, length - from_host);
+
+        const u64 end = offset + length;
+        for (auto it = FindFirstTouching(offset); it != dirty.end() && it->first < end; ++it) {
+            const u64 begin = std::max(offset, it->first);
+            const u64 range_end = std::min<u64>(end, it->first + it->second.size());
+            if (begin < range_end) {
+                std::memcpy(out + (begin - offset), it->second.data() + (begin - it->first),
+                            static_cast<std::size_t>(range_end - begin));
+            }
+        }
+        return length;
+    }
+
+    std::size_t Write(const void* data, std::size_t length, u64 offset) {
+        std::lock_guard lock{mutex};
+        ++counters.guest_writes;
+        if (length == 0) {
+            return 0;
+        }
+
+        // Merge the write with every range it overlaps or touches. The first such range's
+        // storage is reused, so that sequential writes append to it.
+        const u64 end = offset + length;
+        auto it = FindFirstTouching(offset);
+        u64 start = offset;
+        std::vector<u8> range;
+        if (it != dirty.end() && it->first <= end) {
+            start = std::min(offset, it->first);
+            range = std::move(it->second);
+            dirty_size -= range.size();
+            if (it->first > offset) {
+                range.insert(range.begin(), static_cast<std::size_t>(it->first - offset), 0);
+            }
+            it = dirty.erase(it);
+        }
+        while (it != dirty.end() && it->first <= end) {
+            const u64 other_end = it->first + it->second.size();
+            range.resize(static_cast<std::size_t>(std::max<u64>(range.size(), other_end - start)));
+            std::memcpy(range.data() + (it->first - start), it->second.data(), it->second.size());
+            dirty_size -= it->second.size();
+            it = dirty.erase(it);
+        }
+        range.resize(static_cast<std::size_t>(std::max<u64>(range.size(), end - start)));
+        std::memcpy(range.data() + (offset - start), data, length);
+        dirty_size += range.size();
+        dirty.emplace_hint(it, start, std::move(range));
+
+        size = std::max(size, end);
+        // Detached files are not reached by FlushAll anymore, so they are written through
+        if (dirty_size > max_dirty_size || detached) {
+            FlushLocked();
+        }
+        return length;
+    }
+
+    u64 GetSize() {
+        std::lock_guard lock{mutex};
+        return size;
+    }
+
+    bool Resize(u64 new_size) {
+        std::lock_guard lock{mutex};
+        if (!FlushLocked()) {
+            return false;
+        }
+        ++counters.host_writes;
+        if (!file.Resize(new_size)) {
+            return false;
+        }
+        host_size = size = new_size;
+        return true;
+    }
+
+    /**
+     * Counts a guest flush request, which writes nothing back unless an earlier write-back
+     * failed. That one is retried, so that the guest learns whether its writes are still pending.
+     */
+    bool RequestFlush() {
+        std::lock_guard lock{mutex};
+        ++counters.guest_flushes;
+        return !write_back_failed || FlushLocked();
+    }
+
+    bool Flush() {
+        std::lock_guard lock{mutex};
+        return FlushLocked();
+    }
+
+    /**
+     * Reopens a file which was only opened for reading so that it can be written back. Nothing
+     * is buffered yet, as its handles could not write.
+     */
+    bool MakeWritable() {
+        std::lock_guard lock{mutex};
+        if (writable) {
+            return true;
+        }
+        FileUtil::IOFile new_file(path, "r+b");
+        if (!new_file.IsOpen()) {
+            return false;
+        }
+        file = std::move(new_file);
+        writable = true;
+        return true;
+    }
+
+    /// Writes back and stops journaling, as the path may no longer lead to this file.
+    void Detach() {
+        std::lock_guard lock{mutex};
+        FlushLocked();
+        detached = true;
+    }
+
+private:
+    /// Returns the first range ending at or after offset.
+    std::map<u64, std::vector<u8>>::iterator FindFirstTouching(u64 offset) {
+        auto it = dirty.upper_bound(offset);
+        if (it != dirty.begin()) {
+            const auto previous = std::prev(it);
+            if (previous->first + previous->second.size() >= offset) {
+                return previous;
+            }
+        }
+        return it;
+    }
+
+    bool FlushLocked() {
+        if (dirty.empty()) {
+            return true;
+        }
+
+        const bool journaled = !detached && WriteJournal();
+        bool success = true;
+        for (const auto& [offset, data] : dirty) {
+            success = success && file.Seek(offset, SEEK_SET) &&
+                      file.WriteBytes(data.data(), data.size()) == data.size();
+        }
+        // The journal must only go away once the file contents are on the storage device
+        success = (journaled ? file.Sync() : file.Flush()) && success;
+        counters.host_writes += dirty.size();
+        ++counters.host_flushes;
+
+        if (!success) {
+            // Keep the buffered writes so that the next write-back retries them, and the
+            // journal, if any, so that the next mount can replay them
+            LOG_ERROR(Service_FS, "Failed to write back {}", path);
+            write_back_failed = true;
+            return false;
+        }
+        if (journaled) {
+            FileUtil::Delete(GetJournalPath(path));
+        }
+        host_size = std::max(host_size, size);
+        dirty.clear();
+        dirty_size = 0;
+        write_back_failed = false;
+        return true;
+    }
+
+    /// Writes the buffered ranges to the journal in one go, syncing it and committing it with a
+    /// rename.
+    bool WriteJournal() {
+        std::vector<u8> journal(sizeof(JournalHeader));
+        const JournalHeader header{journal_magic, static_cast<u32>(dirty.size())};
+        std::memcpy(journal.data(), &header, sizeof(header));
+        for (const auto& [offset, data] : dirty) {
+            const JournalRecord record{offset, data.size()};
+            const auto* record_bytes = reinterpret_cast<const u8*>(&record);
+            journal.insert(journal.end(), record_bytes, record_bytes + sizeof(record));
+            journal.insert(journal.end(), data.begin(), data.end());
+        }
+
+        const std::string journal_path = GetJournalPath(path);
+        const std::string temp_path = journal_path + temp_suffix;
+        bool success;
+        {
+            FileUtil::IOFile temp(temp_path, "wb");
+            success = temp.WriteBytes(journal.data(), journal.size()) == journal.size() &&
+                      temp.Sync();
+        }
+        ++counters.host_writes;
+        ++counters.host_flushes;
+        if (!success || !FileUtil::Rename(temp_path, journal_path)) {
+            LOG_WARNING(Service_FS, "Failed to journal {}, writing back without one", path);
+            FileUtil::Delete(temp_path);
+            return false;
+        }
+        return true;
+    }
+
+    std::string path;
+    FileUtil::IOFile file;
+    Counters& counters;
+
+    std::mutex mutex;
+    /// Buffered writes keyed by offset. Ranges never overlap or touch each other.
+    std::map<u64, std::vector<u8>> dirty;
+    std::size_t dirty_size = 0;
+    /// Size including the buffered writes
+    u64 size = 0;
+    u64 host_size = 0;
+    /// Whether the host file was opened for writing
+    bool writable;
+    bool detached = false;
+    /// Whether the last write-back failed, leaving the buffered writes in place
+    bool write_back_failed = false;
+};
+
+/// Handle given to a single guest file, with its own position
+class WriteBackCache::Handle : public FileUtil::IOHandler {
+public:
+    explicit Handle(std::shared_ptr<SharedFile> file) : file(std::move(file)) {}
+
+    ~Handle() override {
+        file->Flush();
+    }
+
+    std::size_t Read(void* buf, std::size_t size, std::size_t count) override {
+        if (size == 0) {
+            return 0;
+        }
+        const std::size_t read = file->Read(buf, size * count, position);
+        position += read;
+        return read / size;
+    }
+
+    std::size_t Write(const void* buf, std::size_t size, std::size_t count) override {
+        if (size == 0) {
+            return 0;
+        }
+        const std::size_t written = file->Write(buf, size * count, position);
+        position += written;
+        return written / size;
+    }
+
+    std::size_t ReadAt(void* buf, std::size_t size, u64 offset) override {
+        return file->Read(buf, size, offset);
+    }
+
+    bool Seek(s64 offset, int whence) override {
+        s64 base = 0;
+        if (whence == SEEK_CUR) {
+            base = static_cast<s64>(position);
+        } else if (whence == SEEK_END) {
+            base = static_cast<s64>(file->GetSize());
+        }
+        if (base + offset < 0) {
+            return false;
+        }
+        position = static_cast<u64>(base + offset);
+        return true;
+    }
+
+    u64 Tell() override {
+        return position;
+    }
+
+    u64 GetSize() override {
+        return file->GetSize();
+    }
+
+    bool Resize(u64 size) override {
+        return file->Resize(size);
+    }
+
+    bool Flush() override {
+        return file->RequestFlush();
+    }
+
+    int GetDescriptor() override {
+        return -1;
+    }
+
+    bool Close() override {
+        return file->Flush();
+    }
+
+private:
+    std::shared_ptr<SharedFile> file;
+    u64 position = 0;
+};
+
+WriteBackCache::WriteBackCache() = default;
+
+WriteBackCache::~WriteBackCache() = default;
+
+WriteBackCache& WriteBackCache::GetInstance() {
+    static WriteBackCache instance;
+    return instance;
+}
+
+FileUtil::IOFile WriteBackCache::Open(const std::string& path, bool writable) {
+    std::lock_guard lock{mutex};
+    std::shared_ptr<SharedFile> shared;
+    if (const auto it = files.find(path); it != files.end()) {
+        shared = it->second.lock();
+    }
+
+    if (shared) {
+        if (writable && !shared->MakeWritable()) {
+            return {};
+        }
+    } else {
+        FileUtil::IOFile file(path, writable ? "r+b" : "rb");
+        if (!file.IsOpen()) {
+            return {};
+        }
+        shared = std::make_shared<SharedFile>(path, std::move(file), writable, counters);
+
+        // Forget files whose handles were all closed
+        for (auto it = files.begin(); it != files.end();) {
+            it = it->second.expired() ? files.erase(it) : std::next(it);
+        }
+        files.insert_or_assign(path, shared);
+    }
+    return FileUtil::IOFile(std::make_unique<Handle>(std::move(shared)));
+}
+
+bool WriteBackCache::FlushAll() {
+    return Flush({});
+}
+
+bool WriteBackCache::Flush(const std::string& path) {
+    bool success = true;
+    for (const auto& file : GetFiles(path)) {
+        success = file->Flush() && success;
+    }
+    return success;
+}
+
+void WriteBackCache::Release(const std::string& path) {
+    const auto released = GetFiles(path);
+    for (const auto& file : released) {
+        file->Detach();
+    }
+
+    std::lock_guard lock{mutex};
+    for (auto it = files.begin(); it != files.end();) {
+        it = IsAtOrBelow(it->first, path) ? files.erase(it) : std::next(it);
+    }
+}
+
+void WriteBackCache::RecoverJournals(const std::string& directory) {
+    const auto callback = [this](u64* num_entries_out, const std::string& parent,
+                                 const std::string& virtual_name) -> bool {
+        const std::string entry_path = parent + DIR_SEP + virtual_name;
+        if (FileUtil::IsDirectory(entry_path)) {
+            RecoverJournals(entry_path);
+            return true;
+        }
+
+        if (EndsWith(entry_path, std::string(journal_suffix) + temp_suffix)) {
+            // Never committed, so the file was not touched yet
+            FileUtil::Delete(entry_path);
+        } else if (EndsWith(entry_path, journal_suffix)) {
+            const std::string path =
+                entry_path.substr(0, entry_path.size() - std::strlen(journal_suffix));
+            {
+                // Files which are open are written back by their handles
+                std::lock_guard lock{mutex};
+                if (const auto it = files.find(path); it != files.end() && !it->second.expired()) {
+                    return true;
+                }
+            }
+            if (ReplayJournal(entry_path, path)) {
+                LOG_INFO(Service_FS, "Recovered interrupted write-back of {}", path);
+                FileUtil::Delete(entry_path);
+            }
+        }
+        return true;
+    };
+    FileUtil::ForeachDirectoryEntry(nullptr, directory, callback);
+}
+
+WriteBackStats WriteBackCache::GetStats() const {
+    WriteBackStats stats;
+    stats.guest_writes = counters.guest_writes;
+    stats.guest_flushes = counters.guest_flushes;
+    stats.host_writes = counters.host_writes;
+    stats.host_flushes = counters.host_flushes;
+    return stats;
+}
+
+std::vector<std::shared_ptr<WriteBackCache::SharedFile>> WriteBackCache::GetFiles(
+    const std::string& path) {
+    std::vector<std::shared_ptr<SharedFile>> result;
+    std::lock_guard lock{mutex};
+    for (const auto& [file_path, file] : files) {
+        if (IsAtOrBelow(file_path, path)) {
+            if (auto shared = file.lock()) {
+                result.push_back(std::move(shared));
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace FileSys
@@ -0,0 +1,93 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+namespace FileSys {
+
+/// Guest file operations received by the write-back cache, and the host I/O they turned into
+struct WriteBackStats {
+    u64 guest_writes = 0;
+    u64 guest_flushes = 0;
+    u64 host_writes = 0;
+    u64 host_flushes = 0;
+};
+
+/**
+ * Write-back cache for the host files of save data and extra save data archives. Games often
+ * write their saves in many small chunks and flush after each of them, which is slow on SD cards.
+ * Instead, writes are kept in memory, coalesced into contiguous ranges, and written back when a
+ * file is closed, when its archive is committed, or periodically through FlushAll. Guest flush
+ * requests are only counted. A failed write-back keeps the writes buffered and is retried by the
+ * next one, and closing the file, committing the archive or flushing the file reports it.
+ *
+ * The ranges are first written to a journal next to the file, which is synced to the storage
+ * device, committed with an atomic rename, and removed once the updated file is synced as well.
+ * If the emulator stops halfway through, the journal is replayed by RecoverJournals when the
+ * archive is opened again.
+ */
+class WriteBackCache {
+public:
+    static WriteBackCache& GetInstance();
+
+    /**
+     * Opens an existing host file through the cache. All handles of a path share the buffered
+     * writes. The handles cannot be memory-mapped, as the host file may be out of date.
+     * @param writable Whether the handle will write. Otherwise the host file is opened read-only,
+     * so that read-only host files can still be read, until a writable handle is opened.
+     * @return The handle, which is not open if the host file could not be opened
+     */
+    FileUtil::IOFile Open(const std::string& path, bool writable);
+
+    /// Writes back the buffered writes of every open file. Returns false if any write failed.
+    bool FlushAll();
+
+    /// Writes back the buffered writes of the files at or below path. Returns false if any write
+    /// failed, in which case the writes stay buffered to be retried.
+    bool Flush(const std::string& path);
+
+    /**
+     * Writes back the files at or below path and stops sharing them, before the host files are
+     * deleted, renamed or formatted. Handles which are still open then write to the host file
+     * they opened directly.
+     */
+    void Release(const std::string& path);
+
+    /// Replays and removes the journals left below directory by an interrupted write-back.
+    void RecoverJournals(const std::string& directory);
+
+    WriteBackStats GetStats() const;
+
+private:
+    class SharedFile;
+    class Handle;
+
+    struct Counters {
+        std::atomic<u64> guest_writes{0};
+        std::atomic<u64> guest_flushes{0};
+        std::atomic<u64> host_writes{0};
+        std::atomic<u64> host_flushes{0};
+    };
+
+    WriteBackCache();
+    ~WriteBackCache();
+
+    /// Returns the open files at or below path, or all of them if path is empty.
+    std::vector<std::shared_ptr<SharedFile>> GetFiles(const std::string& path);
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<SharedFile>> files;
+    Counters counters;
+};
+
+} // namespace FileSys
@@ -0,0 +1,292 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <utility>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/thread_pool.h"
+#include "core/cache_file.h"
+#include "core/game_library.h"
+#include "core/hle/service/am/am.h"
+#include "core/hle/service/fs/archive.h"
+#include "core/loader/smdh.h"
+
+namespace Core {
+
+namespace {
+/// Bump whenever the index layout or the way entries are read changes
+constexpr u32 game_library_index_version = 1;
+
+void DoEntry(CacheFile& file, GameEntry& entry) {
+    file.Do(entry.path);
+    file.Do(entry.size);
+    file.Do(entry.mtime);
+    file.Do(entry.update_mtime);
+    file.Do(entry.file_type);
+    file.Do(entry.executable);
+    file.Do(entry.encrypted);
+    file.Do(entry.program_id);
+    file.Do(entry.extdata_id);
+    file.Do(entry.title);
+    file.Do(entry.smdh);
+}
+
+u64 GetUpdateTitleId(u64 program_id) {
+    return program_id | 0x0000000E00000000;
+}
+
+/// Returns the modification time of the content directory of the update installed for
+/// program_id, or 0 if there is none. Installing or removing an update touches the directory.
+u64 GetUpdateMtime(u64 program_id) {
+    if (program_id & ~0x00040000FFFFFFFF) {
+        return 0;
+    }
+    const std::string content_path =
+        Service::AM::GetTitlePath(Service::FS::MediaType::SDMC, GetUpdateTitleId(program_id)) +
+        "content" DIR_SEP;
+    if (!FileUtil::IsDirectory(content_path)) {
+        return 0;
+    }
+    return FileUtil::GetFileModificationTimestamp(content_path);
+}
+} // Anonymous namespace
+
+GameLibrary::GameLibrary(std::string index_path) : index_path(std::move(index_path)) {}
+
+GameLibrary::~GameLibrary() = default;
+
+std::string GameLibrary::GetDefaultIndexPath() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "game_list" DIR_SEP "index.cache";
+}
+
+bool GameLibrary::Load() {
+    if (!FileUtil::Exists(index_path)) {
+        return false;
+    }
+
+    CacheFile file(index_path, CacheFile::MODE_LOAD);
+    u32 version = 0;
+    file.DoHeader(version);
+    if (!file.IsGood() || version != game_library_index_version) {
+        LOG_INFO(Loader, "Game list index {} is outdated, rebuilding", index_path);
+        return false;
+    }
+
+    std::unordered_map<std::string, IndexedEntry> loaded;
+    u32 count = 0;
+    file.Do(count);
+    for (u32 i = 0; i < count && file.IsGood(); i++) {
+        GameEntry entry;
+        DoEntry(file, entry);
+        std::string path = entry.path;
+        loaded.emplace(std::move(path), IndexedEntry{std::move(entry)});
+    }
+    if (!file.IsGood() || loaded.size() != count) {
+        LOG_ERROR(Loader, "Game list index {} is corrupt, rebuilding", index_path);
+        return false;
+    }
+
+    std::lock_guard lock{mutex};
+    entries = std::move(loaded);
+    dirty = false;
+    return true;
+}
+
+bool GameLibrary::Save() {
+    std::lock_guard lock{mutex};
+    if (!dirty) {
+        return true;
+    }
+    if (!FileUtil::CreateFullPath(index_path)) {
+        LOG_ERROR(Loader, "Could not create path {}", index_path);
+        return false;
+    }
+
+    CacheFile file(index_path, CacheFile::MODE_SAVE);
+    u32 version = game_library_index_version;
+    file.DoHeader(version);
+    auto count = static_cast<u32>(entries.size());
+    file.Do(count);
+    for (auto& [path, indexed] : entries) {
+        DoEntry(file, indexed.entry);
+    }
+
+    if (!file.IsGood()) {
+        LOG_ERROR(Loader, "Failed to write game list index {}", index_path);
+        return false;
+    }
+    dirty = false;
+    return true;
+}
+
+void GameLibrary::Prune() {
+    std::lock_guard lock{mutex};
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (!it->second.used) {
+            it = entries.erase(it);
+            dirty = true;
+        } else {
+            it->second.used = false;
+            ++it;
+        }
+    }
+}
+
+GameEntry GameLibrary::GetEntry(const std::string& path, u64 size, u64 mtime) {
+    if (auto entry = FindEntry(path, size, mtime)) {
+        return std::move(*entry);
+    }
+    GameEntry entry = ReadEntry(path, size, mtime);
+    StoreEntry(entry);
+    return entry;
+}
+
+GameEntry GameLibrary::GetEntry(const std::string& path) {
+    return GetEntry(path, FileUtil::GetSize(path), FileUtil::GetFileModificationTimestamp(path));
+}
+
+std::vector<GameEntry> GameLibrary::Scan(const std::string& directory, unsigned int recursion,
+                                         const std::function<bool(const std::string&)>& filter,
+                                         std::vector<std::string>* subdirectories,
+                                         const std::atomic_bool* cancel) {
+    const auto is_cancelled = [cancel] { return cancel != nullptr && *cancel; };
+
+    // Walking the tree only stats files, so it stays on this thread. Files without an up to date
+    // entry get a placeholder which is filled in below.
+    std::vector<GameEntry> found;
+    std::vector<std::size_t> stale;
+    std::function<void(const std::string&, unsigned int)> walk =
+        [&](const std::string& dir_path, unsigned int levels) {
+            const auto callback = [&, levels](u64* num_entries_out, const std::string& parent,
+                                              const std::string& virtual_name) -> bool {
+                if (is_cancelled()) {
+                    return false;
+                }
+
+                const std::string path = parent + DIR_SEP + virtual_name;
+                if (FileUtil::IsDirectory(path)) {
+                    if (levels > 0) {
+                        if (subdirectories) {
+                            subdirectories->push_back(path);
+                        }
+                        walk(path, levels - 1);
+                    }
+                    return true;
+                }
+                if (filter && !filter(path)) {
+                    return true;
+                }
+
+                const u64 size = FileUtil::GetSize(path);
+                const u64 mtime = FileUtil::GetFileModificationTimestamp(path);
+                if (auto entry = FindEntry(path, size, mtime)) {
+                    found.push_back(std::move(*entry));
+                } else {
+                    stale.push_back(found.size());
+                    GameEntry& placeholder = found.emplace_back();
+                    placeholder.path = path;
+                    placeholder.size = size;
+                    placeholder.mtime = mtime;
+                }
+                return true;
+            };
+            FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
+        };
+    walk(directory, recursion);
+
+    if (!stale.empty() && !is_cancelled()) {
+        LOG_INFO(Loader, "Indexing {} new or changed files in {}", stale.size(), directory);
+
+        // Reading a file is dominated by I/O and decryption of its headers, and files vary a lot
+        // in cost, so workers pull one file at a time instead of taking fixed ranges.
+        const std::size_t num_threads =
+            std::min<std::size_t>(stale.size(), std::max(1u, std::thread::hardware_concurrency()));
+        Common::ThreadPool pool(num_threads, "GameLibrary");
+        std::atomic<std::size_t> next{0};
+        for (std::size_t i = 0; i < num_threads; i++) {
+            pool.Push([&] {
+                for (std::size_t index; (index = next++) < stale.size();) {
+                    if (is_cancelled()) {
+                        return;
+                    }
+                    GameEntry& entry = found[stale[index]];
+                    entry = ReadEntry(entry.path, entry.size, entry.mtime);
+                    StoreEntry(entry);
+                }
+            });
+        }
+        pool.WaitForIdle();
+    }
+
+    if (is_cancelled()) {
+        return {};
+    }
+    return found;
+}
+
+std::optional<GameEntry> GameLibrary::FindEntry(const std::string& path, u64 size, u64 mtime) {
+    std::optional<GameEntry> entry;
+    {
+        std::lock_guard lock{mutex};
+        const auto it = entries.find(path);
+        if (it == entries.end() || it->second.entry.size != size ||
+            it->second.entry.mtime != mtime) {
+            return std::nullopt;
+        }
+        it->second.used = true;
+        entry = it->second.entry;
+    }
+
+    // The update is a separate title, so its icon can change while the file itself does not.
+    if (GetUpdateMtime(entry->program_id) != entry->update_mtime) {
+        return std::nullopt;
+    }
+    return entry;
+}
+
+void GameLibrary::StoreEntry(const GameEntry& entry) {
+    std::lock_guard lock{mutex};
+    entries.insert_or_assign(entry.path, IndexedEntry{entry, true});
+    dirty = true;
+}
+
+GameEntry GameLibrary::ReadEntry(const std::string& path, u64 size, u64 mtime) {
+    GameEntry entry;
+    entry.path = path;
+    entry.size = size;
+    entry.mtime = mtime;
+
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(path);
+    if (!loader) {
+        return entry;
+    }
+
+    entry.file_type = loader->GetFileType();
+    entry.encrypted =
+        loader->IsExecutable(entry.executable) == Loader::ResultStatus::ErrorEncrypted;
+    loader->ReadProgramId(entry.program_id);
+    loader->ReadExtdataId(entry.extdata_id);
+    loader->ReadTitle(entry.title);
+
+    // Prefer the icon of an installed update
+    entry.update_mtime = GetUpdateMtime(entry.program_id);
+    if (entry.update_mtime != 0) {
+        const std::string update_path = Service::AM::GetTitleContentPath(
+            Service::FS::MediaType::SDMC, GetUpdateTitleId(entry.program_id));
+        if (std::unique_ptr<Loader::AppLoader> update_loader = Loader::GetLoader(update_path)) {
+            update_loader->ReadIcon(entry.smdh);
+        }
+    }
+    if (!Loader::IsValidSMDH(entry.smdh)) {
+        entry.smdh.clear();
+        loader->ReadIcon(entry.smdh);
+    }
+    return entry;
+}
+
+} // namespace Core
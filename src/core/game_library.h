@@ -0,0 +1,113 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "core/loader/loader.h"
+
+namespace Core {
+
+/// Metadata of a game file, as shown by the frontends' game lists
+struct GameEntry {
+    std::string path;
+    u64 size = 0;
+    u64 mtime = 0;
+    /// Modification time of the installed update's content directory, 0 if there is none
+    u64 update_mtime = 0;
+
+    /// Error if no loader could open the file
+    Loader::FileType file_type = Loader::FileType::Error;
+    bool executable = false;
+    bool encrypted = false;
+    u64 program_id = 0;
+    u64 extdata_id = 0;
+    std::string title;
+    /// SMDH of the installed update if it has a valid one, otherwise the file's own. Not
+    /// necessarily valid.
+    std::vector<u8> smdh;
+
+    /// Whether the file is an application, or may be one if it is encrypted
+    bool IsListable() const {
+        return file_type != Loader::FileType::Error && (executable || encrypted);
+    }
+};
+
+/**
+ * Index of game metadata shared by the frontends. Reading the metadata of a file means opening
+ * (and possibly decrypting) it, so entries are persisted in an on-disk index keyed by path, size
+ * and modification time, and only new or changed files are read again. All methods are
+ * thread-safe.
+ */
+class GameLibrary {
+public:
+    explicit GameLibrary(std::string index_path = GetDefaultIndexPath());
+    ~GameLibrary();
+
+    static std::string GetDefaultIndexPath();
+
+    /// Replaces the entries with those of the on-disk index. Returns false, leaving the entries
+    /// unchanged, if there is no valid index.
+    bool Load();
+
+    /// Writes the entries to the on-disk index if they changed since the last Load or Save.
+    bool Save();
+
+    /// Drops the entries which were not looked up since the last Load or Prune, i.e. those of
+    /// files that were removed or are no longer in a game directory.
+    void Prune();
+
+    /**
+     * Returns the entry of a file, reading its metadata unless it is indexed with the given size
+     * and modification time. Lets frontends supply them when the file cannot be stat'ed directly.
+     */
+    GameEntry GetEntry(const std::string& path, u64 size, u64 mtime);
+
+    /// Returns the entry of a file, stat'ing it to check whether the indexed one is up to date.
+    GameEntry GetEntry(const std::string& path);
+
+    /**
+     * Returns the entries of the files in a directory. Files which are not indexed or changed
+     * are read in parallel.
+     * @param directory Directory to scan
+     * @param recursion Number of subdirectory levels to descend into
+     * @param filter Selects the files to index by path, e.g. by extension. All files if empty.
+     * @param subdirectories If not null, receives the subdirectories which were descended into
+     * @param cancel If not null, the scan stops early and returns nothing once it is set
+     * @return Entries in directory order
+     */
+    std::vector<GameEntry> Scan(const std::string& directory, unsigned int recursion,
+                                const std::function<bool(const std::string&)>& filter = {},
+                                std::vector<std::string>* subdirectories = nullptr,
+                                const std::atomic_bool* cancel = nullptr);
+
+private:
+    struct IndexedEntry {
+        GameEntry entry;
+        /// Whether the entry was looked up since the last Load or Prune
+        bool used = false;
+    };
+
+    /// Returns the indexed entry of path if it is up to date, marking it as used.
+    std::optional<GameEntry> FindEntry(const std::string& path, u64 size, u64 mtime);
+
+    void StoreEntry(const GameEntry& entry);
+
+    static GameEntry ReadEntry(const std::string& path, u64 size, u64 mtime);
+
+    std::string index_path;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, IndexedEntry> entries;
+    bool dirty = false;
+};
+
+} // namespace Core
@@ -7,12 +7,15 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <future>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <boost/container/small_vector.hpp>
 #include "common/common_types.h"
 #include "common/swap.h"
+#include "common/thread_pool.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_session.h"
@@ -196,6 +199,30 @@ public:
                                              std::chrono::nanoseconds timeout,
                                              std::shared_ptr<WakeupCallback> callback);
 
+    /**
+     * Runs the host part of a request, such as file I/O, on a pool thread while the guest thread
+     * sleeps for the emulated duration of the request, so that the host work overlaps guest time
+     * instead of stalling the emulation. The work must not access guest memory or kernel objects.
+     * @param pool Pool to run the work on. Tasks run in the order they were pushed if it has a
+     * single thread.
+     * @param reason Reason for pausing the thread, to be used for debugging purposes.
+     * @param delay Emulated duration of the request
+     * @param work Function performing the host part of the request and returning its result
+     * @param reply Function called as reply(context, result) when the thread is resumed. Like
+     * the callback of SleepClientThread, it must write the entire command response.
+     */
+    template <typename Work, typename Reply>
+    void RunAsync(Common::ThreadPool& pool, const std::string& reason,
+                  std::chrono::nanoseconds delay, Work work, Reply reply) {
+        using Result = std::invoke_result_t<Work>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(work));
+        // A thread put to sleep without a timeout would only wake up on its event
+        SleepClientThread(reason, std::max(delay, std::chrono::nanoseconds(1)),
+                          std::make_shared<AsyncCallback<Result, Reply>>(task->get_future(),
+                                                                         std::move(reply)));
+        pool.Push([task] { (*task)(); });
+    }
+
     /**
      * Resolves a object id from the request command buffer into a pointer to an object. See the
      * "HLE handle protocol" section in the class documentation for more details.
@@ -245,6 +272,23 @@ public:
     friend class ThreadCallback;
 
 private:
+    template <typename Result, typename Reply>
+    class AsyncCallback : public WakeupCallback {
+    public:
+        AsyncCallback(std::future<Result> result, Reply reply)
+            : result(std::move(result)), reply(std::move(reply)) {}
+
+        void WakeUp(std::shared_ptr<Thread> thread, HLERequestContext& context,
+                    ThreadWakeupReason reason) override {
+            // This only blocks if the host is slower than the emulated duration of the request
+            reply(context, result.get());
+        }
+
+    private:
+        std::future<Result> result;
+        Reply reply;
+    };
+
     KernelSystem& kernel;
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
     std::shared_ptr<ServerSession> session;
@@ -4,15 +4,23 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstddef>
 #include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
 #include <fmt/format.h>
+#include "common/alignment.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/thread_pool.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/ncch_container.h"
@@ -77,13 +85,188 @@ struct TicketInfo {
 
 static_assert(sizeof(TicketInfo) == 0x18, "Ticket info structure size is wrong");
 
-class CIAFile::DecryptionState {
+/**
+ * Installs content data off the thread writing the CIA. CBC decryption of a chunk only needs the
+ * ciphertext block preceding it, so chunks are decrypted in parallel on a thread pool and then
+ * hashed and written out in order. Separate contents progress independently of each other.
+ */
+class CIAFile::InstallPipeline {
 public:
-    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+    /// Data which may be queued but not yet written out before Push blocks the caller
+    static constexpr std::size_t max_pending_size = 0x2000000;
+
+    InstallPipeline(std::optional<std::array<u8, 16>> title_key, std::size_t content_count)
+        : title_key(title_key), contents(content_count),
+          pool(std::clamp(std::thread::hardware_concurrency(), 1u, 4u), "CIA Install") {}
+
+    ~InstallPipeline() {
+        pool.WaitForIdle();
+    }
+
+    /// Creates the output file of a content. Must be called before its first Push.
+    bool Open(std::size_t index, const std::string& path, u64 size, bool encrypted,
+              const std::array<u8, 16>& ctr, const std::array<u8, 0x20>& hash) {
+        if (encrypted && !title_key) {
+            LOG_ERROR(Service_AM, "Content {} is encrypted but the title key is unavailable",
+                      index);
+            return false;
+        }
+
+        Content& content = contents[index];
+        if (!content.file.Open(path, "wb")) {
+            return false;
+        }
+        content.size = size;
+        content.encrypted = encrypted;
+        content.iv = ctr;
+        content.expected_hash = hash;
+        return true;
+    }
+
+    /// Queues the next part of a content, blocking while too much data is already in flight.
+    void Push(std::size_t index, const u8* data, std::size_t size) {
+        Content& content = contents[index];
+        auto chunk = std::make_shared<Chunk>();
+        std::array<u8, 16> iv = content.iv;
+        if (content.encrypted) {
+            // Hold back a trailing partial cipher block until the rest of it arrives
+            chunk->data = std::move(content.carry);
+            chunk->data.insert(chunk->data.end(), data, data + size);
+            const bool last = content.queued + chunk->data.size() >= content.size;
+            const std::size_t usable =
+                last ? chunk->data.size()
+                     : Common::AlignDown(chunk->data.size(), CryptoPP::AES::BLOCKSIZE);
+            content.carry.assign(chunk->data.begin() + usable, chunk->data.end());
+            chunk->data.resize(usable);
+            if (usable >= CryptoPP::AES::BLOCKSIZE) {
+                std::memcpy(content.iv.data(), chunk->data.data() + usable - content.iv.size(),
+                            content.iv.size());
+            }
+        } else {
+            chunk->data.assign(data, data + size);
+        }
+        if (chunk->data.empty()) {
+            return;
+        }
+        content.queued += chunk->data.size();
+
+        {
+            std::unique_lock lock{mutex};
+            space_cv.wait(lock, [this, &chunk] {
+                return pending_size == 0 || pending_size + chunk->data.size() <= max_pending_size;
+            });
+            pending_size += chunk->data.size();
+            content.chunks.push_back(chunk);
+        }
+
+        pool.Push([this, index, chunk, iv] {
+            if (contents[index].encrypted) {
+                CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption aes(title_key->data(),
+                                                                  title_key->size(), iv.data());
+                aes.ProcessData(chunk->data.data(), chunk->data.data(), chunk->data.size());
+            }
+            std::unique_lock lock{mutex};
+            chunk->ready = true;
+            WriteOut(index, lock);
+        });
+    }
+
+    /// Blocks until all queued data has been written out
+    void WaitForIdle() {
+        pool.WaitForIdle();
+    }
+
+    u64 GetPendingSize() {
+        std::lock_guard lock{mutex};
+        return pending_size;
+    }
+
+    bool HasFailed() {
+        std::lock_guard lock{mutex};
+        return failed;
+    }
+
+    /// Whether a content has been written out in full and matched its TMD hash
+    bool IsVerified(std::size_t index) {
+        std::lock_guard lock{mutex};
+        return contents[index].verified;
+    }
+
+private:
+    struct Chunk {
+        std::vector<u8> data;
+        bool ready = false;
+    };
+
+    struct Content {
+        // Only accessed by the thread feeding the pipeline
+        u64 size = 0;
+        u64 queued = 0;
+        bool encrypted = false;
+        std::array<u8, 16> iv{}; // Last ciphertext block queued so far
+        std::vector<u8> carry;   // Partial cipher block not queued yet
+        std::array<u8, 0x20> expected_hash{};
+
+        // Only accessed by the thread currently writing this content out
+        FileUtil::IOFile file;
+        CryptoPP::SHA256 hash;
+        u64 written = 0;
+
+        // Guarded by the pipeline mutex
+        std::deque<std::shared_ptr<Chunk>> chunks;
+        bool writing = false;
+        bool verified = false;
+    };
+
+    /// Hashes and writes out the decrypted chunks at the front of a content's queue, unless
+    /// another thread is already doing so and will pick them up.
+    void WriteOut(std::size_t index, std::unique_lock<std::mutex>& lock) {
+        Content& content = contents[index];
+        if (content.writing) {
+            return;
+        }
+        content.writing = true;
+        while (!content.chunks.empty() && content.chunks.front()->ready) {
+            const auto chunk = std::move(content.chunks.front());
+            content.chunks.pop_front();
+            lock.unlock();
+
+            const std::size_t size = chunk->data.size();
+            content.hash.Update(chunk->data.data(), size);
+            const bool success = content.file.WriteBytes(chunk->data.data(), size) == size;
+            content.written += size;
+            bool verified = false;
+            if (content.written == content.size) {
+                std::array<u8, CryptoPP::SHA256::DIGESTSIZE> digest;
+                content.hash.Final(digest.data());
+                content.file.Close();
+                verified = digest == content.expected_hash;
+            }
+
+            lock.lock();
+            if (!success) {
+                LOG_ERROR(Service_AM, "Failed to write content {}", index);
+                failed = true;
+            }
+            content.verified = verified;
+            pending_size -= size;
+            space_cv.notify_all();
+        }
+        content.writing = false;
+    }
+
+    std::optional<std::array<u8, 16>> title_key;
+    std::vector<Content> contents;
+
+    std::mutex mutex;
+    std::condition_variable space_cv;
+    u64 pending_size = 0;
+    bool failed = false;
+
+    Common::ThreadPool pool;
 };
 
-CIAFile::CIAFile(Service::FS::MediaType media_type)
-    : media_type(media_type), decryption_state(std::make_unique<DecryptionState>()) {}
+CIAFile::CIAFile(Service::FS::MediaType media_type) : media_type(media_type) {}
 
 CIAFile::~CIAFile() {
     Close();
@@ -133,14 +316,8 @@ ResultCode CIAFile::WriteTitleMetadata() {
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
 
-    if (auto title_key = container.GetTicket().GetTitleKey()) {
-        decryption_state->content.resize(content_count);
-        for (std::size_t i = 0; i < content_count; ++i) {
-            auto ctr = tmd.GetContentCTRByIndex(i);
-            decryption_state->content[i].SetKeyWithIV(title_key->data(), title_key->size(),
-                                                      ctr.data());
-        }
-    }
+    pipeline =
+        std::make_unique<InstallPipeline>(container.GetTicket().GetTitleKey(), content_count);
 
     install_state = CIAInstallState::TMDLoaded;
 
@@ -148,11 +325,16 @@ ResultCode CIAFile::WriteTitleMetadata() {
 }
 
 ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length, const u8* buffer) {
+    // An earlier chunk failed to be written out on a worker thread
+    if (pipeline->HasFailed())
+        return FileSys::ERROR_INSUFFICIENT_SPACE;
+
     // Data is not being buffered, so we have to keep track of how much of each <ID>.app
     // has been written since we might get a written buffer which contains multiple .app
     // contents or only part of a larger .app's contents.
+    const FileSys::TitleMetadata& tmd = container.GetTitleMetadata();
     u64 offset_max = offset + length;
-    for (int i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
+    for (int i = 0; i < tmd.GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(i)) {
             // The size, minimum unwritten offset, and maximum unwritten offset of this content
             u64 size = container.GetContentSize(i);
@@ -166,30 +348,28 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
 
             // Figure out how much of this content ID we have just recieved/can write out
             u64 available_to_write = std::min(offset_max, range_max) - range_min;
+            if (available_to_write == 0)
+                continue;
 
             // Since the incoming TMD has already been written, we can use GetTitleContentPath
             // to get the content paths to write to.
-            FileSys::TitleMetadata tmd = container.GetTitleMetadata();
-            FileUtil::IOFile file(GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
-                                  content_written[i] ? "ab" : "wb");
-
-            if (!file.IsOpen())
-                return FileSys::ERROR_INSUFFICIENT_SPACE;
-
-            std::vector<u8> temp(buffer + (range_min - offset),
-                                 buffer + (range_min - offset) + available_to_write);
-
-            if (tmd.GetContentTypeByIndex(static_cast<u16>(i)) &
-                FileSys::TMDContentTypeFlag::Encrypted) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
+            if (content_written[i] == 0) {
+                const std::string path =
+                    GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update);
+                const bool encrypted = tmd.GetContentTypeByIndex(static_cast<u16>(i)) &
+                                       FileSys::TMDContentTypeFlag::Encrypted;
+                if (!pipeline->Open(i, path, size, encrypted, tmd.GetContentCTRByIndex(i),
+                                    tmd.GetContentHashByIndex(i)))
+                    return FileSys::ERROR_INSUFFICIENT_SPACE;
             }
 
-            file.WriteBytes(temp.data(), temp.size());
+            pipeline->Push(i, buffer + (range_min - offset),
+                           static_cast<std::size_t>(available_to_write));
 
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
             content_written[i] += available_to_write;
-            LOG_DEBUG(Service_AM, "Wrote {:x} to content {}, total {:x}", available_to_write, i,
+            LOG_DEBUG(Service_AM, "Queued {:x} for content {}, total {:x}", available_to_write, i,
                       content_written[i]);
         }
     }
@@ -276,7 +456,10 @@ bool CIAFile::SetSize(u64 size) const {
     return false;
 }
 
-void CIAFile::Close() const {
+bool CIAFile::Close() const {
+    if (pipeline)
+        pipeline->WaitForIdle();
+
     bool complete = true;
     for (std::size_t i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(static_cast<u16>(i)))
@@ -286,8 +469,14 @@ void CIAFile::Close() const {
     // Install aborted
     if (!complete) {
         LOG_ERROR(Service_AM, "CIAFile closed prematurely, aborting install...");
-        FileUtil::DeleteDir(GetTitlePath(media_type, container.GetTitleMetadata().GetTitleID()));
-        return;
+        DiscardInstall();
+        return true;
+    }
+
+    if (!IsComplete()) {
+        LOG_ERROR(Service_AM, "CIA contents failed verification, aborting install...");
+        DiscardInstall();
+        return true;
     }
 
     // Clean up older content data if we installed newer content on top
@@ -321,9 +510,68 @@ void CIAFile::Close() const {
 
         FileUtil::Delete(old_tmd_path);
     }
+    return true;
+}
+
+bool CIAFile::Flush() const {
+    return true;
 }
 
-void CIAFile::Flush() const {}
+void CIAFile::DiscardInstall() const {
+    // Nothing was written before the TMD
+    if (install_state < CIAInstallState::TMDLoaded)
+        return;
+
+    const u64 title_id = container.GetTitleMetadata().GetTitleID();
+    if (!is_update) {
+        FileUtil::DeleteDirRecursively(GetTitlePath(media_type, title_id));
+        return;
+    }
+
+    // The installed TMD stays the current one, so only the update's own contents are removed
+    const std::string old_tmd_path = GetTitleMetadataPath(media_type, title_id, false);
+    const std::string new_tmd_path = GetTitleMetadataPath(media_type, title_id, true);
+    FileSys::TitleMetadata old_tmd;
+    FileSys::TitleMetadata new_tmd;
+    if (old_tmd_path == new_tmd_path ||
+        old_tmd.Load(old_tmd_path) != Loader::ResultStatus::Success ||
+        new_tmd.Load(new_tmd_path) != Loader::ResultStatus::Success)
+        return;
+
+    for (u16 new_index = 0; new_index < new_tmd.GetContentCount(); new_index++) {
+        bool shared = false;
+        for (u16 old_index = 0; old_index < old_tmd.GetContentCount(); old_index++) {
+            if (old_tmd.GetContentIDByIndex(old_index) == new_tmd.GetContentIDByIndex(new_index))
+                shared = true;
+        }
+        if (!shared)
+            FileUtil::Delete(GetTitleContentPath(media_type, title_id, new_index, true));
+    }
+    FileUtil::Delete(new_tmd_path);
+}
+
+u64 CIAFile::GetInstalledSize() const {
+    return written - (pipeline ? pipeline->GetPendingSize() : 0);
+}
+
+bool CIAFile::IsComplete() const {
+    if (!pipeline)
+        return false;
+
+    pipeline->WaitForIdle();
+    if (pipeline->HasFailed())
+        return false;
+
+    for (std::size_t i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
+        if (container.GetContentSize(static_cast<u16>(i)) == 0)
+            continue;
+        if (!pipeline->IsVerified(i)) {
+            LOG_ERROR(Service_AM, "Content {} is incomplete or does not match the TMD hash", i);
+            return false;
+        }
+    }
+    return true;
+}
 
 InstallStatus InstallCIA(const std::string& path,
                          std::function<ProgressCallback>&& update_callback) {
@@ -354,15 +602,17 @@ InstallStatus InstallCIA(const std::string& path,
         if (!file.IsOpen())
             return InstallStatus::ErrorFailedToOpenFile;
 
-        std::array<u8, 0x10000> buffer;
+        // Writes only queue content data for the install workers, so this thread effectively
+        // just reads the CIA ahead of them. Progress reflects data actually written out.
+        std::vector<u8> buffer(0x100000);
         std::size_t total_bytes_read = 0;
         while (total_bytes_read != file.GetSize()) {
             std::size_t bytes_read = file.ReadBytes(buffer.data(), buffer.size());
             auto result = installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                            static_cast<u8*>(buffer.data()));
+                                            buffer.data());
 
             if (update_callback)
-                update_callback(total_bytes_read, file.GetSize());
+                update_callback(installFile.GetInstalledSize(), file.GetSize());
             if (result.Failed()) {
                 LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
                           result.Code().raw);
@@ -370,7 +620,15 @@ InstallStatus InstallCIA(const std::string& path,
             }
             total_bytes_read += bytes_read;
         }
+
+        const bool verified = installFile.IsComplete();
         installFile.Close();
+        if (update_callback)
+            update_callback(installFile.GetInstalledSize(), file.GetSize());
+        if (!verified) {
+            LOG_ERROR(Service_AM, "CIA file {} failed verification!", path);
+            return InstallStatus::ErrorInvalid;
+        }
 
         LOG_INFO(Service_AM, "Installed {} successfully.", path);
 
@@ -1154,8 +1412,12 @@ public:
     bool SetSize(u64 size) const override {
         return false;
     }
-    void Close() const override {}
-    void Flush() const override {}
+    bool Close() const override {
+        return true;
+    }
+    bool Flush() const override {
+        return true;
+    }
 
 private:
     std::shared_ptr<Service::FS::File> file;
@@ -75,10 +75,25 @@ public:
                                  const u8* buffer) override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
-    void Close() const override;
-    void Flush() const override;
+    bool Close() const override;
+    bool Flush() const override;
+
+    /// Returns how much of the data written so far has been decrypted, verified and written out.
+    u64 GetInstalledSize() const;
+
+    /**
+     * Waits for queued content data to be written out, then returns whether every content was
+     * received in full and matches its hash in the TMD.
+     */
+    bool IsComplete() const;
 
 private:
+    /**
+     * Deletes what an aborted install wrote. A new title is removed entirely, while an update
+     * only removes its own TMD and the contents the installed TMD does not refer to.
+     */
+    void DiscardInstall() const;
+
     // Whether it's installing an update, and what step of installation it is at
     bool is_update = false;
     CIAInstallState install_state = CIAInstallState::InstallStarted;
@@ -92,8 +107,9 @@ private:
     std::vector<u64> content_written;
     Service::FS::MediaType media_type;
 
-    class DecryptionState;
-    std::unique_ptr<DecryptionState> decryption_state;
+    // Decrypts, hashes and writes out content data on worker threads
+    class InstallPipeline;
+    std::unique_ptr<InstallPipeline> pipeline;
 };
 
 /**
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <system_error>
 #include <type_traits>
@@ -14,6 +15,7 @@
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/archive_extsavedata.h"
 #include "core/file_sys/archive_ncch.h"
@@ -26,11 +28,15 @@
 #include "core/file_sys/directory_backend.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/file_backend.h"
+#include "core/file_sys/write_back_cache.h"
 #include "core/hle/result.h"
 #include "core/hle/service/fs/archive.h"
 
 namespace Service::FS {
 
+/// Buffered save data writes are written back at least this often, in emulated time
+constexpr s64 write_back_interval = msToCycles(1000);
+
 MediaType GetMediaTypeFromPath(std::string_view path) {
     if (path.rfind(FileUtil::GetUserPath(FileUtil::UserPath::NANDDir), 0) == 0) {
         return MediaType::NAND;
@@ -41,9 +47,10 @@ MediaType GetMediaTypeFromPath(std::string_view path) {
     return MediaType::GameCard;
 }
 
-ArchiveBackend* ArchiveManager::GetArchive(ArchiveHandle handle) {
+std::shared_ptr<ArchiveBackend> ArchiveManager::GetArchive(ArchiveHandle handle) {
+    std::lock_guard lock{handle_map_mutex};
     auto itr = handle_map.find(handle);
-    return (itr == handle_map.end()) ? nullptr : itr->second.get();
+    return (itr == handle_map.end()) ? nullptr : itr->second;
 }
 
 ResultVal<ArchiveHandle> ArchiveManager::OpenArchive(ArchiveIdCode id_code,
@@ -58,15 +65,19 @@ ResultVal<ArchiveHandle> ArchiveManager::OpenArchive(ArchiveIdCode id_code,
     CASCADE_RESULT(std::unique_ptr<ArchiveBackend> res,
                    itr->second->Open(archive_path, program_id));
 
+    std::lock_guard lock{handle_map_mutex};
     // This should never even happen in the first place with 64-bit handles,
     while (handle_map.count(next_handle) != 0) {
         ++next_handle;
     }
     handle_map.emplace(next_handle, std::move(res));
+    handle_id_codes.emplace(next_handle, id_code);
     return MakeResult<ArchiveHandle>(next_handle++);
 }
 
 ResultCode ArchiveManager::CloseArchive(ArchiveHandle handle) {
+    std::lock_guard lock{handle_map_mutex};
+    handle_id_codes.erase(handle);
     if (handle_map.erase(handle) == 0)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
     else
@@ -91,7 +102,7 @@ ResultCode ArchiveManager::RegisterArchiveType(std::unique_ptr<FileSys::ArchiveF
 std::tuple<ResultVal<std::shared_ptr<File>>, std::chrono::nanoseconds>
 ArchiveManager::OpenFileFromArchive(ArchiveHandle archive_handle, const FileSys::Path& path,
                                     const FileSys::Mode mode) {
-    ArchiveBackend* archive = GetArchive(archive_handle);
+    const auto archive = GetArchive(archive_handle);
     if (archive == nullptr)
         return std::make_tuple(FileSys::ERR_INVALID_ARCHIVE_HANDLE,
                                static_cast<std::chrono::nanoseconds>(0));
@@ -107,7 +118,7 @@ ArchiveManager::OpenFileFromArchive(ArchiveHandle archive_handle, const FileSys:
 
 ResultCode ArchiveManager::DeleteFileFromArchive(ArchiveHandle archive_handle,
                                                  const FileSys::Path& path) {
-    ArchiveBackend* archive = GetArchive(archive_handle);
+    const auto archive = GetArchive(archive_handle);
     if (archive == nullptr)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
 
@@ -118,8 +129,8 @@ ResultCode ArchiveManager::RenameFileBetweenArchives(ArchiveHandle src_archive_h
                                                      const FileSys::Path& src_path,
                                                      ArchiveHandle dest_archive_handle,
                                                      const FileSys::Path& dest_path) {
-    ArchiveBackend* src_archive = GetArchive(src_archive_handle);
-    ArchiveBackend* dest_archive = GetArchive(dest_archive_handle);
+    const auto src_archive = GetArchive(src_archive_handle);
+    const auto dest_archive = GetArchive(dest_archive_handle);
     if (src_archive == nullptr || dest_archive == nullptr)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
 
@@ -133,7 +144,7 @@ ResultCode ArchiveManager::RenameFileBetweenArchives(ArchiveHandle src_archive_h
 
 ResultCode ArchiveManager::DeleteDirectoryFromArchive(ArchiveHandle archive_handle,
                                                       const FileSys::Path& path) {
-    ArchiveBackend* archive = GetArchive(archive_handle);
+    const auto archive = GetArchive(archive_handle);
     if (archive == nullptr)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
 
@@ -142,7 +153,7 @@ ResultCode ArchiveManager::DeleteDirectoryFromArchive(ArchiveHandle archive_hand
 
 ResultCode ArchiveManager::DeleteDirectoryRecursivelyFromArchive(ArchiveHandle archive_handle,
                                                                  const FileSys::Path& path) {
-    ArchiveBackend* archive = GetArchive(archive_handle);
+    const auto archive = GetArchive(archive_handle);
     if (archive == nullptr)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
 
@@ -151,7 +162,7 @@ ResultCode ArchiveManager::DeleteDirectoryRecursivelyFromArchive(ArchiveHandle a
 
 ResultCode ArchiveManager::CreateFileInArchive(ArchiveHandle archive_handle,
                                                const FileSys::Path& path, u64 file_size) {
-    ArchiveBackend* archive = GetArchive(archive_handle);
+    const auto archive = GetArchive(archive_handle);
     if (archive == nullptr)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
 
@@ -160,7 +171,7 @@ ResultCode ArchiveManager::CreateFileInArchive(ArchiveHandle archive_handle,
 
 ResultCode ArchiveManager::CreateDirectoryFromArchive(ArchiveHandle archive_handle,
                                                       const FileSys::Path& path) {
-    ArchiveBackend* archive = GetArchive(archive_handle);
+    const auto archive = GetArchive(archive_handle);
     if (archive == nullptr)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
 
@@ -171,8 +182,8 @@ ResultCode ArchiveManager::RenameDirectoryBetweenArchives(ArchiveHandle src_arch
                                                           const FileSys::Path& src_path,
                                                           ArchiveHandle dest_archive_handle,
                                                           const FileSys::Path& dest_path) {
-    ArchiveBackend* src_archive = GetArchive(src_archive_handle);
-    ArchiveBackend* dest_archive = GetArchive(dest_archive_handle);
+    const auto src_archive = GetArchive(src_archive_handle);
+    const auto dest_archive = GetArchive(dest_archive_handle);
     if (src_archive == nullptr || dest_archive == nullptr)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
 
@@ -186,7 +197,7 @@ ResultCode ArchiveManager::RenameDirectoryBetweenArchives(ArchiveHandle src_arch
 
 ResultVal<std::shared_ptr<Directory>> ArchiveManager::OpenDirectoryFromArchive(
     ArchiveHandle archive_handle, const FileSys::Path& path) {
-    ArchiveBackend* archive = GetArchive(archive_handle);
+    const auto archive = GetArchive(archive_handle);
     if (archive == nullptr)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
 
@@ -198,8 +209,22 @@ ResultVal<std::shared_ptr<Directory>> ArchiveManager::OpenDirectoryFromArchive(
     return MakeResult<std::shared_ptr<Directory>>(std::move(directory));
 }
 
+std::chrono::nanoseconds ArchiveManager::GetOpenDelay(ArchiveHandle archive_handle) {
+    const auto archive = GetArchive(archive_handle);
+    if (archive == nullptr)
+        return std::chrono::nanoseconds(0);
+    return std::chrono::nanoseconds(archive->GetOpenDelayNs());
+}
+
+std::chrono::nanoseconds ArchiveManager::GetMetadataDelay(ArchiveHandle archive_handle) {
+    const auto archive = GetArchive(archive_handle);
+    if (archive == nullptr)
+        return std::chrono::nanoseconds(0);
+    return std::chrono::nanoseconds(archive->GetMetadataDelayNs());
+}
+
 ResultVal<u64> ArchiveManager::GetFreeBytesInArchive(ArchiveHandle archive_handle) {
-    ArchiveBackend* archive = GetArchive(archive_handle);
+    const auto archive = GetArchive(archive_handle);
     if (archive == nullptr)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
     return MakeResult<u64>(archive->GetFreeBytes());
@@ -378,11 +403,44 @@ void ArchiveManager::RegisterSelfNCCH(Loader::AppLoader& app_loader) {
 }
 
 bool ArchiveManager::CheckArchiveHandle(ArchiveHandle handle) {
+    std::lock_guard lock{handle_map_mutex};
     return handle_map.find(handle) != handle_map.end();
 }
 
+bool ArchiveManager::CanOpenOnIOThread(ArchiveHandle archive_handle) {
+    std::lock_guard lock{handle_map_mutex};
+    const auto itr = handle_id_codes.find(archive_handle);
+    return itr != handle_id_codes.end() && itr->second != ArchiveIdCode::SelfNCCH &&
+           itr->second != ArchiveIdCode::NCCH;
+}
+
 ArchiveManager::ArchiveManager(Core::System& system) : system(system) {
     RegisterArchiveTypes();
+
+    using namespace std::placeholders;
+    write_back_event = system.CoreTiming().RegisterEvent(
+        "ArchiveManager::WriteBackCallback",
+        std::bind(&ArchiveManager::WriteBackCallback, this, _1, _2));
+    system.CoreTiming().ScheduleEvent(write_back_interval, write_back_event, 0, 0);
+}
+
+ArchiveManager::~ArchiveManager() {
+    auto& write_back_cache = FileSys::WriteBackCache::GetInstance();
+    write_back_cache.FlushAll();
+    const FileSys::WriteBackStats stats = write_back_cache.GetStats();
+    LOG_INFO(Service_FS,
+             "Save data write-back turned {} writes and {} flushes into {} host writes and {} "
+             "host flushes",
+             stats.guest_writes, stats.guest_flushes, stats.host_writes, stats.host_flushes);
+}
+
+bool ArchiveManager::CommitSaveData() {
+    return FileSys::WriteBackCache::GetInstance().FlushAll();
+}
+
+void ArchiveManager::WriteBackCallback(u64 userdata, s64 cycles_late) {
+    FileSys::WriteBackCache::GetInstance().FlushAll();
+    system.CoreTiming().ScheduleEvent(write_back_interval - cycles_late, write_back_event);
 }
 
 } // namespace Service::FS
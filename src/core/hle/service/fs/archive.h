@@ -5,10 +5,12 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
+#include "common/thread_pool.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/result.h"
 #include "core/hle/service/fs/directory.h"
@@ -25,6 +27,7 @@ class AppLoader;
 
 namespace Core {
 class System;
+struct TimingEventType;
 }
 
 namespace Service::FS {
@@ -70,6 +73,7 @@ using FileSys::ArchiveFactory;
 class ArchiveManager {
 public:
     explicit ArchiveManager(Core::System& system);
+    ~ArchiveManager();
 
     /**
      * Opens an archive
@@ -175,6 +179,21 @@ public:
     ResultVal<std::shared_ptr<Directory>> OpenDirectoryFromArchive(ArchiveHandle archive_handle,
                                                                    const FileSys::Path& path);
 
+    /**
+     * Get the time a 3ds needs to open a File in an Archive
+     * @param archive_handle Handle to an open Archive object
+     * @return The delay, or 0 if the handle is invalid
+     */
+    std::chrono::nanoseconds GetOpenDelay(ArchiveHandle archive_handle);
+
+    /**
+     * Get the time a 3ds needs to create, delete or rename a file or directory, or to open a
+     * directory, in an Archive
+     * @param archive_handle Handle to an open Archive object
+     * @return The delay, or 0 if the handle is invalid
+     */
+    std::chrono::nanoseconds GetMetadataDelay(ArchiveHandle archive_handle);
+
     /**
      * Get the free space in an Archive
      * @param archive_handle Handle to an open Archive object
@@ -258,6 +277,24 @@ public:
     /// check
     bool CheckArchiveHandle(ArchiveHandle handle);
 
+    /**
+     * Whether files and directories of an archive may be opened on the I/O pool. NCCH archives
+     * are opened on the emulation thread, as opening them parses and decrypts NCCH containers.
+     * @param archive_handle Handle to an open Archive object
+     */
+    bool CanOpenOnIOThread(ArchiveHandle archive_handle);
+
+    /// Writes back the buffered writes to save data files, e.g. when the application commits
+    /// its save data. Returns false if any of them could not be written back.
+    bool CommitSaveData();
+
+    /// Thread performing host file I/O while the requesting guest thread waits out the delay of
+    /// the operation. There is a single one, so that operations complete in the order they were
+    /// requested.
+    Common::ThreadPool& GetIOPool() {
+        return io_pool;
+    }
+
 private:
     Core::System& system;
 
@@ -272,7 +309,10 @@ private:
     /// Register all archive types
     void RegisterArchiveTypes();
 
-    ArchiveBackend* GetArchive(ArchiveHandle handle);
+    std::shared_ptr<ArchiveBackend> GetArchive(ArchiveHandle handle);
+
+    /// Periodically writes back buffered save data writes
+    void WriteBackCallback(u64 userdata, s64 cycles_late);
 
     /**
      * Map of registered archives, identified by id code. Once an archive is registered here, it is
@@ -281,10 +321,18 @@ private:
     std::unordered_map<ArchiveIdCode, std::unique_ptr<ArchiveFactory>> id_code_map;
 
     /**
-     * Map of active archive handles to archive objects
+     * Map of active archive handles to archive objects. Files and directories are opened, created,
+     * deleted and renamed on the I/O pool, so the archives are shared with its tasks.
      */
-    std::unordered_map<ArchiveHandle, std::unique_ptr<ArchiveBackend>> handle_map;
+    std::unordered_map<ArchiveHandle, std::shared_ptr<ArchiveBackend>> handle_map;
+    /// Id code each active archive handle was opened with
+    std::unordered_map<ArchiveHandle, ArchiveIdCode> handle_id_codes;
+    std::mutex handle_map_mutex;
     ArchiveHandle next_handle = 1;
+
+    Core::TimingEventType* write_back_event = nullptr;
+
+    Common::ThreadPool io_pool{1, "FS I/O"};
 };
 
 } // namespace Service::FS
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <utility>
+#include <vector>
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
@@ -11,6 +13,7 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/file.h"
 
 namespace Service::FS {
@@ -55,28 +58,51 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     // This file session might have a specific offset from where to start reading, apply it.
     offset += file->offset;
 
+    std::unique_lock lock{backend_mutex};
     if (offset + length > backend->GetSize()) {
         LOG_ERROR(Service_FS,
                   "Reading from out of bounds offset=0x{:x} length=0x{:08X} file_size=0x{:x}",
                   offset, length, backend->GetSize());
     }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
+    std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
 
-    std::vector<u8> data(length);
-    ResultVal<std::size_t> read = backend->Read(offset, data.size(), data.data());
-    if (read.Failed()) {
-        rb.Push(read.Code());
-        rb.Push<u32>(0);
-    } else {
-        buffer.Write(data.data(), 0, *read);
+    // Backends holding the file in host memory can be copied straight into the guest buffer.
+    const u64 file_size = backend->GetSize();
+    const std::size_t available =
+        offset < file_size ? static_cast<std::size_t>(std::min<u64>(length, file_size - offset))
+                           : 0;
+    if (const u8* direct = backend->GetDirectPointer(offset, available)) {
+        buffer.Write(direct, 0, available);
+        IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
         rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(static_cast<u32>(*read));
+        rb.Push<u32>(static_cast<u32>(available));
+        rb.PushMappedBuffer(buffer);
+        ctx.SleepClientThread("file::read", read_timeout_ns, nullptr);
+        return;
     }
-    rb.PushMappedBuffer(buffer);
-
-    std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
-    ctx.SleepClientThread("file::read", read_timeout_ns, nullptr);
+    lock.unlock();
+
+    // Otherwise the host read overlaps the delay of the read instead of blocking the emulation
+    auto data = std::make_shared<std::vector<u8>>(length);
+    ctx.RunAsync(
+        system.ArchiveManager().GetIOPool(), "file::read", read_timeout_ns,
+        [self = std::static_pointer_cast<File>(shared_from_this()), offset, data] {
+            std::lock_guard lock{self->backend_mutex};
+            return self->backend->Read(offset, data->size(), data->data());
+        },
+        [data, buffer](Kernel::HLERequestContext& ctx, ResultVal<std::size_t> read) mutable {
+            IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
+            if (read.Failed()) {
+                rb.Push(read.Code());
+                rb.Push<u32>(0);
+            } else {
+                buffer.Write(data->data(), 0, *read);
+                rb.Push(RESULT_SUCCESS);
+                rb.Push<u32>(static_cast<u32>(*read));
+            }
+            rb.PushMappedBuffer(buffer);
+        });
 }
 
 void File::Write(Kernel::HLERequestContext& ctx) {
@@ -88,12 +114,11 @@ void File::Write(Kernel::HLERequestContext& ctx) {
     LOG_TRACE(Service_FS, "Write {}: offset=0x{:x} length={}, flush=0x{:x}", GetName(), offset,
               length, flush);
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-
-    FileSessionSlot* file = GetSessionData(ctx.Session());
+    const FileSessionSlot* file = GetSessionData(ctx.Session());
 
     // Subfiles can not be written to
     if (file->subfile) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
         rb.Push(FileSys::ERROR_UNSUPPORTED_OPEN_FLAGS);
         rb.Push<u32>(0);
         rb.PushMappedBuffer(buffer);
@@ -102,19 +127,35 @@ void File::Write(Kernel::HLERequestContext& ctx) {
 
     std::vector<u8> data(length);
     buffer.Read(data.data(), 0, data.size());
-    ResultVal<std::size_t> written = backend->Write(offset, data.size(), flush != 0, data.data());
-
-    // Update file size
-    file->size = backend->GetSize();
 
-    if (written.Failed()) {
-        rb.Push(written.Code());
-        rb.Push<u32>(0);
-    } else {
-        rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(static_cast<u32>(*written));
-    }
-    rb.PushMappedBuffer(buffer);
+    // The host write overlaps the delay of the write instead of blocking the emulation
+    std::chrono::nanoseconds write_timeout_ns{backend->GetWriteDelayNs(length)};
+    auto self = std::static_pointer_cast<File>(shared_from_this());
+    ctx.RunAsync(
+        system.ArchiveManager().GetIOPool(), "file::write", write_timeout_ns,
+        [self, offset, flush, data = std::move(data)] {
+            std::lock_guard lock{self->backend_mutex};
+            ResultVal<std::size_t> written =
+                self->backend->Write(offset, data.size(), flush != 0, data.data());
+            return std::make_pair(std::move(written), self->backend->GetSize());
+        },
+        [self, buffer](Kernel::HLERequestContext& ctx,
+                       std::pair<ResultVal<std::size_t>, u64> result) mutable {
+            const auto& [written, size] = result;
+
+            // Update file size
+            self->GetSessionData(ctx.Session())->size = size;
+
+            IPC::RequestBuilder rb(ctx, 0x0803, 2, 2);
+            if (written.Failed()) {
+                rb.Push(written.Code());
+                rb.Push<u32>(0);
+            } else {
+                rb.Push(RESULT_SUCCESS);
+                rb.Push<u32>(static_cast<u32>(*written));
+            }
+            rb.PushMappedBuffer(buffer);
+        });
 }
 
 void File::GetSize(Kernel::HLERequestContext& ctx) {
@@ -142,6 +183,7 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
     }
 
     file->size = size;
+    std::lock_guard lock{backend_mutex};
     backend->SetSize(size);
     rb.Push(RESULT_SUCCESS);
 }
@@ -154,9 +196,10 @@ void File::Close(Kernel::HLERequestContext& ctx) {
         LOG_WARNING(Service_FS, "Closing File backend but {} clients still connected",
                     connected_sessions.size());
 
-    backend->Close();
+    std::lock_guard lock{backend_mutex};
+    const bool success = backend->Close();
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(RESULT_SUCCESS);
+    rb.Push(success ? RESULT_SUCCESS : FileSys::ERROR_INSUFFICIENT_SPACE);
 }
 
 void File::Flush(Kernel::HLERequestContext& ctx) {
@@ -172,8 +215,8 @@ void File::Flush(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    backend->Flush();
-    rb.Push(RESULT_SUCCESS);
+    std::lock_guard lock{backend_mutex};
+    rb.Push(backend->Flush() ? RESULT_SUCCESS : FileSys::ERROR_INSUFFICIENT_SPACE);
 }
 
 void File::SetPriority(Kernel::HLERequestContext& ctx) {
@@ -209,7 +252,10 @@ void File::OpenLinkFile(Kernel::HLERequestContext& ctx) {
 
     slot->priority = original_file->priority;
     slot->offset = 0;
-    slot->size = backend->GetSize();
+    {
+        std::lock_guard lock{backend_mutex};
+        slot->size = backend->GetSize();
+    }
     slot->subfile = false;
 
     rb.Push(RESULT_SUCCESS);
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/service/service.h"
 
@@ -60,6 +61,9 @@ private:
     void OpenSubFile(Kernel::HLERequestContext& ctx);
 
     Core::System& system;
+
+    /// Serializes the accesses to the backend, as reads and writes run on the I/O thread
+    std::mutex backend_mutex;
 };
 
 } // namespace Service::FS
@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
+#include <functional>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -34,6 +36,43 @@ using Kernel::ServerSession;
 
 namespace Service::FS {
 
+namespace {
+/**
+ * Creates, deletes or renames a file or directory on the I/O thread, while the client thread
+ * sleeps for the time a 3ds needs to do it
+ * @param command_id Command to respond to with the result of the operation
+ * @param operation Function performing the operation
+ */
+void RunMetadataOperation(Kernel::HLERequestContext& ctx, ArchiveManager& archives,
+                          ArchiveHandle archive_handle, u16 command_id, const std::string& reason,
+                          std::function<ResultCode(ArchiveManager&)> operation) {
+    ctx.RunAsync(
+        archives.GetIOPool(), reason, archives.GetMetadataDelay(archive_handle),
+        [&archives, operation = std::move(operation)] { return operation(archives); },
+        [command_id](Kernel::HLERequestContext& ctx, ResultCode result) {
+            IPC::RequestBuilder rb(ctx, command_id, 1, 0);
+            rb.Push(result);
+        });
+}
+
+/**
+ * Opens a file or directory like HLERequestContext::RunAsync, except for the archives which
+ * cannot be opened on the I/O thread. Those are opened right away, and the client thread only
+ * sleeps for the delay.
+ */
+template <typename Work, typename Reply>
+void RunOpenOperation(Kernel::HLERequestContext& ctx, ArchiveManager& archives,
+                      ArchiveHandle archive_handle, const std::string& reason,
+                      std::chrono::nanoseconds delay, Work work, Reply reply) {
+    if (archives.CanOpenOnIOThread(archive_handle)) {
+        ctx.RunAsync(archives.GetIOPool(), reason, delay, std::move(work), std::move(reply));
+        return;
+    }
+    reply(ctx, work());
+    ctx.SleepClientThread(reason, std::max(delay, std::chrono::nanoseconds(1)), nullptr);
+}
+} // Anonymous namespace
+
 void FS_USER::Initialize(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0801, 0, 2);
     u32 pid = rp.PopPID();
@@ -60,19 +99,22 @@ void FS_USER::OpenFile(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Service_FS, "FS_USER OpenFile path={}, mode={} attrs={}", file_path.DebugStr(), mode.hex, attributes);
 
-    const auto [file_res, open_timeout_ns] =
-        archives.OpenFileFromArchive(archive_handle, file_path, mode);
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
-    rb.Push(file_res.Code());
-    if (file_res.Succeeded()) {
-        std::shared_ptr<File> file = *file_res;
-        rb.PushMoveObjects(file->Connect());
-    } else {
-        rb.PushMoveObjects<Kernel::Object>(nullptr);
-        LOG_ERROR(Service_FS, "failed to get a handle for file {}", file_path.DebugStr());
-    }
-
-    ctx.SleepClientThread("fs_user::open", open_timeout_ns, nullptr);
+    RunOpenOperation(
+        ctx, archives, archive_handle, "fs_user::open", archives.GetOpenDelay(archive_handle),
+        [this, archive_handle, file_path, mode] {
+            return std::get<0>(archives.OpenFileFromArchive(archive_handle, file_path, mode));
+        },
+        [file_path](Kernel::HLERequestContext& ctx, ResultVal<std::shared_ptr<File>> file_res) {
+            IPC::RequestBuilder rb(ctx, 0x0802, 1, 2);
+            rb.Push(file_res.Code());
+            if (file_res.Succeeded()) {
+                std::shared_ptr<File> file = *file_res;
+                rb.PushMoveObjects(file->Connect());
+            } else {
+                rb.PushMoveObjects<Kernel::Object>(nullptr);
+                LOG_ERROR(Service_FS, "failed to get a handle for file {}", file_path.DebugStr());
+            }
+        });
 }
 
 void FS_USER::OpenFileDirectly(Kernel::HLERequestContext& ctx) {
@@ -142,8 +184,10 @@ void FS_USER::DeleteFile(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_FS, "FS_USER DeleteFile type={} size={} data={}", static_cast<u32>(filename_type), filename_size,
               file_path.DebugStr());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(archives.DeleteFileFromArchive(archive_handle, file_path));
+    RunMetadataOperation(ctx, archives, archive_handle, 0x804, "fs_user::delete_file",
+                         [archive_handle, file_path](ArchiveManager& manager) {
+                             return manager.DeleteFileFromArchive(archive_handle, file_path);
+                         });
 }
 
 void FS_USER::RenameFile(Kernel::HLERequestContext& ctx) {
@@ -169,9 +213,13 @@ void FS_USER::RenameFile(Kernel::HLERequestContext& ctx) {
               static_cast<u32>(src_filename_type), src_filename_size, src_file_path.DebugStr(),
               static_cast<u32>(dest_filename_type), dest_filename_size, dest_file_path.DebugStr());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(archives.RenameFileBetweenArchives(src_archive_handle, src_file_path,
-                                               dest_archive_handle, dest_file_path));
+    RunMetadataOperation(ctx, archives, src_archive_handle, 0x805, "fs_user::rename_file",
+                         [src_archive_handle, src_file_path, dest_archive_handle,
+                          dest_file_path](ArchiveManager& manager) {
+                             return manager.RenameFileBetweenArchives(
+                                 src_archive_handle, src_file_path, dest_archive_handle,
+                                 dest_file_path);
+                         });
 }
 
 void FS_USER::DeleteDirectory(Kernel::HLERequestContext& ctx) {
@@ -189,8 +237,10 @@ void FS_USER::DeleteDirectory(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_FS, "type={} size={} data={}", static_cast<u32>(dirname_type), dirname_size,
               dir_path.DebugStr());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(archives.DeleteDirectoryFromArchive(archive_handle, dir_path));
+    RunMetadataOperation(ctx, archives, archive_handle, 0x806, "fs_user::delete_directory",
+                         [archive_handle, dir_path](ArchiveManager& manager) {
+                             return manager.DeleteDirectoryFromArchive(archive_handle, dir_path);
+                         });
 }
 
 void FS_USER::DeleteDirectoryRecursively(Kernel::HLERequestContext& ctx) {
@@ -208,8 +258,12 @@ void FS_USER::DeleteDirectoryRecursively(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_FS, "type={} size={} data={}", static_cast<u32>(dirname_type), dirname_size,
               dir_path.DebugStr());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(archives.DeleteDirectoryRecursivelyFromArchive(archive_handle, dir_path));
+    RunMetadataOperation(ctx, archives, archive_handle, 0x807,
+                         "fs_user::delete_directory_recursively",
+                         [archive_handle, dir_path](ArchiveManager& manager) {
+                             return manager.DeleteDirectoryRecursivelyFromArchive(archive_handle,
+                                                                                  dir_path);
+                         });
 }
 
 void FS_USER::CreateFile(Kernel::HLERequestContext& ctx) {
@@ -229,8 +283,11 @@ void FS_USER::CreateFile(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_FS, "FS_USER CreateFile type={} attributes={} size={:x} data={}",
               static_cast<u32>(filename_type), attributes, file_size, file_path.DebugStr());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(archives.CreateFileInArchive(archive_handle, file_path, file_size));
+    RunMetadataOperation(ctx, archives, archive_handle, 0x808, "fs_user::create_file",
+                         [archive_handle, file_path, file_size](ArchiveManager& manager) {
+                             return manager.CreateFileInArchive(archive_handle, file_path,
+                                                                file_size);
+                         });
 }
 
 void FS_USER::CreateDirectory(Kernel::HLERequestContext& ctx) {
@@ -247,8 +304,10 @@ void FS_USER::CreateDirectory(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_FS, "FS_USER CreateDirectory type={} size={} data={}", static_cast<u32>(dirname_type), dirname_size,
               dir_path.DebugStr());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(archives.CreateDirectoryFromArchive(archive_handle, dir_path));
+    RunMetadataOperation(ctx, archives, archive_handle, 0x809, "fs_user::create_directory",
+                         [archive_handle, dir_path](ArchiveManager& manager) {
+                             return manager.CreateDirectoryFromArchive(archive_handle, dir_path);
+                         });
 }
 
 void FS_USER::RenameDirectory(Kernel::HLERequestContext& ctx) {
@@ -273,9 +332,13 @@ void FS_USER::RenameDirectory(Kernel::HLERequestContext& ctx) {
               static_cast<u32>(src_dirname_type), src_dirname_size, src_dir_path.DebugStr(),
               static_cast<u32>(dest_dirname_type), dest_dirname_size, dest_dir_path.DebugStr());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(archives.RenameDirectoryBetweenArchives(src_archive_handle, src_dir_path,
-                                                    dest_archive_handle, dest_dir_path));
+    RunMetadataOperation(ctx, archives, src_archive_handle, 0x80A, "fs_user::rename_directory",
+                         [src_archive_handle, src_dir_path, dest_archive_handle,
+                          dest_dir_path](ArchiveManager& manager) {
+                             return manager.RenameDirectoryBetweenArchives(
+                                 src_archive_handle, src_dir_path, dest_archive_handle,
+                                 dest_dir_path);
+                         });
 }
 
 void FS_USER::OpenDirectory(Kernel::HLERequestContext& ctx) {
@@ -291,20 +354,28 @@ void FS_USER::OpenDirectory(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_FS, "FS_USER OpenDirectory type={} size={} data={}", static_cast<u32>(dirname_type), dirname_size,
               dir_path.DebugStr());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
-    ResultVal<std::shared_ptr<Directory>> dir_res =
-        archives.OpenDirectoryFromArchive(archive_handle, dir_path);
-    rb.Push(dir_res.Code());
-    if (dir_res.Succeeded()) {
-        std::shared_ptr<Directory> directory = *dir_res;
-        auto [server, client] = system.Kernel().CreateSessionPair(directory->GetName());
-        directory->ClientConnected(server);
-        rb.PushMoveObjects(client);
-    } else {
-        LOG_ERROR(Service_FS, "failed to get a handle for directory type={} size={} data={}",
-                  static_cast<u32>(dirname_type), dirname_size, dir_path.DebugStr());
-        rb.PushMoveObjects<Kernel::Object>(nullptr);
-    }
+    RunOpenOperation(
+        ctx, archives, archive_handle, "fs_user::open_directory",
+        archives.GetMetadataDelay(archive_handle),
+        [this, archive_handle, dir_path] {
+            return archives.OpenDirectoryFromArchive(archive_handle, dir_path);
+        },
+        [this, dirname_type, dirname_size, dir_path](
+            Kernel::HLERequestContext& ctx, ResultVal<std::shared_ptr<Directory>> dir_res) {
+            IPC::RequestBuilder rb(ctx, 0x80B, 1, 2);
+            rb.Push(dir_res.Code());
+            if (dir_res.Succeeded()) {
+                std::shared_ptr<Directory> directory = *dir_res;
+                auto [server, client] = system.Kernel().CreateSessionPair(directory->GetName());
+                directory->ClientConnected(server);
+                rb.PushMoveObjects(client);
+            } else {
+                LOG_ERROR(Service_FS,
+                          "failed to get a handle for directory type={} size={} data={}",
+                          static_cast<u32>(dirname_type), dirname_size, dir_path.DebugStr());
+                rb.PushMoveObjects<Kernel::Object>(nullptr);
+            }
+        });
 }
 
 void FS_USER::OpenArchive(Kernel::HLERequestContext& ctx) {
@@ -349,6 +420,8 @@ void FS_USER::ControlArchive(Kernel::HLERequestContext& ctx) {
         if (!archives.CheckArchiveHandle(archive_handle)) {
             result = ResultCode(FileSys::ErrCodes::ArchiveNotMounted, ErrorModule::FS,
                                 ErrorSummary::NotFound, ErrorLevel::Status);
+        } else if (!archives.CommitSaveData()) {
+            result = FileSys::ERROR_INSUFFICIENT_SPACE;
         }
     } else if (action == 1) {
         // Action 1 : Retrieves a file's last-modified timestamp.
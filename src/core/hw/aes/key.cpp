@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <exception>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <cryptopp/aes.h>
@@ -89,6 +90,9 @@ struct KeySlot {
 
 std::array<KeySlot, KeySlotID::MaxKeySlotID> key_slots;
 std::array<std::optional<AESKey>, 6> common_key_y_slots;
+/// Guards the key slots, which are used by the emulation, game list and file system threads.
+/// Recursive, as InitKeys loads the firmware keys from NCCH containers, which derive keys again.
+std::recursive_mutex key_mutex;
 
 enum class FirmwareType : u32 {
     ARM9 = 0,  // uses NDMA
@@ -495,6 +499,7 @@ void LoadPresetKeys() {
 } // namespace
 
 void InitKeys() {
+    std::lock_guard lock{key_mutex};
     static bool initialized = false;
     if (initialized)
         return;
@@ -508,27 +513,54 @@ void InitKeys() {
 }
 
 void SetKeyX(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
     key_slots.at(slot_id).SetKeyX(key);
 }
 
 void SetKeyY(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
     key_slots.at(slot_id).SetKeyY(key);
 }
 
 void SetNormalKey(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
     key_slots.at(slot_id).SetNormalKey(key);
 }
 
+void SetCommonKeyY(std::size_t index, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
+    common_key_y_slots.at(index) = key;
+}
+
 bool IsNormalKeyAvailable(std::size_t slot_id) {
+    std::lock_guard lock{key_mutex};
     return key_slots.at(slot_id).normal.has_value();
 }
 
 AESKey GetNormalKey(std::size_t slot_id) {
+    std::lock_guard lock{key_mutex};
     return key_slots.at(slot_id).normal.value_or(AESKey{});
 }
 
+std::optional<AESKey> GenerateNormalKey(std::size_t slot_id, const AESKey& key_y) {
+    std::lock_guard lock{key_mutex};
+    KeySlot slot = key_slots.at(slot_id);
+    slot.SetKeyY(key_y);
+    return slot.normal;
+}
+
 void SelectCommonKeyIndex(u8 index) {
+    std::lock_guard lock{key_mutex};
     key_slots[KeySlotID::TicketCommonKey].SetKeyY(common_key_y_slots.at(index));
 }
 
+std::optional<AESKey> GetCommonKey(u8 index) {
+    std::lock_guard lock{key_mutex};
+    if (index >= common_key_y_slots.size())
+        return {};
+    KeySlot slot = key_slots[KeySlotID::TicketCommonKey];
+    slot.SetKeyY(common_key_y_slots[index]);
+    return slot.normal;
+}
+
 } // namespace HW::AES
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <optional>
 #include "common/common_types.h"
 
 namespace HW::AES {
@@ -58,10 +59,25 @@ void SetGeneratorConstant(const AESKey& key);
 void SetKeyX(std::size_t slot_id, const AESKey& key);
 void SetKeyY(std::size_t slot_id, const AESKey& key);
 void SetNormalKey(std::size_t slot_id, const AESKey& key);
+void SetCommonKeyY(std::size_t index, const AESKey& key);
 
 bool IsNormalKeyAvailable(std::size_t slot_id);
 AESKey GetNormalKey(std::size_t slot_id);
 
+/**
+ * Returns the normal key the slot would hold with the given KeyY, without changing the slot, or
+ * nothing if the slot has no KeyX. Unlike SetKeyY followed by GetNormalKey, this can be used by
+ * several threads at once.
+ */
+std::optional<AESKey> GenerateNormalKey(std::size_t slot_id, const AESKey& key_y);
+
 void SelectCommonKeyIndex(u8 index);
 
+/**
+ * Returns the normal key the ticket common key slot would hold with the given common key
+ * selected, without changing the slot, or nothing if that key is unavailable. Unlike
+ * SelectCommonKeyIndex followed by GetNormalKey, this can be used by several threads at once.
+ */
+std::optional<AESKey> GetCommonKey(u8 index);
+
 } // namespace HW::AES
@@ -0,0 +1,380 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+#include "common/color.h"
+#include "common/vector_math.h"
+#include "core/hw/display_transfer.h"
+#include "video_core/utils.h"
+
+namespace GPU {
+
+namespace {
+
+using PixelFormat = Regs::PixelFormat;
+
+template <PixelFormat format>
+Common::Vec4<u8> DecodePixel(const u8* src_pixel) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        return Color::DecodeRGBA8(src_pixel);
+    } else if constexpr (format == PixelFormat::RGB8) {
+        return Color::DecodeRGB8(src_pixel);
+    } else if constexpr (format == PixelFormat::RGB565) {
+        return Color::DecodeRGB565(src_pixel);
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        return Color::DecodeRGB5A1(src_pixel);
+    } else {
+        static_assert(format == PixelFormat::RGBA4);
+        return Color::DecodeRGBA4(src_pixel);
+    }
+}
+
+template <PixelFormat format>
+void EncodePixel(const Common::Vec4<u8>& color, u8* dst_pixel) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        Color::EncodeRGBA8(color, dst_pixel);
+    } else if constexpr (format == PixelFormat::RGB8) {
+        Color::EncodeRGB8(color, dst_pixel);
+    } else if constexpr (format == PixelFormat::RGB565) {
+        Color::EncodeRGB565(color, dst_pixel);
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        Color::EncodeRGB5A1(color, dst_pixel);
+    } else {
+        static_assert(format == PixelFormat::RGBA4);
+        Color::EncodeRGBA4(color, dst_pixel);
+    }
+}
+
+/// Calls func with the given pixel format as a compile-time constant, returns false if the
+/// format is unknown
+template <typename Func>
+bool DispatchPixelFormat(PixelFormat format, Func&& func) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        func(std::integral_constant<PixelFormat, PixelFormat::RGBA8>{});
+        return true;
+    case PixelFormat::RGB8:
+        func(std::integral_constant<PixelFormat, PixelFormat::RGB8>{});
+        return true;
+    case PixelFormat::RGB565:
+        func(std::integral_constant<PixelFormat, PixelFormat::RGB565>{});
+        return true;
+    case PixelFormat::RGB5A1:
+        func(std::integral_constant<PixelFormat, PixelFormat::RGB5A1>{});
+        return true;
+    case PixelFormat::RGBA4:
+        func(std::integral_constant<PixelFormat, PixelFormat::RGBA4>{});
+        return true;
+    default:
+        return false;
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+/// Reverses the byte order of every 32-bit lane, which converts between RGBA8 in memory and
+/// decoded colors
+__m128i ByteSwap32(__m128i pixels) {
+    const __m128i byte_mask = _mm_set1_epi32(0x0000FF00);
+    __m128i swapped = _mm_or_si128(_mm_slli_epi32(pixels, 24), _mm_srli_epi32(pixels, 24));
+    swapped = _mm_or_si128(swapped, _mm_and_si128(_mm_srli_epi32(pixels, 8), byte_mask));
+    return _mm_or_si128(swapped, _mm_slli_epi32(_mm_and_si128(pixels, byte_mask), 8));
+}
+
+/// Extracts the `bits` wide field at `shift` of every 32-bit lane and expands it to 8 bits
+template <int shift, int bits>
+__m128i ExpandField(__m128i pixels) {
+    const __m128i field =
+        _mm_and_si128(_mm_srli_epi32(pixels, shift), _mm_set1_epi32((1 << bits) - 1));
+    if constexpr (bits == 1) {
+        // Negating a single bit turns it into 0 or all ones
+        return _mm_and_si128(_mm_sub_epi32(_mm_setzero_si128(), field), _mm_set1_epi32(0xFF));
+    } else {
+        return _mm_or_si128(_mm_slli_epi32(field, 8 - bits), _mm_srli_epi32(field, 2 * bits - 8));
+    }
+}
+
+/// Extracts the 8-bit component `component` of every color and keeps its top `bits` bits
+template <int component, int bits>
+__m128i ReduceComponent(__m128i colors) {
+    return _mm_and_si128(_mm_srli_epi32(colors, component * 8 + 8 - bits),
+                         _mm_set1_epi32((1 << bits) - 1));
+}
+
+/// Packs 8-bit components held in 32-bit lanes into colors
+__m128i PackRGBA(__m128i r, __m128i g, __m128i b, __m128i a) {
+    return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                        _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+}
+
+/// Decodes four pixels of a 16-bit format, zero extended to 32-bit lanes
+template <PixelFormat format>
+__m128i Decode16BitPixels(__m128i pixels) {
+    if constexpr (format == PixelFormat::RGB565) {
+        return PackRGBA(ExpandField<11, 5>(pixels), ExpandField<5, 6>(pixels),
+                        ExpandField<0, 5>(pixels), _mm_set1_epi32(0xFF));
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        return PackRGBA(ExpandField<11, 5>(pixels), ExpandField<6, 5>(pixels),
+                        ExpandField<1, 5>(pixels), ExpandField<0, 1>(pixels));
+    } else {
+        static_assert(format == PixelFormat::RGBA4);
+        return PackRGBA(ExpandField<12, 4>(pixels), ExpandField<8, 4>(pixels),
+                        ExpandField<4, 4>(pixels), ExpandField<0, 4>(pixels));
+    }
+}
+
+/// Encodes four colors into a 16-bit format, leaving each pixel in the low half of its lane
+template <PixelFormat format>
+__m128i Encode16BitPixels(__m128i colors) {
+    if constexpr (format == PixelFormat::RGB565) {
+        return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ReduceComponent<0, 5>(colors), 11),
+                                         _mm_slli_epi32(ReduceComponent<1, 6>(colors), 5)),
+                            ReduceComponent<2, 5>(colors));
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ReduceComponent<0, 5>(colors), 11),
+                                         _mm_slli_epi32(ReduceComponent<1, 5>(colors), 6)),
+                            _mm_or_si128(_mm_slli_epi32(ReduceComponent<2, 5>(colors), 1),
+                                         ReduceComponent<3, 1>(colors)));
+    } else {
+        static_assert(format == PixelFormat::RGBA4);
+        return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ReduceComponent<0, 4>(colors), 12),
+                                         _mm_slli_epi32(ReduceComponent<1, 4>(colors), 8)),
+                            _mm_or_si128(_mm_slli_epi32(ReduceComponent<2, 4>(colors), 4),
+                                         ReduceComponent<3, 4>(colors)));
+    }
+}
+
+/// Narrows two vectors of 16-bit values held in 32-bit lanes into one vector of 16-bit values
+__m128i Narrow32To16(__m128i low, __m128i high) {
+    // packs saturates signed values, so sign extend the values to keep their bits unchanged
+    low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+    high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+    return _mm_packs_epi32(low, high);
+}
+#endif
+
+/// Decodes `count` consecutive pixels
+template <PixelFormat format>
+void DecodeRow(const u8* src, Common::Vec4<u8>* colors, u32 count) {
+    const u32 bytes_per_pixel = Regs::BytesPerPixel(format);
+    u32 x = 0;
+#ifdef ARCHITECTURE_x86_64
+    if constexpr (format == PixelFormat::RGBA8) {
+        for (; x + 4 <= count; x += 4) {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(colors + x), ByteSwap32(pixels));
+        }
+    } else if constexpr (format != PixelFormat::RGB8) {
+        for (; x + 4 <= count; x += 4) {
+            const __m128i pixels = _mm_unpacklo_epi16(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + x * 2)),
+                _mm_setzero_si128());
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(colors + x),
+                             Decode16BitPixels<format>(pixels));
+        }
+    }
+#endif
+    for (; x < count; ++x) {
+        colors[x] = DecodePixel<format>(src + x * bytes_per_pixel);
+    }
+}
+
+/// Encodes `count` colors into consecutive pixels
+template <PixelFormat format>
+void EncodeRow(const Common::Vec4<u8>* colors, u8* dst, u32 count) {
+    const u32 bytes_per_pixel = Regs::BytesPerPixel(format);
+    u32 x = 0;
+#ifdef ARCHITECTURE_x86_64
+    if constexpr (format == PixelFormat::RGBA8) {
+        for (; x + 4 <= count; x += 4) {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors + x));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), ByteSwap32(pixels));
+        }
+    } else if constexpr (format == PixelFormat::RGB8) {
+        const __m128i low_mask = _mm_set_epi32(0, -1, 0, -1);
+        for (; x + 4 <= count; x += 4) {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors + x));
+            // Swapping leaves the 24-bit BGR value of each pixel in the high bytes of its lane
+            const __m128i bgr = _mm_srli_epi32(ByteSwap32(pixels), 8);
+            // Join the pixels of each 64-bit half into six bytes, then the halves into twelve
+            const __m128i pairs = _mm_or_si128(
+                _mm_and_si128(bgr, low_mask), _mm_srli_epi64(_mm_andnot_si128(low_mask, bgr), 8));
+            const __m128i packed = _mm_or_si128(
+                _mm_unpacklo_epi64(pairs, _mm_setzero_si128()),
+                _mm_srli_si128(_mm_unpackhi_epi64(_mm_setzero_si128(), pairs), 2));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 3), packed);
+            const u32 tail = static_cast<u32>(_mm_cvtsi128_si32(_mm_srli_si128(packed, 8)));
+            std::memcpy(dst + x * 3 + 8, &tail, sizeof(tail));
+        }
+    } else {
+        for (; x + 8 <= count; x += 8) {
+            const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors + x));
+            const __m128i high =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors + x + 4));
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(dst + x * 2),
+                Narrow32To16(Encode16BitPixels<format>(low), Encode16BitPixels<format>(high)));
+        }
+    }
+#endif
+    for (; x < count; ++x) {
+        EncodePixel<format>(colors[x], dst + x * bytes_per_pixel);
+    }
+}
+
+/**
+ * Averages every horizontal pair of `row0`, and with `row1` the 2x2 blocks of both rows, into
+ * `count` output colors. This is the box filter of the ScaleX and ScaleXY modes.
+ */
+void DownscaleRow(const Common::Vec4<u8>* row0, const Common::Vec4<u8>* row1,
+                  Common::Vec4<u8>* out, u32 count) {
+    u32 x = 0;
+#ifdef ARCHITECTURE_x86_64
+    const __m128i zero = _mm_setzero_si128();
+    // Sums the pairs of four input colors, as 16-bit components
+    const auto SumPairs = [zero](const Common::Vec4<u8>* colors) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors));
+        const __m128i low = _mm_unpacklo_epi8(pixels, zero);
+        const __m128i high = _mm_unpackhi_epi8(pixels, zero);
+        return _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+    };
+    for (; x + 4 <= count; x += 4) {
+        __m128i first = SumPairs(row0 + x * 2);
+        __m128i second = SumPairs(row0 + x * 2 + 4);
+        if (row1 != nullptr) {
+            first = _mm_srli_epi16(_mm_add_epi16(first, SumPairs(row1 + x * 2)), 2);
+            second = _mm_srli_epi16(_mm_add_epi16(second, SumPairs(row1 + x * 2 + 4)), 2);
+        } else {
+            first = _mm_srli_epi16(first, 1);
+            second = _mm_srli_epi16(second, 1);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(first, second));
+    }
+#endif
+    for (; x < count; ++x) {
+        if (row1 != nullptr) {
+            out[x] = (((row0[x * 2] + row0[x * 2 + 1]) + (row1[x * 2] + row1[x * 2 + 1])) / 4)
+                         .Cast<u8>();
+        } else {
+            out[x] = ((row0[x * 2] + row0[x * 2 + 1]) / 2).Cast<u8>();
+        }
+    }
+}
+
+/**
+ * Copies the first `count` pixels of row y of a tiled image into consecutive memory. Pixels come
+ * in horizontal pairs in Morton order, so every copy moves two pixels.
+ */
+void GatherTiledRow(const u8* image, u32 stride, u32 y, u32 bytes_per_pixel, u32 count, u8* row) {
+    const u8* tile_row = image + (y & ~7) * stride;
+    for (u32 x = 0; x < count; x += 2) {
+        std::memcpy(row + x * bytes_per_pixel,
+                    tile_row + VideoCore::GetMortonOffset(x, y, bytes_per_pixel),
+                    std::min(2u, count - x) * bytes_per_pixel);
+    }
+}
+
+/// Copies `count` consecutive pixels into row y of a tiled image, the reverse of GatherTiledRow
+void ScatterTiledRow(const u8* row, u32 stride, u32 y, u32 bytes_per_pixel, u32 count, u8* image) {
+    u8* tile_row = image + (y & ~7) * stride;
+    for (u32 x = 0; x < count; x += 2) {
+        std::memcpy(tile_row + VideoCore::GetMortonOffset(x, y, bytes_per_pixel),
+                    row + x * bytes_per_pixel, std::min(2u, count - x) * bytes_per_pixel);
+    }
+}
+
+/**
+ * Performs the pixel conversion of a display transfer for the output rows [y_begin, y_end).
+ * Instantiated for every pair of pixel formats. Each row is gathered into consecutive memory if
+ * it is tiled, decoded, filtered and encoded a vector of pixels at a time, and scattered back if
+ * the output is tiled.
+ */
+template <PixelFormat input_format, PixelFormat output_format>
+void DisplayTransferRows(const Regs::DisplayTransferConfig& config, const u8* src_pointer,
+                         u8* dst_pointer, u32 output_width, u32 output_height, u32 y_begin,
+                         u32 y_end) {
+    const u32 src_bytes_per_pixel = Regs::BytesPerPixel(input_format);
+    const u32 dst_bytes_per_pixel = Regs::BytesPerPixel(output_format);
+
+    const int horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const int vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+
+    // A linear input is swizzled into a tiled output and the other way around, unless swizzling
+    // is disabled
+    const bool output_linear = config.input_linear == config.dont_swizzle;
+    const u32 src_stride = config.input_width * src_bytes_per_pixel;
+    const u32 dst_stride = output_width * dst_bytes_per_pixel;
+
+    const u32 input_count = output_width << horizontal_scale;
+    std::vector<u8> src_row(config.input_linear ? 0 : input_count * src_bytes_per_pixel);
+    std::vector<Common::Vec4<u8>> input_colors(input_count << vertical_scale);
+    std::vector<Common::Vec4<u8>> output_colors(horizontal_scale ? output_width : 0);
+    std::vector<u8> dst_row(output_linear ? 0 : dst_stride);
+
+    for (u32 y = y_begin; y < y_end; ++y) {
+        // Calculate the y position of the input image based on the current output position and
+        // the scale
+        const u32 input_y = y << vertical_scale;
+
+        // Flip the y value of the output data, we do this after calculating the y position of
+        // the input image to account for the scaling options.
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+        if constexpr (input_format == output_format) {
+            if (config.input_linear && config.dont_swizzle) {
+                // Both input and output are linear and scaling is rejected for linear input,
+                // so whole rows can be copied
+                std::memcpy(dst_pointer + output_y * dst_stride,
+                            src_pointer + input_y * src_stride, dst_stride);
+                continue;
+            }
+        }
+
+        for (int row = 0; row <= vertical_scale; ++row) {
+            const u8* src = src_pointer + (input_y + row) * src_stride;
+            if (!config.input_linear) {
+                GatherTiledRow(src_pointer, src_stride, input_y + row, src_bytes_per_pixel,
+                               input_count, src_row.data());
+                src = src_row.data();
+            }
+            DecodeRow<input_format>(src, input_colors.data() + row * input_count, input_count);
+        }
+
+        const Common::Vec4<u8>* colors = input_colors.data();
+        if (horizontal_scale) {
+            DownscaleRow(input_colors.data(),
+                         vertical_scale ? input_colors.data() + input_count : nullptr,
+                         output_colors.data(), output_width);
+            colors = output_colors.data();
+        }
+
+        if (output_linear) {
+            EncodeRow<output_format>(colors, dst_pointer + output_y * dst_stride, output_width);
+        } else {
+            EncodeRow<output_format>(colors, dst_row.data(), output_width);
+            ScatterTiledRow(dst_row.data(), dst_stride, output_y, dst_bytes_per_pixel,
+                            output_width, dst_pointer);
+        }
+    }
+}
+
+} // Anonymous namespace
+
+DisplayTransferRowsFunc GetDisplayTransferRows(PixelFormat input_format,
+                                               PixelFormat output_format) {
+    DisplayTransferRowsFunc convert_rows = nullptr;
+    DispatchPixelFormat(input_format, [&](auto input) {
+        DispatchPixelFormat(output_format, [&](auto output) {
+            convert_rows = &DisplayTransferRows<decltype(input)::value, decltype(output)::value>;
+        });
+    });
+    return convert_rows;
+}
+
+} // namespace GPU
@@ -0,0 +1,32 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "core/hw/gpu.h"
+
+namespace GPU {
+
+/**
+ * Converts the output rows [y_begin, y_end) of a software display transfer. Rows do not depend on
+ * each other, so disjoint row ranges may be converted concurrently.
+ * @param config Display transfer configuration, with a supported scaling mode
+ * @param src_pointer Pointer to the input image
+ * @param dst_pointer Pointer to the output image
+ * @param output_width Width of the output image in pixels, after scaling
+ * @param output_height Height of the output image in pixels, after scaling
+ */
+using DisplayTransferRowsFunc = void (*)(const Regs::DisplayTransferConfig& config,
+                                         const u8* src_pointer, u8* dst_pointer, u32 output_width,
+                                         u32 output_height, u32 y_begin, u32 y_end);
+
+/**
+ * Returns the row conversion function specialized for the given pair of pixel formats
+ * @return The conversion function, or nullptr if either format is unknown
+ */
+DisplayTransferRowsFunc GetDisplayTransferRows(Regs::PixelFormat input_format,
+                                               Regs::PixelFormat output_format);
+
+} // namespace GPU
@@ -2,18 +2,20 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
+#include <memory>
 #include <numeric>
-#include <type_traits>
+#include <thread>
 #include "common/alignment.h"
-#include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
-#include "common/vector_math.h"
+#include "common/thread_pool.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp.h"
+#include "core/hw/display_transfer.h"
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
@@ -22,7 +24,6 @@
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
-#include "video_core/utils.h"
 #include "video_core/video_core.h"
 
 namespace GPU {
@@ -49,32 +50,22 @@ inline void Read(T& var, const u32 raw_addr) {
     var = g_regs[addr / 4];
 }
 
-static Common::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
-    switch (input_format) {
-    case Regs::PixelFormat::RGBA8:
-        return Color::DecodeRGBA8(src_pixel);
-
-    case Regs::PixelFormat::RGB8:
-        return Color::DecodeRGB8(src_pixel);
-
-    case Regs::PixelFormat::RGB565:
-        return Color::DecodeRGB565(src_pixel);
-
-    case Regs::PixelFormat::RGB5A1:
-        return Color::DecodeRGB5A1(src_pixel);
-
-    case Regs::PixelFormat::RGBA4:
-        return Color::DecodeRGBA4(src_pixel);
+MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
+MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
 
-    default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", static_cast<u32>(input_format));
-        return {0, 0, 0, 0};
+/**
+ * Fills [start, start + size) with copies of the first pattern_size bytes at start, which have to
+ * be written already. The amount copied doubles every step, so large fills need few memcpy calls.
+ */
+static void ReplicatePattern(u8* start, std::size_t pattern_size, std::size_t size) {
+    std::size_t filled = pattern_size;
+    while (filled < size) {
+        const std::size_t copy_size = std::min(filled, size - filled);
+        std::memcpy(start + filled, start, copy_size);
+        filled += copy_size;
     }
 }
 
-MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
-MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
-
 static void MemoryFill(const Regs::MemoryFillConfig& config) {
     const PAddr start_addr = config.GetStartAddress();
     const PAddr end_addr = config.GetEndAddress();
@@ -101,29 +92,44 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
 
     Memory::RasterizerInvalidateRegion(start_addr,end_addr - start_addr);
 
+    const std::size_t size = end - start;
     if (config.fill_24bit) {
         // fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
+        start[0] = config.value_24bit_r;
+        start[1] = config.value_24bit_g;
+        start[2] = config.value_24bit_b;
+        ReplicatePattern(start, 3, Common::AlignUp(size, 3));
     } else if (config.fill_32bit) {
         // fill with 32-bit values
-        if (end > start) {
+        std::size_t len = size / sizeof(u32);
+        if (len > 0) {
             u32 value = config.value_32bit;
-            std::size_t len = (end - start) / sizeof(u32);
-            for (std::size_t i = 0; i < len; ++i)
-                memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
+            memcpy(start, &value, sizeof(u32));
+            ReplicatePattern(start, sizeof(u32), len * sizeof(u32));
         }
     } else {
         // fill with 16-bit values
         u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-            memcpy(ptr, &value_16bit, sizeof(u16));
+        memcpy(start, &value_16bit, sizeof(u16));
+        ReplicatePattern(start, sizeof(u16), Common::AlignUp(size, sizeof(u16)));
     }
 }
 
+/// Transfers with at least this many output pixels are split across the transfer thread pool
+constexpr u32 ParallelTransferMinPixels = 64 * 1024;
+
+/// Worker threads used for software display transfers, started by the first large transfer
+static std::unique_ptr<Common::ThreadPool> transfer_pool;
+
+static Common::ThreadPool& GetTransferPool() {
+    if (!transfer_pool) {
+        // The thread performing a parallel transfer takes part in it, so leave one core for it
+        const u32 num_threads = std::clamp(std::thread::hardware_concurrency(), 2u, 4u) - 1;
+        transfer_pool = std::make_unique<Common::ThreadPool>(num_threads, "GPU Transfer");
+    }
+    return *transfer_pool;
+}
+
 static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     const PAddr src_addr = config.GetPhysicalInputAddress();
     const PAddr dst_addr = config.GetPhysicalOutputAddress();
@@ -189,112 +195,25 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Common::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            u32 input_x = x << horizontal_scale;
-            u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
-            u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    u32 coarse_y = input_y & ~7;
-                    u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    u32 out_coarse_y = output_y & ~7;
-                    u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    u32 in_coarse_y = input_y & ~7;
-                    u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
-
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                Common::Vec4<u8> pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                Common::Vec4<u8> pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
-
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Regs::PixelFormat::RGBA8:
-                Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB8:
-                Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB565:
-                Color::EncodeRGB565(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB5A1:
-                Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGBA4:
-                Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
+    const DisplayTransferRowsFunc convert_rows =
+        GetDisplayTransferRows(config.input_format, config.output_format);
+    if (convert_rows == nullptr) {
+        LOG_ERROR(HW_GPU, "Unknown display transfer formats {:x} -> {:x}",
+                  static_cast<u32>(config.input_format.Value()),
+                  static_cast<u32>(config.output_format.Value()));
+        return;
+    }
 
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
-        }
+    // Split large transfers into bands of whole tile rows, which are converted in parallel
+    if (output_width * output_height >= ParallelTransferMinPixels) {
+        GetTransferPool().ParallelFor(
+            output_height, 8, [&](std::size_t y_begin, std::size_t y_end) {
+                convert_rows(config, src_pointer, dst_pointer, output_width, output_height,
+                             static_cast<u32>(y_begin), static_cast<u32>(y_end));
+            });
+    } else {
+        convert_rows(config, src_pointer, dst_pointer, output_width, output_height, 0,
+                     output_height);
     }
 }
 
@@ -353,6 +272,9 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
                                                       : Memory::RasterizerInvalidateRegion;
     FlushInvalidate_fn(config.GetPhysicalOutputAddress(), static_cast<u32>(contiguous_output_size));
 
+    // Texture copies move bytes without converting them, so unlike display transfers there is no
+    // per-pixel work to specialize or vectorize. Every run between gaps is a single memcpy, which
+    // is already vectorized and bound by memory bandwidth.
     u32 remaining_input = input_width;
     u32 remaining_output = output_width;
     while (remaining_size > 0) {
@@ -538,6 +460,7 @@ void Init(Memory::MemorySystem& memory) {
 
 /// Shutdown hardware
 void Shutdown() {
+    transfer_pool.reset();
     LOG_DEBUG(HW_GPU, "shutdown OK");
 }
 
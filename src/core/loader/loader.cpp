@@ -48,10 +48,11 @@ FileType GuessFromExtension(const std::string& extension_) {
     if (extension == ".elf" || extension == ".axf")
         return FileType::ELF;
 
-    if (extension == ".cci" || extension == ".3ds")
+    // Compressed images are decompressed transparently by IOFile and hold a plain NCSD/NCCH.
+    if (extension == ".cci" || extension == ".3ds" || extension == ".zcci")
         return FileType::CCI;
 
-    if (extension == ".cxi" || extension == ".app")
+    if (extension == ".cxi" || extension == ".app" || extension == ".zcxi")
         return FileType::CXI;
 
     if (extension == ".3dsx")
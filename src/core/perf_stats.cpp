@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <chrono>
 #include "core.h"
+#include "core/dumping/backend.h"
 #include "core/hw/gpu.h"
 #include "core/perf_stats.h"
 #include "core/settings.h"
@@ -17,7 +18,12 @@ using std::chrono::microseconds;
 namespace Core {
 
 void PerfStats::BeginSystemFrame() {
-    frame_limiter.DoFrameLimiting(System::GetInstance().CoreTiming().GetGlobalTimeUs());
+    auto& system = System::GetInstance();
+    // Offline dumps take their timestamps from emulated time, so render them as fast as possible.
+    if (Settings::values.offline_dumping && system.VideoDumper().IsDumping()) {
+        return;
+    }
+    frame_limiter.DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
 }
 
 void PerfStats::EndSystemFrame() {
@@ -42,6 +42,12 @@ public:
         double game_fps;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Number of times the audio sink ran out of buffered audio
+        u64 audio_underruns;
+        /// Number of times emulated audio was dropped because the sink FIFO was full
+        u64 audio_overruns;
+        /// Audio buffered ahead of the sink, in milliseconds
+        double audio_latency_ms;
     };
 
     void BeginSystemFrame();
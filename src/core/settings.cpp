@@ -25,6 +25,8 @@ void Apply() {
 
         system.DSP().SetSink(values.sink_id, values.audio_device_id);
         system.DSP().EnableStretching(values.enable_audio_stretching);
+        system.DSP().SetStretchMethod(values.audio_stretch_method);
+        system.DSP().SetTargetLatency(values.audio_target_latency);
 
         auto hid = Service::HID::GetModule(system);
         if (hid) {
@@ -74,6 +76,10 @@ void LogSettings() {
     LogSetting("Audio_EnableDspLleMultithread", Settings::values.enable_dsp_lle_multithread);
     LogSetting("Audio_OutputEngine", Settings::values.sink_id);
     LogSetting("Audio_EnableAudioStretching", Settings::values.enable_audio_stretching);
+    LogSetting("Audio_TargetLatency", Settings::values.audio_target_latency);
+    LogSetting("Audio_StretchMethod", static_cast<u32>(Settings::values.audio_stretch_method));
+    LogSetting("Audio_EnablePolyphaseInterpolation",
+               Settings::values.enable_polyphase_interpolation);
     LogSetting("Audio_OutputDevice", Settings::values.audio_device_id);
     LogSetting("Audio_InputDeviceType", static_cast<int>(Settings::values.mic_input_type));
     LogSetting("Audio_InputDevice", Settings::values.mic_input_device);
@@ -92,6 +98,7 @@ void LogSettings() {
     LogSetting("System_RegionValue", Settings::values.region_value);
     LogSetting("Debugging_UseGdbstub", Settings::values.use_gdbstub);
     LogSetting("Debugging_GdbstubPort", Settings::values.gdbstub_port);
+    LogSetting("VideoDumping_OfflineDumping", Settings::values.offline_dumping);
 }
 
 void SetFMVHack(bool enable) {
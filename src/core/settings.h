@@ -32,6 +32,11 @@ enum class MicInputType {
     Static,
 };
 
+enum class AudioStretchMethod : u32 {
+    SoundTouch = 0,
+    WSOLA = 1,
+};
+
 enum class AccurateMul {
     OFF = 0,
     FAST = 1,
@@ -181,9 +186,12 @@ struct Values {
 
     // Audio
     bool enable_dsp_lle;
-    bool dsp_lle_multithread;
+    bool enable_dsp_lle_multithread;
     std::string sink_id;
     bool enable_audio_stretching;
+    u32 audio_target_latency;
+    AudioStretchMethod audio_stretch_method;
+    bool enable_polyphase_interpolation;
     std::string audio_device_id;
     float audio_volume;
     float mic_volume;
@@ -233,6 +241,9 @@ struct Values {
     std::string web_api_url;
     std::string citra_username;
     std::string citra_token;
+
+    // Video Dumping
+    bool offline_dumping;
 } extern values;
 
 // a special value for Values::region_value indicating that citra will automatically select a region
@@ -0,0 +1,187 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/compressed_file.h"
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/scm_rev.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <input> [output]\n"
+                 "Compresses a .cci/.3ds/.cxi image into a .zcci/.zcxi image, or the reverse.\n"
+                 "-d, --decompress   Decompress <input> into [output]\n"
+                 "-b, --block-size   Block size in KiB used when compressing (default 64)\n"
+                 "-B, --benchmark    Measure sequential and random read throughput of <input>\n"
+                 "-h, --help         Display this help and exit\n"
+                 "-v, --version      Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra image compressor " << Common::g_scm_branch << " " << Common::g_scm_desc
+              << std::endl;
+}
+
+static std::string DefaultOutputPath(const std::string& input, bool decompress) {
+    const auto dot = input.find_last_of('.');
+    const std::string stem = dot == std::string::npos ? input : input.substr(0, dot);
+    const std::string extension = dot == std::string::npos ? "" : input.substr(dot);
+    if (decompress) {
+        return stem + (extension == ".zcxi" ? ".cxi" : ".cci");
+    }
+    return stem + (extension == ".cxi" || extension == ".app" ? ".zcxi" : ".zcci");
+}
+
+static void PrintProgress(u64 done, u64 total) {
+    std::cout << "\r" << (total == 0 ? 100 : done * 100 / total) << "%" << std::flush;
+}
+
+static bool Decompress(FileUtil::IOFile& input, FileUtil::IOFile& output) {
+    const u64 total = input.GetSize();
+    std::vector<u8> buffer(0x100000);
+    for (u64 done = 0; done < total;) {
+        const auto length =
+            static_cast<std::size_t>(std::min<u64>(buffer.size(), total - done));
+        if (input.ReadBytes(buffer.data(), length) != length ||
+            output.WriteBytes(buffer.data(), length) != length) {
+            return false;
+        }
+        done += length;
+        PrintProgress(done, total);
+    }
+    return true;
+}
+
+/// Reads the whole (decompressed) image sequentially, then in random 16 KiB chunks as a game
+/// streaming assets would.
+static void Benchmark(FileUtil::IOFile& input) {
+    using Clock = std::chrono::steady_clock;
+    const u64 total = input.GetSize();
+    std::vector<u8> buffer(0x100000);
+
+    const auto report = [](const char* name, u64 bytes, Clock::duration elapsed) {
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+        std::cout << name << ": " << bytes / (1024.0 * 1024.0) / seconds << " MiB/s\n";
+    };
+
+    auto start = Clock::now();
+    for (u64 offset = 0; offset < total; offset += buffer.size()) {
+        input.ReadBytesAt(buffer.data(), buffer.size(), offset);
+    }
+    report("Sequential", total, Clock::now() - start);
+
+    constexpr std::size_t chunk_size = 0x4000;
+    constexpr int chunk_count = 4096;
+    std::mt19937_64 rng(0);
+    std::uniform_int_distribution<u64> offset_dist(0, total > chunk_size ? total - chunk_size : 0);
+    start = Clock::now();
+    for (int i = 0; i < chunk_count; i++) {
+        input.ReadBytesAt(buffer.data(), chunk_size, offset_dist(rng));
+    }
+    report("Random 16 KiB", u64{chunk_size} * chunk_count, Clock::now() - start);
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    int option_index = 0;
+    bool decompress = false;
+    bool benchmark = false;
+    u32 block_size = FileUtil::default_compressed_block_size;
+
+    static struct option long_options[] = {
+        {"decompress", no_argument, 0, 'd'},
+        {"block-size", required_argument, 0, 'b'},
+        {"benchmark", no_argument, 0, 'B'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    int arg;
+    while ((arg = getopt_long(argc, argv, "db:Bhv", long_options, &option_index)) != -1) {
+        switch (static_cast<char>(arg)) {
+        case 'd':
+            decompress = true;
+            break;
+        case 'b':
+            block_size = static_cast<u32>(std::strtoul(optarg, nullptr, 0) * 1024);
+            break;
+        case 'B':
+            benchmark = true;
+            break;
+        case 'h':
+            PrintHelp(argv[0]);
+            return 0;
+        case 'v':
+            PrintVersion();
+            return 0;
+        }
+    }
+
+    const std::vector<std::string> paths(argv + optind, argv + argc);
+    if (paths.empty() || paths.size() > 2) {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    Log::Filter log_filter(Log::Level::Warning);
+    Log::SetGlobalFilter(log_filter);
+    Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+
+    FileUtil::IOFile input(paths[0], "rb");
+    if (!input.IsOpen()) {
+        std::cout << "Could not open " << paths[0] << "\n";
+        return -1;
+    }
+
+    if (benchmark) {
+        Benchmark(input);
+        return 0;
+    }
+
+    if (decompress != FileUtil::IsCompressedImagePath(paths[0])) {
+        std::cout << paths[0] << (decompress ? " is not" : " is already")
+                  << " a compressed image\n";
+        return -1;
+    }
+
+    const std::string output_path =
+        paths.size() == 2 ? paths[1] : DefaultOutputPath(paths[0], decompress);
+    FileUtil::IOFile output(output_path, "wb");
+    if (!output.IsOpen()) {
+        std::cout << "Could not create " << output_path << "\n";
+        return -1;
+    }
+
+    const bool success = decompress
+                             ? Decompress(input, output)
+                             : FileUtil::CompressImage(input, output, block_size, PrintProgress);
+    std::cout << "\n";
+    if (!success) {
+        std::cout << "Failed to write " << output_path << "\n";
+        output.Close();
+        FileUtil::Delete(output_path);
+        return -1;
+    }
+
+    output.Close();
+    std::cout << paths[0] << " (" << input.GetSize() << " bytes) -> " << output_path << " ("
+              << FileUtil::GetSize(output_path) << " bytes)\n";
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/audio_fifo.h"
+#include "audio_core/audio_types.h"
+
+namespace {
+
+constexpr std::size_t target_frames = 1600;
+constexpr std::size_t callback_frames = 512;
+
+struct SimulationResult {
+    AudioCore::AudioFifo::Stats stats;
+    double mean_occupancy;
+};
+
+/**
+ * Stands in for a null sink driven by its own clock: the DSP produces 160-frame audio frames at
+ * the native rate scaled by producer_skew, while the sink pulls callback_frames at a time at the
+ * native rate. Occupancy is averaged once the controller has had time to settle.
+ */
+SimulationResult Simulate(double producer_skew, double seconds) {
+    AudioCore::AudioFifo fifo;
+    fifo.SetTargetLatency(target_frames);
+
+    const double producer_period = AudioCore::samples_per_frame /
+                                   (AudioCore::native_sample_rate * producer_skew);
+    const double consumer_period =
+        static_cast<double>(callback_frames) / AudioCore::native_sample_rate;
+
+    std::vector<s16> frame(AudioCore::samples_per_frame * 2);
+    std::vector<s16> output(callback_frames * 2);
+    double next_produce = 0.0;
+    double next_consume = consumer_period;
+    s16 counter = 0;
+
+    SimulationResult result{};
+    double occupancy_sum = 0.0;
+    std::size_t occupancy_samples = 0;
+    while (next_consume < seconds) {
+        if (next_produce <= next_consume) {
+            for (auto& sample : frame) {
+                sample = counter++;
+            }
+            fifo.Push(frame.data(), AudioCore::samples_per_frame);
+            next_produce += producer_period;
+            continue;
+        }
+
+        if (next_consume > seconds / 2) {
+            occupancy_sum += static_cast<double>(fifo.Size());
+            occupancy_samples++;
+        }
+        fifo.PopCorrected(output.data(), callback_frames);
+        next_consume += consumer_period;
+
+        if (next_consume > seconds / 2 && next_consume - consumer_period <= seconds / 2) {
+            // Discard the counters accumulated while the buffer was filling up.
+            fifo.GetAndResetStats();
+        }
+    }
+
+    result.stats = fifo.GetAndResetStats();
+    result.mean_occupancy = occupancy_sum / occupancy_samples;
+    return result;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AudioFifo keeps occupancy near the target under clock skew", "[audio_core]") {
+    for (const double skew : {0.997, 1.0, 1.003}) {
+        const SimulationResult result = Simulate(skew, 120.0);
+
+        INFO("skew = " << skew);
+        REQUIRE(result.stats.underruns == 0);
+        REQUIRE(result.stats.overruns == 0);
+        REQUIRE(result.stats.frames_dropped == 0);
+        // The controller is purely proportional, so skew leaves a small steady-state offset.
+        REQUIRE(std::abs(result.mean_occupancy - target_frames) < target_frames / 8.0);
+        REQUIRE(std::abs(result.stats.playback_ratio - skew) < 0.001);
+    }
+}
+
+TEST_CASE("AudioFifo reports underruns and overruns beyond its correction range", "[audio_core]") {
+    const SimulationResult slow = Simulate(0.95, 20.0);
+    REQUIRE(slow.stats.underruns > 0);
+    REQUIRE(slow.stats.playback_ratio ==
+            Approx(1.0 - AudioCore::AudioFifo::max_drift_correction));
+
+    AudioCore::AudioFifo fifo;
+    std::vector<s16> frames(AudioCore::AudioFifo::capacity * 2 + 20);
+    REQUIRE(fifo.Push(frames.data(), frames.size() / 2) == AudioCore::AudioFifo::capacity);
+    const AudioCore::AudioFifo::Stats stats = fifo.GetAndResetStats();
+    REQUIRE(stats.overruns == 1);
+    REQUIRE(stats.frames_dropped == 10);
+    REQUIRE(stats.occupancy == AudioCore::AudioFifo::capacity);
+}
+
+TEST_CASE("AudioFifo interpolates between buffered frames", "[audio_core]") {
+    AudioCore::AudioFifo fifo;
+    fifo.SetTargetLatency(callback_frames);
+
+    std::vector<s16> input(callback_frames * 4 * 2);
+    for (std::size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<s16>(i);
+    }
+    REQUIRE(fifo.Push(input.data(), input.size() / 2) == input.size() / 2);
+
+    // The first call reads slowly while the occupancy estimate settles, so only check that the
+    // output interpolates between neighbouring input frames. The first few frames are still
+    // interpolating from silence.
+    std::vector<s16> output(callback_frames * 2);
+    REQUIRE(fifo.PopCorrected(output.data(), callback_frames) == callback_frames);
+    for (std::size_t i = 8; i < output.size(); i += 2) {
+        REQUIRE(output[i + 1] - output[i] == 1);
+        REQUIRE(output[i] >= output[i - 2]);
+        REQUIRE(output[i] - output[i - 2] <= 2);
+    }
+}
@@ -0,0 +1,211 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/codec.h"
+
+namespace {
+
+using AudioCore::StereoBuffer16;
+
+// Straightforward per-sample decoders that the chunked and vectorized ones must match exactly.
+
+StereoBuffer16 ReferenceDecodeADPCM(const u8* data, std::size_t sample_count,
+                                    const std::array<s16, 16>& adpcm_coeff,
+                                    AudioCore::Codec::ADPCMState& state) {
+    constexpr std::array<int, 16> signed_nibbles = {
+        {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
+
+    StereoBuffer16 ret(sample_count % 2 == 0 ? sample_count : sample_count + 1);
+    int yn1 = state.yn1, yn2 = state.yn2;
+    for (std::size_t i = 0; i < ret.size(); i++) {
+        const u8* frame = data + (i / 14) * 8;
+        const int scale = 1 << (frame[0] & 0xF);
+        const int idx = (frame[0] >> 4) & 0x7;
+        const u8 byte = frame[1 + (i % 14) / 2];
+        const int nibble = signed_nibbles[i % 2 == 0 ? byte >> 4 : byte & 0xF];
+        int val = (((nibble * scale) << 11) + 0x400 + adpcm_coeff[idx * 2] * yn1 +
+                   adpcm_coeff[idx * 2 + 1] * yn2) >>
+                  11;
+        val = std::clamp(val, -32768, 32767);
+        yn2 = yn1;
+        yn1 = val;
+        ret[i].fill(static_cast<s16>(val));
+    }
+    state.yn1 = static_cast<s16>(yn1);
+    state.yn2 = static_cast<s16>(yn2);
+    return ret;
+}
+
+StereoBuffer16 ReferenceDecodePCM8(unsigned num_channels, const u8* data,
+                                   std::size_t sample_count) {
+    StereoBuffer16 ret(sample_count);
+    for (std::size_t i = 0; i < sample_count; i++) {
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const u8 sample = data[i * num_channels + (num_channels == 2 ? channel : 0)];
+            ret[i][channel] = static_cast<s16>(static_cast<u16>(sample) << 8);
+        }
+    }
+    return ret;
+}
+
+StereoBuffer16 ReferenceDecodePCM16(unsigned num_channels, const u8* data,
+                                    std::size_t sample_count) {
+    StereoBuffer16 ret(sample_count);
+    for (std::size_t i = 0; i < sample_count; i++) {
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const std::size_t index = i * num_channels + (num_channels == 2 ? channel : 0);
+            std::memcpy(&ret[i][channel], data + index * sizeof(s16), sizeof(s16));
+        }
+    }
+    return ret;
+}
+
+std::vector<u8> RandomBytes(std::size_t size, u32 seed) {
+    std::mt19937 rng(seed);
+    std::vector<u8> bytes(size);
+    std::generate(bytes.begin(), bytes.end(), [&rng] { return static_cast<u8>(rng()); });
+    return bytes;
+}
+
+constexpr std::array<std::size_t, 9> sample_counts = {0, 1, 13, 14, 15, 160, 255, 257, 4099};
+
+} // Anonymous namespace
+
+TEST_CASE("Codec::DecodeADPCM matches reference", "[audio_core]") {
+    const std::array<s16, 16> coeffs = {{0x0400, -0x0200, 0x0800, -0x0400, 0x0C00, -0x0600,
+                                         0x0FFF, -0x07FF, 0x0100, 0x0000, -0x0100, 0x0080,
+                                         0x07FF, 0x07FF, -0x0800, -0x0800}};
+
+    for (const std::size_t sample_count : sample_counts) {
+        const std::size_t num_frames = (sample_count + 13) / 14;
+        const std::vector<u8> data = RandomBytes(num_frames * 8, static_cast<u32>(sample_count));
+
+        AudioCore::Codec::ADPCMState state{1234, -4321};
+        AudioCore::Codec::ADPCMState reference_state = state;
+
+        const StereoBuffer16 decoded =
+            AudioCore::Codec::DecodeADPCM(data.data(), sample_count, coeffs, state);
+        const StereoBuffer16 expected =
+            ReferenceDecodeADPCM(data.data(), sample_count, coeffs, reference_state);
+
+        INFO("sample_count = " << sample_count);
+        REQUIRE(decoded == expected);
+        REQUIRE(state.yn1 == reference_state.yn1);
+        REQUIRE(state.yn2 == reference_state.yn2);
+    }
+}
+
+TEST_CASE("Codec::DecodeADPCM reads no further than the last sample", "[audio_core]") {
+    const std::array<s16, 16> coeffs = {{0x0400, -0x0200, 0x0800, -0x0400}};
+
+    for (const std::size_t sample_count : sample_counts) {
+        // Every byte after the nibble of the last decoded sample is left out of the buffer, so
+        // that reading past it is caught by the address sanitizer.
+        const std::size_t decoded_count = sample_count + sample_count % 2;
+        const std::size_t partial_samples = decoded_count % 14;
+        const std::size_t size =
+            decoded_count / 14 * 8 + (partial_samples != 0 ? 1 + partial_samples / 2 : 0);
+        const std::vector<u8> data = RandomBytes(size, static_cast<u32>(sample_count));
+        // Keep the bytes on the heap at exactly this size.
+        const auto bytes = std::make_unique<u8[]>(size);
+        std::copy(data.begin(), data.end(), bytes.get());
+
+        AudioCore::Codec::ADPCMState state{0, 0};
+        AudioCore::Codec::ADPCMState reference_state = state;
+
+        INFO("sample_count = " << sample_count);
+        REQUIRE(AudioCore::Codec::DecodeADPCM(bytes.get(), sample_count, coeffs, state) ==
+                ReferenceDecodeADPCM(bytes.get(), sample_count, coeffs, reference_state));
+    }
+}
+
+TEST_CASE("Codec::DecodeADPCM known output", "[audio_core]") {
+    // Scale 1 << 2, coefficient pair 0: y[n] = x[n] + y[n-1] (0x800 == 1.0)
+    const std::array<u8, 8> frame = {{0x02, 0x1F, 0x70, 0x80, 0x00, 0x00, 0x00, 0x00}};
+    std::array<s16, 16> coeffs{};
+    coeffs[0] = 0x800;
+
+    AudioCore::Codec::ADPCMState state{0, 0};
+    const StereoBuffer16 decoded = AudioCore::Codec::DecodeADPCM(frame.data(), 6, coeffs, state);
+
+    const std::array<s16, 6> expected = {{4, 0, 28, 28, -4, -4}};
+    REQUIRE(decoded.size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); i++) {
+        REQUIRE(decoded[i][0] == expected[i]);
+        REQUIRE(decoded[i][1] == expected[i]);
+    }
+    REQUIRE(state.yn1 == -4);
+    REQUIRE(state.yn2 == -4);
+}
+
+TEST_CASE("Codec::DecodePCM8 matches reference", "[audio_core]") {
+    for (const unsigned num_channels : {1u, 2u}) {
+        for (const std::size_t sample_count : sample_counts) {
+            const std::vector<u8> data =
+                RandomBytes(sample_count * num_channels, static_cast<u32>(sample_count));
+
+            INFO("num_channels = " << num_channels << ", sample_count = " << sample_count);
+            REQUIRE(AudioCore::Codec::DecodePCM8(num_channels, data.data(), sample_count) ==
+                    ReferenceDecodePCM8(num_channels, data.data(), sample_count));
+        }
+    }
+}
+
+TEST_CASE("Codec::DecodePCM16 matches reference", "[audio_core]") {
+    for (const unsigned num_channels : {1u, 2u}) {
+        for (const std::size_t sample_count : sample_counts) {
+            const std::vector<u8> data = RandomBytes(sample_count * num_channels * sizeof(s16),
+                                                     static_cast<u32>(sample_count));
+
+            INFO("num_channels = " << num_channels << ", sample_count = " << sample_count);
+            REQUIRE(AudioCore::Codec::DecodePCM16(num_channels, data.data(), sample_count) ==
+                    ReferenceDecodePCM16(num_channels, data.data(), sample_count));
+        }
+    }
+}
+
+TEST_CASE("Codec decode throughput", "[.][benchmark]") {
+    const std::array<s16, 16> coeffs = {{0x0400, -0x0200, 0x0800, -0x0400, 0x0C00, -0x0600,
+                                         0x0FFF, -0x07FF, 0x0100, 0x0000, -0x0100, 0x0080,
+                                         0x07FF, 0x07FF, -0x0800, -0x0800}};
+    constexpr std::size_t sample_count = 14 * 1024;
+    constexpr int iterations = 200;
+    const std::vector<u8> data = RandomBytes(sample_count * 4, 1234);
+
+    const auto Measure = [&](const char* name, auto&& decode) {
+        std::size_t decoded = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            decoded += decode().size();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << decoded / elapsed.count() / 1e6 << " Msamples/s\n";
+    };
+
+    Measure("ADPCM reference", [&] {
+        AudioCore::Codec::ADPCMState state{0, 0};
+        return ReferenceDecodeADPCM(data.data(), sample_count, coeffs, state);
+    });
+    Measure("ADPCM", [&] {
+        AudioCore::Codec::ADPCMState state{0, 0};
+        return AudioCore::Codec::DecodeADPCM(data.data(), sample_count, coeffs, state);
+    });
+    Measure("PCM8 mono reference",
+            [&] { return ReferenceDecodePCM8(1, data.data(), sample_count); });
+    Measure("PCM8 mono",
+            [&] { return AudioCore::Codec::DecodePCM8(1, data.data(), sample_count); });
+    Measure("PCM16 stereo reference",
+            [&] { return ReferenceDecodePCM16(2, data.data(), sample_count); });
+    Measure("PCM16 stereo",
+            [&] { return AudioCore::Codec::DecodePCM16(2, data.data(), sample_count); });
+}
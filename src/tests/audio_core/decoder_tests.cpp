@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 #if defined(HAVE_MF) || defined(HAVE_FFMPEG)
 
+#include <cstring>
+#include <vector>
 #include <catch2/catch.hpp>
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -51,4 +53,51 @@ TEST_CASE("DSP HLE Audio Decoder", "[audio_core]") {
     }
 }
 
+TEST_CASE("DSP HLE Audio Decoder output does not depend on decoding ahead", "[audio_core]") {
+    constexpr u32 num_frames = 8;
+    // Decodes the fixture frame repeated num_frames times, placed frame_stride bytes apart
+    const auto DecodeStream = [](u32 frame_stride) {
+        Memory::MemorySystem memory;
+        auto decoder =
+#ifdef HAVE_MF
+            std::make_unique<AudioCore::HLE::WMFDecoder>(memory);
+#elif HAVE_FFMPEG
+            std::make_unique<AudioCore::HLE::FFMPEGDecoder>(memory);
+#endif
+        AudioCore::HLE::BinaryRequest request{};
+        request.codec = AudioCore::HLE::DecoderCodec::AAC;
+        request.cmd = AudioCore::HLE::DecoderCommand::Init;
+        REQUIRE(decoder->ProcessRequest(request));
+
+        u8* fcram = memory.GetFCRAMPointer(0);
+        for (u32 i = 0; i < num_frames; i++) {
+            std::memcpy(fcram + i * frame_stride, fixure_buffer, fixure_buffer_size);
+        }
+
+        std::vector<std::vector<u8>> output;
+        request.cmd = AudioCore::HLE::DecoderCommand::Decode;
+        request.size = fixure_buffer_size;
+        request.dst_addr_ch0 = Memory::FCRAM_PADDR + 0x100000;
+        request.dst_addr_ch1 = Memory::FCRAM_PADDR + 0x200000;
+        for (u32 i = 0; i < num_frames; i++) {
+            request.src_addr = Memory::FCRAM_PADDR + i * frame_stride;
+            const auto response = decoder->ProcessRequest(request);
+            REQUIRE(response);
+            const u32 num_bytes = response->num_samples * sizeof(s16);
+            for (u32 channel = 0; channel < response->num_channels; channel++) {
+                const u8* samples = fcram + (channel == 0 ? 0x100000 : 0x200000);
+                output.emplace_back(samples, samples + num_bytes);
+            }
+        }
+        return output;
+    };
+
+    // Back-to-back ADTS frames are decoded ahead. Frames separated by zeros are not predicted,
+    // so each one is decoded when it is requested.
+    const auto decoded_ahead = DecodeStream(fixure_buffer_size);
+    const auto decoded_on_request = DecodeStream(0x1000);
+    REQUIRE(!decoded_ahead.empty());
+    REQUIRE(decoded_ahead == decoded_on_request);
+}
+
 #endif
@@ -0,0 +1,170 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <SoundTouch.h>
+#include <catch2/catch.hpp>
+#include "audio_core/interpolate.h"
+
+namespace {
+
+using AudioCore::StereoBuffer16;
+using AudioCore::StereoFrame16;
+
+StereoBuffer16 SineBuffer(std::size_t size, double period, double amplitude) {
+    StereoBuffer16 buffer(size);
+    for (std::size_t i = 0; i < size; i++) {
+        const auto sample =
+            static_cast<s16>(amplitude * std::sin(2.0 * 3.14159265358979 * i / period));
+        buffer[i] = {sample, static_cast<s16>(-sample)};
+    }
+    return buffer;
+}
+
+/// Resamples buffers the way Source does, until the output frame is full or input runs out.
+std::size_t Resample(AudioCore::AudioInterp::State& state, std::vector<StereoBuffer16> buffers,
+                     float rate, StereoFrame16& output) {
+    std::size_t outputi = 0;
+    for (auto& buffer : buffers) {
+        while (outputi < output.size() && !buffer.empty()) {
+            AudioCore::AudioInterp::Polyphase(state, buffer, rate, output, outputi);
+        }
+    }
+    return outputi;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AudioInterp::Polyphase passes DC", "[audio_core]") {
+    for (const float rate : {0.5f, 1.0f, 1.3f, 2.0f, 5.0f}) {
+        AudioCore::AudioInterp::State state{};
+        StereoBuffer16 input(2000, {{1000, -1000}});
+        StereoFrame16 output{};
+        std::size_t outputi = 0;
+        AudioCore::AudioInterp::Polyphase(state, input, rate, output, outputi);
+
+        INFO("rate = " << rate);
+        REQUIRE(outputi == output.size());
+        // Skip the predelay, where the filter still sees the zeroed history.
+        const auto predelay =
+            static_cast<std::size_t>(std::ceil(AudioCore::AudioInterp::polyphase_taps / rate));
+        for (std::size_t i = predelay; i < output.size(); i++) {
+            REQUIRE(std::abs(output[i][0] - 1000) <= 2);
+            REQUIRE(std::abs(output[i][1] + 1000) <= 2);
+        }
+    }
+}
+
+TEST_CASE("AudioInterp::Polyphase consumes input at the given rate", "[audio_core]") {
+    AudioCore::AudioInterp::State state{};
+    StereoBuffer16 input(1000);
+    StereoFrame16 output{};
+    std::size_t outputi = 0;
+    AudioCore::AudioInterp::Polyphase(state, input, 1.5f, output, outputi);
+
+    REQUIRE(outputi == output.size());
+    REQUIRE(input.size() == 1000 - 240);
+    REQUIRE(state.fposition == 0);
+}
+
+TEST_CASE("AudioInterp::Polyphase is independent of buffer boundaries", "[audio_core]") {
+    const StereoBuffer16 sine = SineBuffer(400, 37.0, 12000.0);
+    for (const float rate : {0.75f, 1.0f, 1.7f}) {
+        AudioCore::AudioInterp::State whole_state{};
+        StereoFrame16 whole{};
+        const std::size_t whole_count = Resample(whole_state, {sine}, rate, whole);
+
+        AudioCore::AudioInterp::State split_state{};
+        StereoFrame16 split{};
+        const std::size_t split_count =
+            Resample(split_state,
+                     {StereoBuffer16(sine.begin(), sine.begin() + 3),
+                      StereoBuffer16(sine.begin() + 3, sine.begin() + 101),
+                      StereoBuffer16(sine.begin() + 101, sine.end())},
+                     rate, split);
+
+        INFO("rate = " << rate);
+        REQUIRE(whole_count == split_count);
+        REQUIRE(whole == split);
+    }
+}
+
+TEST_CASE("AudioInterp::Polyphase preserves passband amplitude", "[audio_core]") {
+    const StereoBuffer16 sine = SineBuffer(1000, 40.0, 16000.0);
+    AudioCore::AudioInterp::State state{};
+    StereoFrame16 output{};
+    REQUIRE(Resample(state, {sine}, 1.0f, output) == output.size());
+
+    double energy = 0.0;
+    for (std::size_t i = 40; i < 160; i++) {
+        energy += static_cast<double>(output[i][0]) * output[i][0];
+    }
+    const double rms = std::sqrt(energy / 120.0);
+    REQUIRE(rms == Approx(16000.0 / std::sqrt(2.0)).epsilon(0.03));
+}
+
+TEST_CASE("Resampling throughput", "[.][benchmark]") {
+    constexpr std::size_t input_size = 32000;
+    constexpr int iterations = 20;
+    const StereoBuffer16 sine = SineBuffer(input_size, 37.0, 12000.0);
+
+    const auto Measure = [&](const char* name, float rate, auto&& resample) {
+        std::size_t produced = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            produced += resample(rate);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "rate " << rate << " " << name << ": "
+                  << static_cast<double>(input_size) * iterations / elapsed.count() / 1e6
+                  << " Msamples/s (" << produced / iterations << " produced)\n";
+    };
+
+    const auto Interpolate = [&](auto interp) {
+        return [&sine, interp](float rate) {
+            AudioCore::AudioInterp::State state{};
+            StereoBuffer16 input = sine;
+            StereoFrame16 output{};
+            std::size_t produced = 0;
+            while (!input.empty()) {
+                std::size_t outputi = 0;
+                interp(state, input, rate, output, outputi);
+                produced += outputi;
+            }
+            return produced;
+        };
+    };
+
+    // SoundTouch's rate transposer, fed interleaved blocks the way TimeStretcher feeds it
+    std::vector<s16> interleaved;
+    for (const auto& sample : sine) {
+        interleaved.insert(interleaved.end(), sample.begin(), sample.end());
+    }
+    const auto TransposeWithSoundTouch = [&interleaved](float rate) {
+        soundtouch::SoundTouch sound_touch;
+        sound_touch.setChannels(2);
+        sound_touch.setSampleRate(AudioCore::native_sample_rate);
+        sound_touch.setRate(rate);
+        std::array<s16, 2 * 160> output;
+        std::size_t produced = 0;
+        for (std::size_t frame = 0; frame < input_size; frame += 160) {
+            sound_touch.putSamples(interleaved.data() + frame * 2, 160);
+            while (const u32 received = sound_touch.receiveSamples(output.data(), 160)) {
+                produced += received;
+            }
+        }
+        return produced;
+    };
+
+    for (const float rate : {0.75f, 1.7f}) {
+        Measure("linear", rate, Interpolate(AudioCore::AudioInterp::Linear));
+        Measure("polyphase", rate, Interpolate(AudioCore::AudioInterp::Polyphase));
+        Measure("SoundTouch", rate, TransposeWithSoundTouch);
+    }
+}
@@ -0,0 +1,165 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <catch2/catch.hpp>
+#include "audio_core/mix.h"
+
+namespace {
+
+using AudioCore::QuadFrame32;
+using AudioCore::StereoFrame16;
+
+s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+StereoFrame16 RandomStereoFrame(std::mt19937& rng) {
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    StereoFrame16 frame;
+    for (auto& sample : frame) {
+        sample = {static_cast<s16>(dist(rng)), static_cast<s16>(dist(rng))};
+    }
+    return frame;
+}
+
+QuadFrame32 RandomQuadFrame(std::mt19937& rng, s32 range) {
+    std::uniform_int_distribution<s32> dist(-range, range);
+    QuadFrame32 frame;
+    for (auto& sample : frame) {
+        for (auto& channel : sample) {
+            channel = dist(rng);
+        }
+    }
+    return frame;
+}
+
+// Straightforward per-sample mixes that the vectorized ones must match exactly.
+
+void ReferenceMixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                                const std::array<float, 4>& gains) {
+    for (std::size_t i = 0; i < source.size(); i++) {
+        dest[i][0] += static_cast<s32>(gains[0] * source[i][0]);
+        dest[i][1] += static_cast<s32>(gains[1] * source[i][1]);
+        dest[i][2] += static_cast<s32>(gains[2] * source[i][0]);
+        dest[i][3] += static_cast<s32>(gains[3] * source[i][1]);
+    }
+}
+
+void ReferenceDownmixQuadIntoStereo(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    for (std::size_t i = 0; i < source.size(); i++) {
+        const s16 left = ClampToS16(static_cast<s32>(gain * source[i][0] + gain * source[i][2]));
+        const s16 right = ClampToS16(static_cast<s32>(gain * source[i][1] + gain * source[i][3]));
+        dest[i][0] = ClampToS16(dest[i][0] + left);
+        dest[i][1] = ClampToS16(dest[i][1] + right);
+    }
+}
+
+void ReferenceDownmixQuadIntoMono(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    for (std::size_t i = 0; i < source.size(); i++) {
+        const float sum = gain * source[i][0] + gain * source[i][1] + gain * source[i][2] +
+                          gain * source[i][3];
+        const s16 mono = ClampToS16(static_cast<s32>(sum / 2));
+        dest[i][0] = ClampToS16(dest[i][0] + mono);
+        dest[i][1] = ClampToS16(dest[i][1] + mono);
+    }
+}
+
+// Gains include values that push the downmix well past the s16 range to exercise saturation.
+constexpr std::array<float, 6> test_gains = {{0.0f, 0.25f, 0.7071f, 1.0f, 1.5f, 3.9f}};
+
+} // Anonymous namespace
+
+TEST_CASE("Mix::MixStereoIntoQuad matches reference", "[audio_core]") {
+    std::mt19937 rng(0x3D5);
+    for (const float gain : test_gains) {
+        const std::array<float, 4> gains = {{gain, gain * 0.5f, -gain, 1.0f - gain}};
+        const StereoFrame16 source = RandomStereoFrame(rng);
+        QuadFrame32 dest = RandomQuadFrame(rng, 1 << 20);
+
+        QuadFrame32 expected = dest;
+        ReferenceMixStereoIntoQuad(expected, source, gains);
+
+        AudioCore::Mix::MixStereoIntoQuad(dest, source, gains);
+        INFO("gain = " << gain);
+        REQUIRE(dest == expected);
+    }
+}
+
+TEST_CASE("Mix::DownmixQuadIntoStereo matches reference", "[audio_core]") {
+    std::mt19937 rng(0x3D6);
+    for (const float gain : test_gains) {
+        const QuadFrame32 source = RandomQuadFrame(rng, 1 << 16);
+        StereoFrame16 dest = RandomStereoFrame(rng);
+
+        StereoFrame16 expected = dest;
+        ReferenceDownmixQuadIntoStereo(expected, source, gain);
+
+        AudioCore::Mix::DownmixQuadIntoStereo(dest, source, gain);
+        INFO("gain = " << gain);
+        REQUIRE(dest == expected);
+    }
+}
+
+TEST_CASE("Mix::DownmixQuadIntoMono matches reference", "[audio_core]") {
+    std::mt19937 rng(0x3D7);
+    for (const float gain : test_gains) {
+        const QuadFrame32 source = RandomQuadFrame(rng, 1 << 16);
+        StereoFrame16 dest = RandomStereoFrame(rng);
+
+        StereoFrame16 expected = dest;
+        ReferenceDownmixQuadIntoMono(expected, source, gain);
+
+        AudioCore::Mix::DownmixQuadIntoMono(dest, source, gain);
+        INFO("gain = " << gain);
+        REQUIRE(dest == expected);
+    }
+}
+
+TEST_CASE("Mix kernel throughput", "[.][benchmark]") {
+    constexpr int iterations = 100000;
+    std::mt19937 rng(1234);
+    const StereoFrame16 stereo = RandomStereoFrame(rng);
+    const QuadFrame32 quad = RandomQuadFrame(rng, 1 << 16);
+    const std::array<float, 4> gains = {{0.7071f, 0.5f, 0.25f, 1.0f}};
+
+    const auto Measure = [&](const char* name, auto&& mix) {
+        QuadFrame32 quad_dest{};
+        StereoFrame16 stereo_dest{};
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            // Clear the accumulated quad frame now and then, so that it cannot overflow
+            if (i % 1024 == 0) {
+                quad_dest = {};
+            }
+            mix(quad_dest, stereo_dest);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << iterations / elapsed.count() / 1e3 << " Kframes/s ("
+                  << quad_dest[0][0] + stereo_dest[0][0] << ")\n";
+    };
+
+    Measure("MixStereoIntoQuad reference", [&](QuadFrame32& dest, StereoFrame16&) {
+        ReferenceMixStereoIntoQuad(dest, stereo, gains);
+    });
+    Measure("MixStereoIntoQuad", [&](QuadFrame32& dest, StereoFrame16&) {
+        AudioCore::Mix::MixStereoIntoQuad(dest, stereo, gains);
+    });
+    Measure("DownmixQuadIntoStereo reference", [&](QuadFrame32&, StereoFrame16& dest) {
+        ReferenceDownmixQuadIntoStereo(dest, quad, 0.5f);
+    });
+    Measure("DownmixQuadIntoStereo", [&](QuadFrame32&, StereoFrame16& dest) {
+        AudioCore::Mix::DownmixQuadIntoStereo(dest, quad, 0.5f);
+    });
+    Measure("DownmixQuadIntoMono reference", [&](QuadFrame32&, StereoFrame16& dest) {
+        ReferenceDownmixQuadIntoMono(dest, quad, 0.5f);
+    });
+    Measure("DownmixQuadIntoMono", [&](QuadFrame32&, StereoFrame16& dest) {
+        AudioCore::Mix::DownmixQuadIntoMono(dest, quad, 0.5f);
+    });
+}
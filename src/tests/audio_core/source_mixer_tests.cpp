@@ -0,0 +1,175 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <catch2/catch.hpp>
+#include "audio_core/hle/source_mixer.h"
+#include "core/memory.h"
+
+namespace {
+
+using namespace AudioCore::HLE;
+using AudioCore::QuadFrame32;
+
+constexpr u32 buffer_stride = 0x2000;
+constexpr u32 samples_per_buffer = buffer_stride / 8 * 14;
+
+/// Fills FCRAM with random ADPCM frames, one looping buffer per source
+void FillBuffers(Memory::MemorySystem& memory, std::mt19937& rng) {
+    std::uniform_int_distribution<int> byte_dist(0, 255);
+    u8* const fcram = memory.GetFCRAMPointer(0);
+    for (std::size_t i = 0; i < num_sources * buffer_stride; i++) {
+        fcram[i] = static_cast<u8>(byte_dist(rng));
+    }
+}
+
+/// Configures every source to play its ADPCM buffer in a loop, at a different rate and gain
+void ConfigureSources(SourceConfiguration& configs, AdpcmCoefficients& adpcm_coeffs,
+                      std::mt19937& rng) {
+    std::memset(&configs, 0, sizeof(configs));
+    std::uniform_int_distribution<int> coeff_dist(-2048, 2048);
+    std::uniform_real_distribution<float> gain_dist(0.0f, 1.0f);
+    std::uniform_real_distribution<float> rate_dist(0.5f, 2.0f);
+
+    for (std::size_t i = 0; i < num_sources; i++) {
+        for (auto& coeff : adpcm_coeffs.coeff[i]) {
+            coeff = static_cast<s16>(coeff_dist(rng));
+        }
+
+        auto& config = configs.config[i];
+        config.enable = 1;
+        config.enable_dirty.Assign(1);
+        config.format.Assign(SourceConfiguration::Configuration::Format::ADPCM);
+        config.mono_or_stereo.Assign(SourceConfiguration::Configuration::MonoOrStereo::Mono);
+        config.format_dirty.Assign(1);
+        config.mono_or_stereo_dirty.Assign(1);
+        config.adpcm_coefficients_dirty.Assign(1);
+        config.rate_multiplier = rate_dist(rng);
+        config.rate_multiplier_dirty.Assign(1);
+        config.interpolation_mode = SourceConfiguration::Configuration::InterpolationMode::Linear;
+        config.interpolation_dirty.Assign(1);
+        for (auto& mix_gain : config.gain) {
+            for (auto& gain : mix_gain) {
+                gain = gain_dist(rng);
+            }
+        }
+        config.gain_0_dirty.Assign(1);
+        config.gain_1_dirty.Assign(1);
+        config.gain_2_dirty.Assign(1);
+        config.physical_address = static_cast<u32>(Memory::FCRAM_PADDR + i * buffer_stride);
+        config.length = samples_per_buffer;
+        config.adpcm_ps = 0x12;
+        config.adpcm_dirty.Assign(1);
+        config.is_looping.Assign(1);
+        config.buffer_id = static_cast<u16>(i + 1);
+        config.embedded_buffer_dirty.Assign(1);
+    }
+}
+
+/// Ticks and mixes the sources one after another on the calling thread
+struct SerialMixer {
+    explicit SerialMixer(Memory::MemorySystem& memory) {
+        for (auto& source : sources) {
+            source.SetMemory(memory);
+        }
+    }
+
+    std::array<QuadFrame32, 3> Tick(SourceConfiguration& configs,
+                                    const AdpcmCoefficients& adpcm_coeffs,
+                                    SourceStatus& statuses) {
+        std::array<QuadFrame32, 3> mixes{};
+        for (std::size_t i = 0; i < num_sources; i++) {
+            statuses.status[i] = sources[i].Tick(configs.config[i], adpcm_coeffs.coeff[i], false);
+            for (std::size_t mix = 0; mix < 3; mix++) {
+                sources[i].MixInto(mixes[mix], mix);
+            }
+        }
+        return mixes;
+    }
+
+    std::array<Source, num_sources> sources{{
+        Source(0),  Source(1),  Source(2),  Source(3),  Source(4),  Source(5),
+        Source(6),  Source(7),  Source(8),  Source(9),  Source(10), Source(11),
+        Source(12), Source(13), Source(14), Source(15), Source(16), Source(17),
+        Source(18), Source(19), Source(20), Source(21), Source(22), Source(23),
+    }};
+};
+
+} // Anonymous namespace
+
+TEST_CASE("SourceMixer matches ticking the sources serially", "[audio_core][hle]") {
+    Memory::MemorySystem memory;
+    std::mt19937 rng(1234);
+    FillBuffers(memory, rng);
+
+    for (const std::size_t num_enabled : {std::size_t{4}, num_sources}) {
+        SourceConfiguration configs;
+        AdpcmCoefficients adpcm_coeffs;
+        ConfigureSources(configs, adpcm_coeffs, rng);
+        for (std::size_t i = num_enabled; i < num_sources; i++) {
+            configs.config[i].enable = 0;
+        }
+        SourceConfiguration reference_configs = configs;
+
+        SourceMixer mixer;
+        mixer.SetMemory(memory);
+        auto reference = std::make_unique<SerialMixer>(memory);
+
+        for (int frame = 0; frame < 50; frame++) {
+            SourceStatus statuses{};
+            SourceStatus reference_statuses{};
+            const auto mixes = mixer.Tick(configs, adpcm_coeffs, statuses, false);
+            const auto expected = reference->Tick(reference_configs, adpcm_coeffs,
+                                                  reference_statuses);
+            REQUIRE(mixes == expected);
+            for (std::size_t i = 0; i < num_sources; i++) {
+                const auto& status = statuses.status[i];
+                const auto& expected_status = reference_statuses.status[i];
+                REQUIRE(status.is_enabled == expected_status.is_enabled);
+                REQUIRE(status.current_buffer_id_dirty == expected_status.current_buffer_id_dirty);
+                REQUIRE(status.buffer_position == expected_status.buffer_position);
+                REQUIRE(status.current_buffer_id == expected_status.current_buffer_id);
+            }
+        }
+    }
+}
+
+TEST_CASE("Source mixer throughput", "[.][benchmark]") {
+    constexpr int frames = 2000;
+    Memory::MemorySystem memory;
+    std::mt19937 rng(1234);
+    FillBuffers(memory, rng);
+    AdpcmCoefficients adpcm_coeffs;
+    SourceConfiguration initial_configs;
+    ConfigureSources(initial_configs, adpcm_coeffs, rng);
+
+    const auto Measure = [&](const char* name, auto&& tick) {
+        SourceConfiguration configs = initial_configs;
+        SourceStatus statuses{};
+        s64 checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            const auto mixes = tick(configs, statuses);
+            checksum += mixes[0][0][0];
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "24 ADPCM voices " << name << ": " << frames / elapsed.count()
+                  << " frames/s (checksum " << checksum << ")\n";
+    };
+
+    auto reference = std::make_unique<SerialMixer>(memory);
+    Measure("serial", [&](SourceConfiguration& configs, SourceStatus& statuses) {
+        return reference->Tick(configs, adpcm_coeffs, statuses);
+    });
+    SourceMixer mixer;
+    mixer.SetMemory(memory);
+    Measure("partitioned", [&](SourceConfiguration& configs, SourceStatus& statuses) {
+        return mixer.Tick(configs, adpcm_coeffs, statuses, false);
+    });
+}
@@ -0,0 +1,146 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <SoundTouch.h>
+#include <catch2/catch.hpp>
+#include "audio_core/wsola.h"
+
+namespace {
+
+constexpr unsigned int sample_rate = 32000;
+
+std::vector<s16> Sine(std::size_t frames, double period) {
+    std::vector<s16> samples(frames * 2);
+    for (std::size_t i = 0; i < frames; i++) {
+        const auto sample =
+            static_cast<s16>(10000.0 * std::sin(2.0 * 3.14159265358979 * i / period));
+        samples[i * 2 + 0] = sample;
+        samples[i * 2 + 1] = sample;
+    }
+    return samples;
+}
+
+std::vector<s16> Stretch(const std::vector<s16>& in, double tempo) {
+    AudioCore::WSOLA wsola(sample_rate);
+    wsola.SetTempo(tempo);
+    // Feed the input in sink-sized blocks.
+    constexpr std::size_t block = 512;
+    for (std::size_t frame = 0; frame < in.size() / 2; frame += block) {
+        wsola.PutSamples(in.data() + frame * 2, std::min(block, in.size() / 2 - frame));
+    }
+    wsola.Flush();
+
+    std::vector<s16> out(wsola.NumSamples() * 2);
+    REQUIRE(wsola.ReceiveSamples(out.data(), out.size() / 2) == out.size() / 2);
+    REQUIRE(wsola.NumSamples() == 0);
+    return out;
+}
+
+std::size_t CountZeroCrossings(const std::vector<s16>& samples) {
+    std::size_t crossings = 0;
+    for (std::size_t i = 2; i < samples.size(); i += 2) {
+        if ((samples[i - 2] < 0) != (samples[i] < 0)) {
+            crossings++;
+        }
+    }
+    return crossings;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("WSOLA changes duration by the tempo", "[audio_core]") {
+    const std::vector<s16> in = Sine(sample_rate * 2, 80.0);
+    // Input left over at the end is flushed unstretched, so allow a window's worth of slack.
+    const double slack = sample_rate * 0.06;
+    for (const double tempo : {0.5, 1.0, 1.25, 2.0}) {
+        const std::vector<s16> out = Stretch(in, tempo);
+        const double expected = static_cast<double>(in.size() / 2) / tempo;
+        INFO("tempo = " << tempo);
+        REQUIRE(std::abs(static_cast<double>(out.size() / 2) - expected) < slack / tempo + slack);
+    }
+}
+
+TEST_CASE("WSOLA preserves pitch", "[audio_core]") {
+    const std::vector<s16> in = Sine(sample_rate * 2, 80.0);
+    const double in_rate = static_cast<double>(CountZeroCrossings(in)) / (in.size() / 2);
+    for (const double tempo : {0.75, 1.5}) {
+        const std::vector<s16> out = Stretch(in, tempo);
+        const double out_rate = static_cast<double>(CountZeroCrossings(out)) / (out.size() / 2);
+        INFO("tempo = " << tempo);
+        REQUIRE(out_rate == Approx(in_rate).epsilon(0.05));
+    }
+}
+
+TEST_CASE("WSOLA passes audio through unchanged at normal tempo", "[audio_core]") {
+    // Each sequence of a periodic input best matches the previous one where it was cut from.
+    const std::vector<s16> in = Sine(sample_rate, 80.0);
+    REQUIRE(Stretch(in, 1.0) == in);
+}
+
+TEST_CASE("Time stretch throughput", "[.][benchmark]") {
+    constexpr std::size_t block = 512;
+    constexpr int iterations = 5;
+    // A tone with noise on top, so that the overlap search has no trivially perfect match
+    std::vector<s16> in = Sine(sample_rate * 4, 80.0);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> noise(-1000, 1000);
+    for (s16& sample : in) {
+        sample = static_cast<s16>(sample + noise(rng));
+    }
+    const std::size_t num_frames = in.size() / 2;
+    std::vector<s16> out(block * 2);
+
+    const auto Measure = [&](const char* name, double tempo, auto&& stretch) {
+        std::size_t produced = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            produced += stretch(tempo);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "tempo " << tempo << " " << name << ": "
+                  << static_cast<double>(num_frames) * iterations / elapsed.count() / 1e6
+                  << " Mframes/s (" << produced / iterations << " produced)\n";
+    };
+
+    const auto StretchWithWSOLA = [&](double tempo) {
+        AudioCore::WSOLA wsola(sample_rate);
+        wsola.SetTempo(tempo);
+        std::size_t produced = 0;
+        for (std::size_t frame = 0; frame < num_frames; frame += block) {
+            wsola.PutSamples(in.data() + frame * 2, std::min(block, num_frames - frame));
+            while (const std::size_t received = wsola.ReceiveSamples(out.data(), block)) {
+                produced += received;
+            }
+        }
+        return produced;
+    };
+
+    const auto StretchWithSoundTouch = [&](double tempo) {
+        soundtouch::SoundTouch sound_touch;
+        sound_touch.setChannels(2);
+        sound_touch.setSampleRate(sample_rate);
+        sound_touch.setTempo(tempo);
+        std::size_t produced = 0;
+        for (std::size_t frame = 0; frame < num_frames; frame += block) {
+            sound_touch.putSamples(in.data() + frame * 2,
+                                   static_cast<u32>(std::min(block, num_frames - frame)));
+            while (const u32 received =
+                       sound_touch.receiveSamples(out.data(), static_cast<u32>(block))) {
+                produced += received;
+            }
+        }
+        return produced;
+    };
+
+    for (const double tempo : {0.8, 1.25}) {
+        Measure("WSOLA", tempo, StretchWithWSOLA);
+        Measure("SoundTouch", tempo, StretchWithSoundTouch);
+    }
+}
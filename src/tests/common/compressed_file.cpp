@@ -0,0 +1,73 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/compressed_file.h"
+#include "common/file_util.h"
+
+TEST_CASE("CompressedImage round trip with random access", "[common]") {
+    const std::string source_path = "./compressed_image_test.cci";
+    const std::string image_path = "./compressed_image_test.zcci";
+    constexpr u32 block_size = 0x4000;
+
+    // A compressible run followed by random data, so that both raw and LZO blocks are used
+    std::vector<u8> contents(block_size * 6 + 0x123);
+    std::mt19937 rng(42);
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        contents[i] = i < contents.size() / 2 ? static_cast<u8>(i / 64) : static_cast<u8>(rng());
+    }
+    {
+        FileUtil::IOFile source(source_path, "wb");
+        REQUIRE(source.WriteBytes(contents.data(), contents.size()) == contents.size());
+    }
+    {
+        FileUtil::IOFile source(source_path, "rb");
+        FileUtil::IOFile image(image_path, "wb");
+        u64 last_progress = 0;
+        REQUIRE(FileUtil::CompressImage(source, image, block_size,
+                                        [&](u64 done, u64 total) { last_progress = done; }));
+        REQUIRE(last_progress == contents.size());
+    }
+    REQUIRE(FileUtil::GetSize(image_path) < contents.size());
+
+    FileUtil::IOFile image(image_path, "rb");
+    REQUIRE(image.IsOpen());
+    REQUIRE(image.GetSize() == contents.size());
+    // The file on disk does not hold the uncompressed data, so it must not be memory-mapped
+    REQUIRE(!FileUtil::MappedFile(image).IsOpen());
+
+    std::vector<u8> buffer(contents.size());
+    REQUIRE(image.ReadBytes(buffer.data(), buffer.size()) == buffer.size());
+    REQUIRE(buffer == contents);
+
+    std::uniform_int_distribution<std::size_t> offset_dist(0, contents.size() - 1);
+    for (int i = 0; i < 100; i++) {
+        const std::size_t offset = offset_dist(rng);
+        const std::size_t length = std::min<std::size_t>(block_size * 2, contents.size() - offset);
+        INFO("offset = " << offset);
+        REQUIRE(image.ReadBytesAt(buffer.data(), length, offset) == length);
+        REQUIRE(std::equal(buffer.begin(), buffer.begin() + length, contents.begin() + offset));
+    }
+
+    image.Seek(block_size * 3 - 2, SEEK_SET);
+    REQUIRE(image.ReadBytes(buffer.data(), 4) == 4);
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + 4, contents.begin() + block_size * 3 - 2));
+    image.Close();
+
+    FileUtil::Delete(source_path);
+    FileUtil::Delete(image_path);
+}
+
+TEST_CASE("CompressedImage rejects invalid images", "[common]") {
+    const std::string image_path = "./compressed_image_invalid.zcci";
+    {
+        FileUtil::IOFile image(image_path, "wb");
+        const std::vector<u8> garbage(64, 0xAB);
+        image.WriteBytes(garbage.data(), garbage.size());
+    }
+    REQUIRE(!FileUtil::IOFile(image_path, "rb").IsOpen());
+    FileUtil::Delete(image_path);
+}
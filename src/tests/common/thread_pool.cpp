@@ -0,0 +1,41 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/thread_pool.h"
+
+TEST_CASE("ThreadPool::Push", "[common]") {
+    Common::ThreadPool pool(4);
+    std::atomic<int> sum{0};
+    for (int i = 1; i <= 100; ++i) {
+        pool.Push([&sum, i] { sum += i; });
+    }
+    pool.WaitForIdle();
+    REQUIRE(sum == 5050);
+}
+
+TEST_CASE("ThreadPool::ParallelFor", "[common]") {
+    Common::ThreadPool pool(3);
+    const std::size_t count = GENERATE(0, 1, 7, 8, 9, 100, 1000);
+    const std::size_t granularity = GENERATE(1, 8);
+
+    // Catch assertions aren't thread-safe, so only record the results on the workers
+    std::vector<int> visited(count, 0);
+    std::atomic<bool> aligned{true};
+    pool.ParallelFor(count, granularity, [&](std::size_t begin, std::size_t end) {
+        if (begin % granularity != 0) {
+            aligned = false;
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            ++visited[i];
+        }
+    });
+
+    REQUIRE(aligned);
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(visited[i] == 1);
+    }
+}
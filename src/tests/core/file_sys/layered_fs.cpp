@@ -0,0 +1,165 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "core/file_sys/layered_fs.h"
+
+namespace {
+
+/// A RomFS held in memory, counting how often it is read
+class MemoryRomFSReader final : public FileSys::RomFSReader {
+public:
+    explicit MemoryRomFSReader(std::vector<u8> data_) : data(std::move(data_)) {}
+
+    std::size_t GetSize() const override {
+        return data.size();
+    }
+
+    std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override {
+        num_reads++;
+        length = std::min(length, data.size() - offset);
+        std::copy_n(data.begin() + offset, length, buffer);
+        return length;
+    }
+
+    std::size_t num_reads = 0;
+
+private:
+    std::vector<u8> data;
+};
+
+/// A RomFS containing nothing but its root directory
+std::vector<u8> EmptyRomFS() {
+    std::vector<u8> data(0x60, 0xFF);
+    const auto Write = [&data](std::size_t offset, u32 value) {
+        std::memcpy(data.data() + offset, &value, sizeof(value));
+    };
+    Write(0x00, sizeof(FileSys::RomFSHeader));
+    Write(0x04, 0x28); // Directory hash table, three buckets
+    Write(0x08, 0x0C);
+    Write(0x0C, 0x34); // Directory metadata, only the root
+    Write(0x10, 0x18);
+    Write(0x14, 0x4C); // File hash table, three empty buckets
+    Write(0x18, 0x0C);
+    Write(0x1C, 0x58); // File metadata, empty
+    Write(0x20, 0x00);
+    Write(0x24, 0x60); // File data
+    Write(0x28, 0);    // The root hashes to bucket 0
+    Write(0x34, 0);    // The root is its own parent and has an empty name
+    Write(0x48, 0);
+    return data;
+}
+
+std::vector<u8> ReadAll(FileSys::RomFSReader& romfs) {
+    std::vector<u8> data(romfs.GetSize());
+    REQUIRE(romfs.ReadFile(0, data.size(), data.data()) == data.size());
+    return data;
+}
+
+void WriteHostFile(const std::string& path, const std::string& contents) {
+    REQUIRE(FileUtil::CreateFullPath(path));
+    FileUtil::IOFile file(path, "wb");
+    REQUIRE(file.WriteBytes(contents.data(), contents.size()) == contents.size());
+}
+
+bool Contains(const std::vector<u8>& data, const std::string& needle) {
+    return std::search(data.begin(), data.end(), needle.begin(), needle.end()) != data.end();
+}
+
+std::string GetCachePath(const std::string& patch_path) {
+    const u64 path_hash =
+        Common::ComputeHash64(patch_path.data(), static_cast<u32>(patch_path.size()));
+    return fmt::format("{}layeredfs{}{:016X}.cache",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), DIR_SEP, path_hash);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("LayeredFS caches the rebuilt RomFS", "[core][file_sys]") {
+    const std::string root = "./layered_fs_test" DIR_SEP;
+    const std::string base_path = root + "base" DIR_SEP;
+    const std::string patch_path = root + "patch" DIR_SEP;
+    const std::string ext_path = root + "ext" DIR_SEP;
+    FileUtil::DeleteDirRecursively(root);
+    FileUtil::Delete(GetCachePath(base_path));
+    FileUtil::Delete(GetCachePath(patch_path));
+
+    // Build the original RomFS by adding files to an empty one
+    WriteHostFile(base_path + "a.bin", "original a");
+    WriteHostFile(base_path + "b.bin", "0123456789");
+    WriteHostFile(base_path + "dir" DIR_SEP "c.bin", "original c");
+    std::vector<u8> original;
+    {
+        FileSys::LayeredFS base(std::make_shared<MemoryRomFSReader>(EmptyRomFS()), base_path, "");
+        original = ReadAll(base);
+    }
+
+    // Replace a.bin and dir/c.bin, and patch b.bin with an IPS patch writing "XY" at offset 2
+    WriteHostFile(patch_path + "a.bin", "replaced a");
+    WriteHostFile(patch_path + "dir" DIR_SEP "c.bin", "replaced c");
+    WriteHostFile(ext_path + "b.bin.ips", std::string("PATCH\0\0\x02\0\x02XYEOF", 15));
+
+    const auto Load = [&](std::size_t& num_reads) {
+        auto romfs = std::make_shared<MemoryRomFSReader>(original);
+        FileSys::LayeredFS layered_fs(romfs, patch_path, ext_path);
+        num_reads = romfs->num_reads;
+        return ReadAll(layered_fs);
+    };
+
+    std::size_t rebuild_reads = 0;
+    const std::vector<u8> rebuilt = Load(rebuild_reads);
+    REQUIRE(Contains(rebuilt, "replaced a"));
+    REQUIRE(Contains(rebuilt, "01XY456789"));
+    REQUIRE(Contains(rebuilt, "replaced c"));
+    REQUIRE(FileUtil::Exists(GetCachePath(patch_path)));
+
+    SECTION("a cache hit gives the same RomFS without loading the directory tree") {
+        std::size_t cached_reads = 0;
+        REQUIRE(Load(cached_reads) == rebuilt);
+        REQUIRE(cached_reads < rebuild_reads);
+    }
+
+    SECTION("changing a replacement file invalidates the cache") {
+        WriteHostFile(patch_path + "a.bin", "replaced a again");
+        std::size_t reads = 0;
+        const std::vector<u8> updated = Load(reads);
+        REQUIRE(reads == rebuild_reads);
+        REQUIRE(Contains(updated, "replaced a again"));
+        REQUIRE(Contains(updated, "01XY456789"));
+
+        std::size_t cached_reads = 0;
+        REQUIRE(Load(cached_reads) == updated);
+        REQUIRE(cached_reads < rebuild_reads);
+    }
+
+    SECTION("a cache written by an older version is rebuilt") {
+        {
+            // The version is the first word of the cache file
+            FileUtil::IOFile cache(GetCachePath(patch_path), "r+b");
+            const u32 old_version = 1;
+            REQUIRE(cache.WriteBytes(&old_version, sizeof(old_version)) == sizeof(old_version));
+        }
+        std::size_t reads = 0;
+        REQUIRE(Load(reads) == rebuilt);
+        REQUIRE(reads == rebuild_reads);
+
+        // The rebuild replaced the old cache
+        std::size_t cached_reads = 0;
+        REQUIRE(Load(cached_reads) == rebuilt);
+        REQUIRE(cached_reads < rebuild_reads);
+    }
+
+    FileUtil::DeleteDirRecursively(root);
+    FileUtil::Delete(GetCachePath(base_path));
+    FileUtil::Delete(GetCachePath(patch_path));
+}
@@ -0,0 +1,158 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/file_sys/ncch_container.h"
+
+namespace {
+
+/// The byte by byte LZSS decompression the memcpy fast paths replaced
+bool ReferenceDecompress(const u8* compressed, u32 compressed_size, u8* decompressed,
+                         u32 decompressed_size) {
+    const u8* footer = compressed + compressed_size - 8;
+
+    u32 buffer_top_and_bottom;
+    std::memcpy(&buffer_top_and_bottom, footer, sizeof(u32));
+
+    u32 out = decompressed_size;
+    u32 index = compressed_size - ((buffer_top_and_bottom >> 24) & 0xFF);
+    u32 stop_index = compressed_size - (buffer_top_and_bottom & 0xFFFFFF);
+
+    std::memset(decompressed, 0, decompressed_size);
+    std::memcpy(decompressed, compressed, compressed_size);
+
+    while (index > stop_index) {
+        u8 control = compressed[--index];
+
+        for (unsigned i = 0; i < 8; i++) {
+            if (index <= stop_index)
+                break;
+            if (index <= 0)
+                break;
+            if (out <= 0)
+                break;
+
+            if (control & 0x80) {
+                if (index < 2)
+                    return false;
+                index -= 2;
+
+                u32 segment_offset = compressed[index] | (compressed[index + 1] << 8);
+                u32 segment_size = ((segment_offset >> 12) & 15) + 3;
+                segment_offset &= 0x0FFF;
+                segment_offset += 2;
+
+                if (out < segment_size)
+                    return false;
+
+                for (unsigned j = 0; j < segment_size; j++) {
+                    if (out + segment_offset >= decompressed_size)
+                        return false;
+
+                    u8 data = decompressed[out + segment_offset];
+                    decompressed[--out] = data;
+                }
+            } else {
+                if (out < 1)
+                    return false;
+                decompressed[--out] = compressed[--index];
+            }
+            control <<= 1;
+        }
+    }
+    return true;
+}
+
+/**
+ * Generates a valid LZSS stream. Streams are decoded backwards from their end, so the stream is
+ * built in that order, only emitting back-references to data already decoded.
+ * @param rng Random source, seeded by the caller so that the vectors are fixed
+ * @param body_size Size of the stream before the footer
+ * @param extra_size How much larger the decompressed data is than the stream
+ * @param max_distance Upper bound on back-reference distances, small ones overlap their output
+ */
+std::vector<u8> MakeStream(std::mt19937& rng, u32 body_size, u32 extra_size, u32 max_distance) {
+    std::uniform_int_distribution<u32> byte_dist(0, 255);
+    std::vector<u8> reversed_body; // Bytes in the order the decoder reads them
+    const u32 decompressed_size = body_size + 8 + extra_size;
+    u32 out = decompressed_size;
+    while (reversed_body.size() < body_size) {
+        // One control byte in four has only literals, which takes the eight literal fast path
+        const u8 wanted = byte_dist(rng) % 4 == 0 ? 0 : static_cast<u8>(byte_dist(rng));
+        const std::size_t control_index = reversed_body.size();
+        reversed_body.push_back(0);
+        for (int bit = 7; bit >= 0 && reversed_body.size() < body_size; bit--) {
+            const u32 size = byte_dist(rng) % 16;
+            const u32 decoded = decompressed_size - out;
+            if ((wanted & (1 << bit)) && reversed_body.size() + 2 <= body_size && decoded >= 3 &&
+                out >= size + 3) {
+                const u32 offset = std::uniform_int_distribution<u32>(
+                    0, std::min({0xFFFu, max_distance, decoded - 3}))(rng);
+                const u16 reference = static_cast<u16>(size << 12 | offset);
+                reversed_body[control_index] |= 1 << bit;
+                reversed_body.push_back(static_cast<u8>(reference >> 8));
+                reversed_body.push_back(static_cast<u8>(reference));
+                out -= size + 3;
+            } else if (out > 0) {
+                reversed_body.push_back(static_cast<u8>(byte_dist(rng)));
+                out--;
+            } else {
+                reversed_body.push_back(0);
+            }
+        }
+    }
+
+    std::vector<u8> stream(reversed_body.rbegin(), reversed_body.rend());
+    const u32 buffer_top_and_bottom = 8u << 24 | (body_size + 8);
+    stream.resize(body_size + 8);
+    std::memcpy(stream.data() + body_size, &buffer_top_and_bottom, sizeof(u32));
+    std::memcpy(stream.data() + body_size + 4, &extra_size, sizeof(u32));
+    return stream;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("LZSS_Decompress matches the byte by byte decompression", "[core][file_sys]") {
+    std::mt19937 rng(1234);
+    for (int i = 0; i < 2000; i++) {
+        const u32 body_size = std::uniform_int_distribution<u32>(1, 0x400)(rng);
+        const u32 extra_size = std::uniform_int_distribution<u32>(0, 0x1000)(rng);
+        const u32 max_distance = i % 2 == 0 ? 0x10 : 0xFFF;
+        const std::vector<u8> stream = MakeStream(rng, body_size, extra_size, max_distance);
+        const u32 stream_size = static_cast<u32>(stream.size());
+
+        const u32 decompressed_size =
+            FileSys::LZSS_GetDecompressedSize(stream.data(), stream_size);
+        REQUIRE(decompressed_size == stream_size + extra_size);
+        std::vector<u8> expected(decompressed_size);
+        std::vector<u8> actual(decompressed_size, 0xCD);
+        const bool expected_result =
+            ReferenceDecompress(stream.data(), stream_size, expected.data(), decompressed_size);
+        const bool actual_result = FileSys::LZSS_Decompress(stream.data(), stream_size,
+                                                             actual.data(), decompressed_size);
+        REQUIRE(expected_result);
+        REQUIRE(actual_result);
+        REQUIRE(actual == expected);
+    }
+}
+
+TEST_CASE("LZSS_Decompress rejects footers pointing outside the stream", "[core][file_sys]") {
+    std::vector<u8> stream(0x20, 0xFF);
+    std::vector<u8> decompressed(0x40);
+
+    // Too short to hold a footer
+    REQUIRE(!FileSys::LZSS_Decompress(stream.data(), 4, decompressed.data(), 0x40));
+
+    // Smaller than the compressed data
+    REQUIRE(!FileSys::LZSS_Decompress(stream.data(), 0x20, decompressed.data(), 0x10));
+
+    // The header extends beyond the start of the stream
+    const u32 buffer_top_and_bottom = 0x40u << 24 | 0x20;
+    std::memcpy(stream.data() + 0x18, &buffer_top_and_bottom, sizeof(u32));
+    REQUIRE(!FileSys::LZSS_Decompress(stream.data(), 0x20, decompressed.data(), 0x40));
+}
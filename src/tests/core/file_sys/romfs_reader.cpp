@@ -0,0 +1,91 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/romfs_reader.h"
+
+namespace FileSys {
+
+TEST_CASE("DirectRomFSReader - Cached reads", "[core][file_sys]") {
+    const std::string test_file = "./romfs_reader_test.bin";
+    constexpr std::size_t header_size = 0x200;
+    constexpr std::size_t data_size = DirectRomFSReader::cache_block_size * 5 + 0x1234;
+
+    std::vector<u8> contents(header_size + data_size);
+    std::mt19937 rng(1234);
+    for (u8& byte : contents) {
+        byte = static_cast<u8>(rng());
+    }
+    {
+        FileUtil::IOFile out(test_file, "wb");
+        REQUIRE(out.WriteBytes(contents.data(), contents.size()) == contents.size());
+    }
+
+    {
+        DirectRomFSReader reader(FileUtil::IOFile(test_file, "rb"), header_size, data_size);
+        REQUIRE(reader.GetSize() == data_size);
+
+        std::vector<u8> buffer(DirectRomFSReader::cache_block_size * 3);
+        const auto check = [&](std::size_t offset, std::size_t length) {
+            INFO("offset = " << offset << ", length = " << length);
+            const std::size_t expected = std::min(length, data_size - offset);
+            REQUIRE(reader.ReadFile(offset, length, buffer.data()) == expected);
+            REQUIRE(std::equal(buffer.begin(), buffer.begin() + expected,
+                               contents.begin() + header_size + offset));
+        };
+
+        // Sequential reads straddling block boundaries, which also exercise read-ahead
+        for (std::size_t offset = 0; offset < data_size; offset += 0x3000) {
+            check(offset, 0x3000);
+        }
+        // Random reads, including ones past the end of the data
+        std::uniform_int_distribution<std::size_t> offset_dist(0, data_size - 1);
+        std::uniform_int_distribution<std::size_t> length_dist(1, buffer.size());
+        for (int i = 0; i < 200; i++) {
+            check(offset_dist(rng), length_dist(rng));
+        }
+        REQUIRE(reader.ReadFile(data_size, 0x10, buffer.data()) == 0);
+    }
+
+    FileUtil::Delete(test_file);
+}
+
+TEST_CASE("MappedRomFSReader", "[core][file_sys]") {
+    const std::string test_file = "./romfs_mapped_test.bin";
+    constexpr std::size_t header_size = 0x200;
+    constexpr std::size_t data_size = 0x4321;
+    std::vector<u8> contents(header_size + data_size);
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        contents[i] = static_cast<u8>(i * 7);
+    }
+    {
+        FileUtil::IOFile out(test_file, "wb");
+        REQUIRE(out.WriteBytes(contents.data(), contents.size()) == contents.size());
+    }
+
+    {
+        auto reader =
+            MakeUnencryptedRomFSReader(FileUtil::IOFile(test_file, "rb"), header_size, data_size);
+        REQUIRE(dynamic_cast<MappedRomFSReader*>(reader.get()) != nullptr);
+        REQUIRE(reader->GetSize() == data_size);
+
+        std::vector<u8> buffer(0x1000);
+        REQUIRE(reader->ReadFile(0x123, buffer.size(), buffer.data()) == buffer.size());
+        REQUIRE(std::equal(buffer.begin(), buffer.end(), contents.begin() + header_size + 0x123));
+        REQUIRE(reader->ReadFile(data_size - 0x10, buffer.size(), buffer.data()) == 0x10);
+        REQUIRE(reader->ReadFile(data_size, buffer.size(), buffer.data()) == 0);
+
+        const u8* direct = reader->GetDirectPointer(0x100, 0x10);
+        REQUIRE(direct != nullptr);
+        REQUIRE(std::equal(direct, direct + 0x10, contents.begin() + header_size + 0x100));
+        REQUIRE(reader->GetDirectPointer(data_size - 0x10, 0x11) == nullptr);
+    }
+
+    FileUtil::Delete(test_file);
+}
+
+} // namespace FileSys
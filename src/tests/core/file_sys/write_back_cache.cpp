@@ -0,0 +1,170 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "core/file_sys/write_back_cache.h"
+
+namespace {
+
+std::vector<u8> ReadHostFile(const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    std::vector<u8> data(file.GetSize());
+    REQUIRE(file.ReadBytes(data.data(), data.size()) == data.size());
+    return data;
+}
+
+void WriteHostFile(const std::string& path, const std::vector<u8>& data) {
+    FileUtil::IOFile file(path, "wb");
+    REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+}
+
+} // Anonymous namespace
+
+TEST_CASE("WriteBackCache coalesces writes until they are flushed", "[core][file_sys]") {
+    const std::string root = "./write_back_cache_test";
+    const std::string path = root + DIR_SEP "save.bin";
+    REQUIRE(FileUtil::CreateFullPath(root + DIR_SEP));
+    WriteHostFile(path, std::vector<u8>(8, 0x11));
+
+    auto& cache = FileSys::WriteBackCache::GetInstance();
+    const auto stats_before = cache.GetStats();
+    {
+        FileUtil::IOFile file = cache.Open(path, true);
+        REQUIRE(file.IsOpen());
+        const u8 a[] = {0xA0, 0xA1};
+        const u8 b[] = {0xB0, 0xB1, 0xB2};
+        const u8 c[] = {0xC0};
+        REQUIRE(file.Seek(2, SEEK_SET));
+        REQUIRE(file.WriteBytes(a, sizeof(a)) == sizeof(a));
+        REQUIRE(file.Flush());
+        REQUIRE(file.WriteBytes(b, sizeof(b)) == sizeof(b));
+        REQUIRE(file.Seek(10, SEEK_SET));
+        REQUIRE(file.WriteBytes(c, sizeof(c)) == sizeof(c));
+
+        // Reads see the buffered writes, while the host file is untouched
+        const std::vector<u8> expected = {0x11, 0x11, 0xA0, 0xA1, 0xB0, 0xB1,
+                                          0xB2, 0x11, 0x00, 0x00, 0xC0};
+        std::vector<u8> read(expected.size());
+        REQUIRE(file.GetSize() == expected.size());
+        REQUIRE(file.ReadBytesAt(read.data(), read.size(), 0) == read.size());
+        REQUIRE(read == expected);
+        REQUIRE(ReadHostFile(path) == std::vector<u8>(8, 0x11));
+
+        REQUIRE(cache.Flush(root));
+        REQUIRE(ReadHostFile(path) == expected);
+        REQUIRE(!FileUtil::Exists(path + ".citra_journal"));
+    }
+
+    const auto stats = cache.GetStats();
+    REQUIRE(stats.guest_writes - stats_before.guest_writes == 3);
+    REQUIRE(stats.guest_flushes - stats_before.guest_flushes == 1);
+    // Two ranges, plus the journal
+    REQUIRE(stats.host_writes - stats_before.host_writes == 3);
+
+    FileUtil::DeleteDirRecursively(root);
+}
+
+TEST_CASE("WriteBackCache replays interrupted write-backs", "[core][file_sys]") {
+    const std::string root = "./write_back_cache_journal_test";
+    const std::string path = root + DIR_SEP "save.bin";
+    REQUIRE(FileUtil::CreateFullPath(root + DIR_SEP));
+    WriteHostFile(path, std::vector<u8>(4, 0x11));
+
+    // Header ("JRNL", one record), then a record writing 0x22 0x33 at offset 1
+    std::vector<u8> journal = {'J', 'R', 'N', 'L', 1, 0, 0, 0};
+    const std::vector<u8> record = {1, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0x22, 0x33};
+    journal.insert(journal.end(), record.begin(), record.end());
+    WriteHostFile(path + ".citra_journal", journal);
+    // Never committed, so it must not be applied
+    WriteHostFile(path + ".citra_journal.tmp", {0xFF});
+
+    auto& cache = FileSys::WriteBackCache::GetInstance();
+    cache.RecoverJournals(root);
+    REQUIRE(ReadHostFile(path) == std::vector<u8>{0x11, 0x22, 0x33, 0x11});
+    REQUIRE(!FileUtil::Exists(path + ".citra_journal"));
+    REQUIRE(!FileUtil::Exists(path + ".citra_journal.tmp"));
+
+    // Released files are written through
+    FileUtil::IOFile file = cache.Open(path, true);
+    cache.Release(root);
+    const u8 data = 0x44;
+    REQUIRE(file.WriteBytes(&data, 1) == 1);
+    REQUIRE(ReadHostFile(path) == std::vector<u8>{0x44, 0x22, 0x33, 0x11});
+    file.Close();
+
+    FileUtil::DeleteDirRecursively(root);
+}
+
+TEST_CASE("WriteBackCache opens files read-only unless asked to write", "[core][file_sys]") {
+    const std::string root = "./write_back_cache_read_only_test";
+    const std::string path = root + DIR_SEP "save.bin";
+    REQUIRE(FileUtil::CreateFullPath(root + DIR_SEP));
+    WriteHostFile(path, std::vector<u8>(4, 0x11));
+
+    auto& cache = FileSys::WriteBackCache::GetInstance();
+    FileUtil::IOFile reader = cache.Open(path, false);
+    REQUIRE(reader.IsOpen());
+
+    // A writer shares the reader's state once the host file is reopened for writing
+    FileUtil::IOFile writer = cache.Open(path, true);
+    REQUIRE(writer.IsOpen());
+    const u8 data = 0x22;
+    REQUIRE(writer.WriteBytes(&data, 1) == 1);
+    u8 read = 0;
+    REQUIRE(reader.ReadBytesAt(&read, 1, 0) == 1);
+    REQUIRE(read == 0x22);
+
+    reader.Close();
+    writer.Close();
+    REQUIRE(ReadHostFile(path) == std::vector<u8>{0x22, 0x11, 0x11, 0x11});
+
+    FileUtil::DeleteDirRecursively(root);
+}
+
+#ifndef _WIN32
+TEST_CASE("WriteBackCache keeps writes which failed to be written back", "[core][file_sys]") {
+    const std::string root = "./write_back_cache_failure_test";
+    const std::string path = root + DIR_SEP "save.bin";
+    REQUIRE(FileUtil::CreateFullPath(root + DIR_SEP));
+    WriteHostFile(path, {});
+
+    auto& cache = FileSys::WriteBackCache::GetInstance();
+    FileUtil::IOFile file = cache.Open(path, true);
+    const std::vector<u8> data(0x3000, 0x5A);
+    REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+
+    // Make host writes past 4 KiB fail
+    const auto old_handler = std::signal(SIGXFSZ, SIG_IGN);
+    rlimit old_limit;
+    REQUIRE(getrlimit(RLIMIT_FSIZE, &old_limit) == 0);
+    rlimit limit = old_limit;
+    limit.rlim_cur = 0x1000;
+    REQUIRE(setrlimit(RLIMIT_FSIZE, &limit) == 0);
+
+    REQUIRE(!cache.Flush(root));
+    // Guest flushes retry and report the failure, while the writes stay readable
+    REQUIRE(!file.Flush());
+    std::vector<u8> read(data.size());
+    REQUIRE(file.ReadBytesAt(read.data(), read.size(), 0) == read.size());
+    REQUIRE(read == data);
+    REQUIRE(!file.Resize(0x10));
+
+    REQUIRE(setrlimit(RLIMIT_FSIZE, &old_limit) == 0);
+    std::signal(SIGXFSZ, old_handler);
+
+    REQUIRE(file.Flush());
+    REQUIRE(ReadHostFile(path) == data);
+    REQUIRE(file.Close());
+
+    FileUtil::DeleteDirRecursively(root);
+}
+#endif
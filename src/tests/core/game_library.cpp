@@ -0,0 +1,67 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "core/game_library.h"
+
+namespace {
+
+void WriteFile(const std::string& path, std::size_t size) {
+    const std::vector<u8> data(size, 0xA5);
+    FileUtil::IOFile file(path, "wb");
+    REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+}
+
+bool IsGameFile(const std::string& path) {
+    return path.size() > 4 && path.compare(path.size() - 4, 4, ".3ds") == 0;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("GameLibrary scans directories and keeps its index up to date", "[core]") {
+    const std::string root = "./game_library_test";
+    const std::string index_path = root + DIR_SEP "index.cache";
+    const std::string nested = root + DIR_SEP "nested";
+    REQUIRE(FileUtil::CreateFullPath(nested + DIR_SEP));
+    WriteFile(root + DIR_SEP "a.3ds", 0x100);
+    WriteFile(root + DIR_SEP "b.txt", 0x100);
+    WriteFile(nested + DIR_SEP "c.3ds", 0x200);
+
+    Core::GameLibrary library(index_path);
+    REQUIRE(!library.Load());
+
+    std::vector<std::string> subdirectories;
+    auto entries = library.Scan(root, 0, IsGameFile, &subdirectories);
+    REQUIRE(entries.size() == 1);
+    REQUIRE(subdirectories.empty());
+
+    entries = library.Scan(root, 1, IsGameFile, &subdirectories);
+    REQUIRE(entries.size() == 2);
+    REQUIRE(subdirectories == std::vector<std::string>{nested});
+    for (const auto& entry : entries) {
+        // The files are not games, but are indexed so that they are not opened again
+        REQUIRE(entry.size == FileUtil::GetSize(entry.path));
+        REQUIRE(!entry.IsListable());
+    }
+
+    library.Prune();
+    REQUIRE(library.Save());
+    Core::GameLibrary reloaded(index_path);
+    REQUIRE(reloaded.Load());
+
+    // Changed files are read again
+    WriteFile(nested + DIR_SEP "c.3ds", 0x300);
+    const auto entry = reloaded.GetEntry(nested + DIR_SEP "c.3ds");
+    REQUIRE(entry.size == 0x300);
+
+    std::atomic_bool cancel{true};
+    REQUIRE(reloaded.Scan(root, 1, IsGameFile, nullptr, &cancel).empty());
+
+    FileUtil::DeleteDirRecursively(root);
+}
@@ -0,0 +1,253 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
+#include "common/alignment.h"
+#include "common/file_util.h"
+#include "common/swap.h"
+#include "core/file_sys/cia_common.h"
+#include "core/file_sys/cia_container.h"
+#include "core/file_sys/ticket.h"
+#include "core/file_sys/title_metadata.h"
+#include "core/hle/service/am/am.h"
+#include "core/hle/service/fs/archive.h"
+#include "core/hw/aes/key.h"
+
+namespace {
+
+constexpr u64 test_title_id = 0x000400000F7C1A00;
+constexpr std::size_t signature_block_size = 0x140; // Type, RSA-2048 signature and padding
+
+/// Encrypts or decrypts data in one go with AES-128-CBC
+std::vector<u8> ApplyCBC(bool encrypt, const HW::AES::AESKey& key, const std::array<u8, 16>& iv,
+                         std::vector<u8> data) {
+    if (encrypt) {
+        CryptoPP::CBC_Mode<CryptoPP::AES>::Encryption(key.data(), key.size(), iv.data())
+            .ProcessData(data.data(), data.data(), data.size());
+    } else {
+        CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption(key.data(), key.size(), iv.data())
+            .ProcessData(data.data(), data.data(), data.size());
+    }
+    return data;
+}
+
+/// Returns a CIA holding the given contents, with correct hashes in its TMD except for
+/// corrupt_content. If a title key is given, the contents are encrypted with it and the ticket
+/// holds it encrypted with common key 0.
+std::vector<u8> MakeCIA(const std::vector<std::vector<u8>>& contents,
+                        std::optional<std::size_t> corrupt_content = {},
+                        std::optional<HW::AES::AESKey> title_key = {}) {
+    const auto align = [](std::size_t value) { return Common::AlignUp(value, 0x40); };
+    const std::size_t ticket_size = signature_block_size + sizeof(FileSys::Ticket::Body);
+    const std::size_t tmd_size = signature_block_size + sizeof(FileSys::TitleMetadata::Body) +
+                                 contents.size() * sizeof(FileSys::TitleMetadata::ContentChunk);
+
+    const std::size_t ticket_offset = align(FileSys::CIA_HEADER_SIZE);
+    const std::size_t tmd_offset = align(ticket_offset + ticket_size);
+    const std::size_t content_offset = align(tmd_offset + tmd_size);
+    std::size_t content_size = 0;
+    for (const auto& content : contents) {
+        content_size += content.size();
+    }
+    std::vector<u8> cia(content_offset);
+
+    // Header
+    const auto write_u32 = [&cia](std::size_t offset, u32 value) {
+        std::memcpy(&cia[offset], &value, sizeof(value));
+    };
+    write_u32(0x00, FileSys::CIA_HEADER_SIZE);
+    write_u32(0x08, 0); // Certificate chain size
+    write_u32(0x0C, static_cast<u32>(ticket_size));
+    write_u32(0x10, static_cast<u32>(tmd_size));
+    write_u32(0x14, 0); // Meta size
+    const u64_le content_size_le = content_size;
+    std::memcpy(&cia[0x18], &content_size_le, sizeof(content_size_le));
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        cia[0x20 + i / 8] |= 0x80 >> (i % 8);
+    }
+
+    // Ticket and TMD, each with a fake RSA-2048 signature
+    const u32_be signature_type = FileSys::TMDSignatureType::Rsa2048Sha256;
+    std::memcpy(&cia[ticket_offset], &signature_type, sizeof(signature_type));
+    FileSys::Ticket::Body ticket{};
+    ticket.title_id = test_title_id;
+    if (title_key) {
+        std::array<u8, 16> iv{};
+        std::memcpy(iv.data(), &ticket.title_id, sizeof(ticket.title_id));
+        const auto common_key = HW::AES::GetCommonKey(0).value();
+        const auto encrypted =
+            ApplyCBC(true, common_key, iv, {title_key->begin(), title_key->end()});
+        std::copy(encrypted.begin(), encrypted.end(), ticket.title_key.begin());
+    }
+    std::memcpy(&cia[ticket_offset + signature_block_size], &ticket, sizeof(ticket));
+
+    std::memcpy(&cia[tmd_offset], &signature_type, sizeof(signature_type));
+    FileSys::TitleMetadata::Body tmd{};
+    tmd.title_id = test_title_id;
+    tmd.content_count = static_cast<u16>(contents.size());
+    std::memcpy(&cia[tmd_offset + signature_block_size], &tmd, sizeof(tmd));
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        FileSys::TitleMetadata::ContentChunk chunk{};
+        chunk.id = static_cast<u32>(i);
+        chunk.index = static_cast<u16>(i);
+        chunk.type = title_key ? FileSys::TMDContentTypeFlag::Encrypted : 0;
+        chunk.size = contents[i].size();
+        CryptoPP::SHA256().CalculateDigest(chunk.hash.data(), contents[i].data(),
+                                           contents[i].size());
+        if (i == corrupt_content) {
+            chunk.hash[0] ^= 0xFF;
+        }
+        std::memcpy(&cia[tmd_offset + signature_block_size + sizeof(tmd) + i * sizeof(chunk)],
+                    &chunk, sizeof(chunk));
+    }
+
+    for (std::size_t i = 0; i < contents.size(); i++) {
+        if (title_key) {
+            std::array<u8, 16> iv{};
+            const u16_be index = static_cast<u16>(i);
+            std::memcpy(iv.data(), &index, sizeof(index));
+            const auto encrypted = ApplyCBC(true, *title_key, iv, contents[i]);
+            cia.insert(cia.end(), encrypted.begin(), encrypted.end());
+        } else {
+            cia.insert(cia.end(), contents[i].begin(), contents[i].end());
+        }
+    }
+    return cia;
+}
+
+/// Writes an unencrypted CIA holding the given contents, see MakeCIA
+void BuildCIA(const std::string& path, const std::vector<std::vector<u8>>& contents,
+              std::optional<std::size_t> corrupt_content = {}) {
+    const std::vector<u8> cia = MakeCIA(contents, corrupt_content);
+    FileUtil::IOFile file(path, "wb");
+    REQUIRE(file.WriteBytes(cia.data(), cia.size()) == cia.size());
+}
+
+std::vector<std::vector<u8>> MakeContents(const std::vector<std::size_t>& sizes) {
+    std::mt19937 rng(1234);
+    std::vector<std::vector<u8>> contents;
+    for (const std::size_t size : sizes) {
+        std::vector<u8>& content = contents.emplace_back(size);
+        for (auto& byte : content) {
+            byte = static_cast<u8>(rng());
+        }
+    }
+    return contents;
+}
+
+std::string GetTestTitlePath() {
+    return Service::AM::GetTitlePath(Service::FS::MediaType::SDMC, test_title_id);
+}
+
+std::vector<u8> ReadContent(u16 index) {
+    const auto path =
+        Service::AM::GetTitleContentPath(Service::FS::MediaType::SDMC, test_title_id, index);
+    FileUtil::IOFile file(path, "rb");
+    REQUIRE(file.IsOpen());
+    std::vector<u8> installed(file.GetSize());
+    file.ReadBytes(installed.data(), installed.size());
+    return installed;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("InstallCIA installs every content of a CIA", "[core][am]") {
+    const std::string cia_path = "./cia_install_test.cia";
+    // Sizes straddle the 1 MiB read buffer so that reads span content boundaries
+    const auto contents = MakeContents({0x180000, 0x30, 0x2345F0, 0x100000});
+    BuildCIA(cia_path, contents);
+
+    std::size_t last_progress = 0;
+    const auto status = Service::AM::InstallCIA(
+        cia_path, [&](std::size_t done, std::size_t total) { last_progress = done; });
+    REQUIRE(status == Service::AM::InstallStatus::Success);
+    REQUIRE(last_progress == FileUtil::GetSize(cia_path));
+
+    for (u16 i = 0; i < contents.size(); i++) {
+        REQUIRE(ReadContent(i) == contents[i]);
+    }
+
+    FileUtil::DeleteDirRecursively(GetTestTitlePath());
+    FileUtil::Delete(cia_path);
+}
+
+TEST_CASE("CIAFile decrypts contents written in pieces of any size", "[core][am]") {
+    // A fixed common key 0, so that the ticket can carry a known title key
+    HW::AES::InitKeys();
+    HW::AES::SetKeyX(HW::AES::KeySlotID::TicketCommonKey, HW::AES::AESKey{0x11, 0x22, 0x33});
+    HW::AES::SetCommonKeyY(0, HW::AES::AESKey{0x44, 0x55, 0x66});
+    const HW::AES::AESKey title_key{0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+                                    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+
+    const auto contents = MakeContents({0x12340, 0x30, 0x20010});
+    const std::vector<u8> cia = MakeCIA(contents, {}, title_key);
+    std::size_t content_offset = cia.size();
+    for (const auto& content : contents) {
+        content_offset -= content.size();
+    }
+
+    // Everything before the contents is written at once, the contents in pieces which split
+    // cipher blocks, so that the CBC state has to be carried from one piece to the next
+    Service::AM::CIAFile cia_file(Service::FS::MediaType::SDMC);
+    REQUIRE(cia_file.Write(0, content_offset, true, cia.data()).Succeeded());
+    constexpr std::array<std::size_t, 5> piece_sizes{1, 0x7, 0x3FF5, 0x13, 0x1001};
+    std::size_t offset = content_offset;
+    for (std::size_t i = 0; offset < cia.size(); i++) {
+        const std::size_t size = std::min(piece_sizes[i % piece_sizes.size()], cia.size() - offset);
+        REQUIRE(cia_file.Write(offset, size, true, cia.data() + offset).Succeeded());
+        offset += size;
+    }
+    REQUIRE(cia_file.IsComplete());
+    cia_file.Close();
+
+    offset = content_offset;
+    for (u16 i = 0; i < contents.size(); i++) {
+        const std::vector<u8> encrypted(cia.begin() + offset,
+                                        cia.begin() + offset + contents[i].size());
+        const std::array<u8, 16> iv{0, static_cast<u8>(i)};
+        const std::vector<u8> installed = ReadContent(i);
+        REQUIRE(installed == ApplyCBC(false, title_key, iv, encrypted));
+        REQUIRE(installed == contents[i]);
+        offset += contents[i].size();
+    }
+
+    FileUtil::DeleteDirRecursively(GetTestTitlePath());
+}
+
+TEST_CASE("InstallCIA rejects contents not matching the TMD", "[core][am]") {
+    const std::string cia_path = "./cia_install_corrupt.cia";
+    BuildCIA(cia_path, MakeContents({0x10000, 0x20000}), 1);
+
+    REQUIRE(Service::AM::InstallCIA(cia_path) == Service::AM::InstallStatus::ErrorInvalid);
+    REQUIRE(!FileUtil::Exists(GetTestTitlePath()));
+
+    FileUtil::Delete(cia_path);
+}
+
+TEST_CASE("InstallCIA throughput", "[.][benchmark]") {
+    const std::string cia_path = "./cia_install_benchmark.cia";
+    BuildCIA(cia_path, MakeContents({0x4000000, 0x4000000, 0x1000000, 0x4000000}));
+    const auto size = FileUtil::GetSize(cia_path);
+
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(Service::AM::InstallCIA(cia_path) == Service::AM::InstallStatus::Success);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Installed " << size / (1024.0 * 1024.0) << " MiB at "
+              << size / (1024.0 * 1024.0) / elapsed.count() << " MiB/s\n";
+
+    FileUtil::DeleteDirRecursively(GetTestTitlePath());
+    FileUtil::Delete(cia_path);
+}
@@ -0,0 +1,212 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/color.h"
+#include "core/hw/display_transfer.h"
+#include "video_core/utils.h"
+
+using GPU::Regs;
+using PixelFormat = Regs::PixelFormat;
+using Config = Regs::DisplayTransferConfig;
+
+namespace {
+
+Common::Vec4<u8> DecodePixel(PixelFormat format, const u8* src_pixel) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return Color::DecodeRGBA8(src_pixel);
+    case PixelFormat::RGB8:
+        return Color::DecodeRGB8(src_pixel);
+    case PixelFormat::RGB565:
+        return Color::DecodeRGB565(src_pixel);
+    case PixelFormat::RGB5A1:
+        return Color::DecodeRGB5A1(src_pixel);
+    default:
+        return Color::DecodeRGBA4(src_pixel);
+    }
+}
+
+void EncodePixel(PixelFormat format, const Common::Vec4<u8>& color, u8* dst_pixel) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        Color::EncodeRGBA8(color, dst_pixel);
+        break;
+    case PixelFormat::RGB8:
+        Color::EncodeRGB8(color, dst_pixel);
+        break;
+    case PixelFormat::RGB565:
+        Color::EncodeRGB565(color, dst_pixel);
+        break;
+    case PixelFormat::RGB5A1:
+        Color::EncodeRGB5A1(color, dst_pixel);
+        break;
+    default:
+        Color::EncodeRGBA4(color, dst_pixel);
+        break;
+    }
+}
+
+/// The per-pixel display transfer loop the specialized row kernels replaced
+void ReferenceTransfer(const Config& config, const u8* src_pointer, u8* dst_pointer,
+                       u32 output_width, u32 output_height) {
+    const u32 src_bytes_per_pixel = Regs::BytesPerPixel(config.input_format);
+    const u32 dst_bytes_per_pixel = Regs::BytesPerPixel(config.output_format);
+    const int horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const int vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+
+    for (u32 y = 0; y < output_height; ++y) {
+        for (u32 x = 0; x < output_width; ++x) {
+            const u32 input_x = x << horizontal_scale;
+            const u32 input_y = y << vertical_scale;
+            const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+            u32 src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
+            if (!config.input_linear) {
+                src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
+                             (input_y & ~7) * config.input_width * src_bytes_per_pixel;
+            }
+            u32 dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+            if (config.input_linear != config.dont_swizzle) {
+                dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                             (output_y & ~7) * output_width * dst_bytes_per_pixel;
+            }
+
+            const u8* src_pixel = src_pointer + src_offset;
+            Common::Vec4<u8> src_color = DecodePixel(config.input_format, src_pixel);
+            if (config.scaling == config.ScaleX) {
+                Common::Vec4<u8> pixel =
+                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
+                src_color = ((src_color + pixel) / 2).Cast<u8>();
+            } else if (config.scaling == config.ScaleXY) {
+                Common::Vec4<u8> pixel1 =
+                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
+                Common::Vec4<u8> pixel2 =
+                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
+                Common::Vec4<u8> pixel3 =
+                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
+                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+            }
+
+            EncodePixel(config.output_format, src_color, dst_pointer + dst_offset);
+        }
+    }
+}
+
+Config MakeConfig(PixelFormat input_format, PixelFormat output_format, u32 width, u32 height,
+                  Config::ScalingMode scaling, bool input_linear, bool dont_swizzle,
+                  bool flip_vertically) {
+    Config config{};
+    config.input_width.Assign(width);
+    config.input_height.Assign(height);
+    config.output_width.Assign(width);
+    config.output_height.Assign(height);
+    config.input_format.Assign(input_format);
+    config.output_format.Assign(output_format);
+    config.scaling.Assign(scaling);
+    config.input_linear.Assign(input_linear);
+    config.dont_swizzle.Assign(dont_swizzle);
+    config.flip_vertically.Assign(flip_vertically);
+    return config;
+}
+
+std::vector<u8> RandomBytes(std::size_t size, std::mt19937& rng) {
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<u8> bytes(size);
+    for (u8& byte : bytes) {
+        byte = static_cast<u8>(dist(rng));
+    }
+    return bytes;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Display transfer rows match the per-pixel conversion", "[core][gpu]") {
+    constexpr std::array<PixelFormat, 5> formats = {PixelFormat::RGBA8, PixelFormat::RGB8,
+                                                    PixelFormat::RGB565, PixelFormat::RGB5A1,
+                                                    PixelFormat::RGBA4};
+    constexpr u32 width = 64;
+    constexpr u32 height = 32;
+    std::mt19937 rng(1234);
+    const std::vector<u8> src = RandomBytes(width * height * 4, rng);
+
+    for (PixelFormat input_format : formats) {
+        for (PixelFormat output_format : formats) {
+            const auto convert_rows = GPU::GetDisplayTransferRows(input_format, output_format);
+            REQUIRE(convert_rows != nullptr);
+
+            for (int layout = 0; layout < 4; ++layout) {
+                const bool input_linear = (layout & 1) != 0;
+                const bool dont_swizzle = (layout & 2) != 0;
+                for (const auto scaling : {Config::NoScale, Config::ScaleX, Config::ScaleXY}) {
+                    if (input_linear && scaling != Config::NoScale) {
+                        continue;
+                    }
+                    const Config config =
+                        MakeConfig(input_format, output_format, width, height, scaling,
+                                   input_linear, dont_swizzle, (layout + scaling) % 2 == 1);
+                    const u32 output_width = width >> (scaling != Config::NoScale ? 1 : 0);
+                    const u32 output_height = height >> (scaling == Config::ScaleXY ? 1 : 0);
+                    const std::size_t dst_size =
+                        output_width * output_height * Regs::BytesPerPixel(output_format);
+
+                    std::vector<u8> expected(dst_size, 0xCD);
+                    std::vector<u8> actual(dst_size, 0xCD);
+                    ReferenceTransfer(config, src.data(), expected.data(), output_width,
+                                      output_height);
+                    // Convert in two bands, the way the transfer thread pool splits the work
+                    convert_rows(config, src.data(), actual.data(), output_width, output_height,
+                                 0, 8);
+                    convert_rows(config, src.data(), actual.data(), output_width, output_height,
+                                 8, output_height);
+                    REQUIRE(actual == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Display transfer throughput", "[.][benchmark]") {
+    constexpr u32 width = 400;
+    constexpr u32 height = 240;
+    constexpr int iterations = 100;
+    std::mt19937 rng(1234);
+    const std::vector<u8> src = RandomBytes(width * height * 4, rng);
+    std::vector<u8> dst(width * height * 4);
+
+    const auto Measure = [&](const char* name, Config::ScalingMode scaling) {
+        const Config config = MakeConfig(PixelFormat::RGBA8, PixelFormat::RGB8, width, height,
+                                         scaling, false, false, false);
+        const u32 output_width = width >> (scaling != Config::NoScale ? 1 : 0);
+        const u32 output_height = height >> (scaling == Config::ScaleXY ? 1 : 0);
+        const auto convert_rows = GPU::GetDisplayTransferRows(config.input_format,
+                                                              config.output_format);
+
+        const auto Time = [&](const char* variant, auto&& transfer) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                transfer();
+            }
+            const std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            std::cout << name << " " << variant << ": "
+                      << static_cast<double>(width) * height * iterations / elapsed.count() / 1e6
+                      << " Mpixels/s\n";
+        };
+        Time("per pixel", [&] {
+            ReferenceTransfer(config, src.data(), dst.data(), output_width, output_height);
+        });
+        Time("rows", [&] {
+            convert_rows(config, src.data(), dst.data(), output_width, output_height, 0,
+                         output_height);
+        });
+    };
+    Measure("RGBA8 tiled -> RGB8 linear", Config::NoScale);
+    Measure("RGBA8 tiled -> RGB8 linear, 2x2 box filter", Config::ScaleXY);
+}
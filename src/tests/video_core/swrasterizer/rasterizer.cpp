@@ -0,0 +1,140 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <catch2/catch.hpp>
+#include "video_core/swrasterizer/rasterizer.h"
+
+using Pica::Rasterizer::GetSpanCoverage;
+using Pica::Rasterizer::SpanWidth;
+
+namespace {
+
+struct Point {
+    int x;
+    int y;
+};
+
+/// Edge function of the edge from a to b, like the rasterizer's SignedArea
+int EdgeFunction(const Point& a, const Point& b, const Point& p) {
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+/// A counter-clockwise triangle in 12.4 fixed point, with its bounding box in pixels
+struct Triangle {
+    std::array<Point, 3> vertices;
+    int width;
+    int height;
+};
+
+bool IsCovered(const Triangle& triangle, const Point& p) {
+    const auto& v = triangle.vertices;
+    return EdgeFunction(v[1], v[2], p) >= 0 && EdgeFunction(v[2], v[0], p) >= 0 &&
+           EdgeFunction(v[0], v[1], p) >= 0;
+}
+
+/// Counts the covered pixels by evaluating the edge functions at every pixel
+std::size_t CountCoveredPerPixel(const Triangle& triangle) {
+    std::size_t covered = 0;
+    for (int y = 8; y < triangle.height * 16; y += 16) {
+        for (int x = 8; x < triangle.width * 16; x += 16) {
+            covered += IsCovered(triangle, {x, y}) ? 1 : 0;
+        }
+    }
+    return covered;
+}
+
+/// Counts the covered pixels the way ProcessTriangle walks the bounding box, a span at a time
+std::size_t CountCoveredBySpans(const Triangle& triangle) {
+    const auto& v = triangle.vertices;
+    const std::array<int, 3> step_x = {
+        -(v[2].y - v[1].y) * 16,
+        -(v[0].y - v[2].y) * 16,
+        -(v[1].y - v[0].y) * 16,
+    };
+    std::size_t covered = 0;
+    for (int y = 8; y < triangle.height * 16; y += 16) {
+        std::array<int, 3> w = {
+            EdgeFunction(v[1], v[2], {8, y}),
+            EdgeFunction(v[2], v[0], {8, y}),
+            EdgeFunction(v[0], v[1], {8, y}),
+        };
+        for (int x = 0; x < triangle.width; x += SpanWidth) {
+            u32 coverage = GetSpanCoverage(w, step_x);
+            const int remaining = triangle.width - x;
+            if (remaining < SpanWidth)
+                coverage &= (1u << remaining) - 1;
+            for (; coverage != 0; coverage &= coverage - 1)
+                covered++;
+            for (std::size_t edge = 0; edge < w.size(); ++edge)
+                w[edge] += step_x[edge] * SpanWidth;
+        }
+    }
+    return covered;
+}
+
+std::array<Triangle, 3> SyntheticTriangles() {
+    return {{
+        // Large and axis aligned, most spans fully covered
+        {{{{0, 0}, {256 * 16, 0}, {0, 256 * 16}}}, 256, 256},
+        // Thin sliver, most spans partially covered
+        {{{{0, 0}, {256 * 16, 8 * 16}, {0, 16 * 16}}}, 256, 16},
+        // Small and oddly placed, spans straddle every edge
+        {{{{37, 21}, {9 * 16 + 5, 3 * 16 + 11}, {2 * 16 + 3, 7 * 16 + 13}}}, 10, 8},
+    }};
+}
+
+} // Anonymous namespace
+
+TEST_CASE("GetSpanCoverage matches per-pixel edge tests", "[video_core][swrasterizer]") {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> value_dist(-4096, 4096);
+    std::uniform_int_distribution<int> step_dist(-512, 512);
+    for (int i = 0; i < 10000; i++) {
+        const std::array<int, 3> w = {value_dist(rng), value_dist(rng), value_dist(rng)};
+        const std::array<int, 3> step_x = {step_dist(rng), step_dist(rng), step_dist(rng)};
+
+        u32 expected = 0;
+        for (int pixel = 0; pixel < SpanWidth; pixel++) {
+            if (w[0] + pixel * step_x[0] >= 0 && w[1] + pixel * step_x[1] >= 0 &&
+                w[2] + pixel * step_x[2] >= 0)
+                expected |= 1u << pixel;
+        }
+        REQUIRE(GetSpanCoverage(w, step_x) == expected);
+    }
+
+    for (const Triangle& triangle : SyntheticTriangles()) {
+        REQUIRE(CountCoveredBySpans(triangle) == CountCoveredPerPixel(triangle));
+    }
+}
+
+TEST_CASE("Triangle coverage throughput", "[.][benchmark]") {
+    constexpr int iterations = 200;
+
+    for (const Triangle& triangle : SyntheticTriangles()) {
+        const auto Measure = [&](const char* name, std::size_t (*count)(const Triangle&)) {
+            std::size_t covered = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++) {
+                // Move the triangle by a subpixel amount each time, so that no work is reused
+                Triangle moved = triangle;
+                for (Point& vertex : moved.vertices) {
+                    vertex.x += i % 16;
+                }
+                covered += count(moved);
+            }
+            const std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            const double pixels = static_cast<double>(triangle.width) * triangle.height;
+            std::cout << triangle.width << "x" << triangle.height << " " << name << ": "
+                      << pixels * iterations / elapsed.count() / 1e6 << " Mpixels/s ("
+                      << covered / iterations << " covered)\n";
+        };
+        Measure("per pixel", CountCoveredPerPixel);
+        Measure("spans", CountCoveredBySpans);
+    }
+}
@@ -0,0 +1,24 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <catch2/catch.hpp>
+#include "common/vector_math.h"
+#include "video_core/regs_texturing.h"
+#include "video_core/swrasterizer/texturing.h"
+
+using Operation = Pica::TexturingRegs::TevStageConfig::Operation;
+
+TEST_CASE("TEV combiners saturate", "[video_core][swrasterizer]") {
+    const Common::Vec3<u8> bright[3] = {{200, 100, 0}, {100, 200, 0}, {255, 255, 255}};
+    const auto combine = [&bright](Operation op) {
+        const Common::Vec3<u8> result = Pica::Rasterizer::ColorCombine(op, bright);
+        return std::array<int, 3>{result.r(), result.g(), result.b()};
+    };
+    REQUIRE(combine(Operation::Add) == std::array<int, 3>{255, 255, 0});
+    REQUIRE(combine(Operation::Subtract) == std::array<int, 3>{100, 0, 0});
+    REQUIRE(combine(Operation::AddSigned) == std::array<int, 3>{172, 172, 0});
+    REQUIRE(Pica::Rasterizer::AlphaCombine(Operation::MultiplyThenAdd, {255, 255, 1}) == 255);
+    REQUIRE(Pica::Rasterizer::AlphaCombine(Operation::AddThenMultiply, {200, 100, 255}) == 255);
+}
@@ -552,12 +552,27 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             const auto rect = GetSubRect(FromInterval(load_interval));
             ASSERT(FromInterval(load_interval).GetInterval() == load_interval);
 
-            for (unsigned y = rect.bottom; y < rect.top; ++y) {
-                for (unsigned x = rect.left; x < rect.right; ++x) {
-                    auto vec4 =
-                        Pica::Texture::LookupTexture(texture_src_data, x, height - 1 - y, tex_info);
-                    const std::size_t offset = (x + (width * y)) * 4;
-                    std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
+            if (rect.left % 8 == 0 && rect.right % 8 == 0 && rect.bottom % 8 == 0 &&
+                rect.top % 8 == 0) {
+                // Decode whole tiles, writing their rows bottom to top to flip them for OpenGL
+                const std::size_t tile_size = Pica::Texture::CalculateTileSize(tex_info.format);
+                auto* const gl_texels = reinterpret_cast<Common::Vec4<u8>*>(gl_buffer.data());
+                for (unsigned y = height - rect.top; y < height - rect.bottom; y += 8) {
+                    const u8* line = texture_src_data + (y / 8) * tex_info.stride;
+                    for (unsigned x = rect.left; x < rect.right; x += 8) {
+                        Pica::Texture::DecodeTile(line + (x / 8) * tile_size, tex_info,
+                                                  gl_texels + x + width * (height - 1 - y),
+                                                  -static_cast<std::ptrdiff_t>(width));
+                    }
+                }
+            } else {
+                for (unsigned y = rect.bottom; y < rect.top; ++y) {
+                    for (unsigned x = rect.left; x < rect.right; ++x) {
+                        auto vec4 = Pica::Texture::LookupTexture(texture_src_data, x,
+                                                                 height - 1 - y, tex_info);
+                        const std::size_t offset = (x + (width * y)) * 4;
+                        std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
+                    }
                 }
             }
         } else {
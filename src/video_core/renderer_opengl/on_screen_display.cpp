@@ -344,8 +344,12 @@ void RasterFont::AddMessage(const std::string& message, MessageType type, u32 du
 void RasterFont::UpdateDebugInfo() {
     Core::PerfStats::Results stats = Core::System::GetInstance().GetAndResetPerfStats();
     std::string text = fmt::format(
-        "FPS:{:>2} - VPS:{:>2} - SPD:{:>2}", static_cast<int>(stats.game_fps),
-        static_cast<int>(stats.system_fps), static_cast<int>(stats.emulation_speed * 100.0));
+        "FPS:{:>2} - VPS:{:>2} - SPD:{:>2} - AUD:{:>2}ms", static_cast<int>(stats.game_fps),
+        static_cast<int>(stats.system_fps), static_cast<int>(stats.emulation_speed * 100.0),
+        static_cast<int>(stats.audio_latency_ms));
+    if (stats.audio_underruns != 0 || stats.audio_overruns != 0) {
+        text += fmt::format(" ({}U/{}O)", stats.audio_underruns, stats.audio_overruns);
+    }
 
     AddMessage(text, MessageType::FPS, Duration::FOREVER, Color::BLUE);
 }
@@ -4,6 +4,13 @@
 
 #pragma once
 
+#include <array>
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
+#include "common/common_types.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Rasterizer {
@@ -39,6 +46,52 @@ struct Vertex : Shader::OutputVertex {
     }
 };
 
-void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+class TextureCache;
+
+/// Number of horizontally adjacent pixels whose coverage is tested at once
+constexpr int SpanWidth = 4;
+
+/**
+ * Evaluates the three edge functions for a span of SpanWidth horizontally adjacent pixels.
+ *
+ * @param w Values of the edge functions at the first pixel of the span
+ * @param step_x Change of each edge function when moving one pixel to the right
+ * @return Bitmask with bit i set if the i-th pixel of the span is covered by the triangle
+ */
+inline u32 GetSpanCoverage(const std::array<int, 3>& w, const std::array<int, 3>& step_x) {
+#if defined(ARCHITECTURE_x86_64)
+    __m128i outside = _mm_setzero_si128();
+    for (std::size_t edge = 0; edge < w.size(); ++edge) {
+        const int step = step_x[edge];
+        const __m128i values =
+            _mm_add_epi32(_mm_set1_epi32(w[edge]), _mm_setr_epi32(0, step, step * 2, step * 3));
+        outside = _mm_or_si128(outside, values);
+    }
+    // A pixel is covered if none of its edge function values is negative
+    return ~static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(outside))) & 0xF;
+#elif defined(ARCHITECTURE_ARM64)
+    int32x4_t outside = vdupq_n_s32(0);
+    for (std::size_t edge = 0; edge < w.size(); ++edge) {
+        const int step = step_x[edge];
+        const int32_t offsets[4] = {0, step, step * 2, step * 3};
+        outside = vorrq_s32(outside, vaddq_s32(vdupq_n_s32(w[edge]), vld1q_s32(offsets)));
+    }
+    // A pixel is covered if none of its edge function values is negative
+    const uint32x4_t sign = vshrq_n_u32(vreinterpretq_u32_s32(outside), 31);
+    const int32_t lane_shift[4] = {0, 1, 2, 3};
+    const u32 outside_mask = vaddvq_u32(vshlq_u32(sign, vld1q_s32(lane_shift)));
+    return ~outside_mask & 0xF;
+#else
+    u32 coverage = 0;
+    for (int i = 0; i < SpanWidth; ++i) {
+        if (w[0] + i * step_x[0] >= 0 && w[1] + i * step_x[1] >= 0 && w[2] + i * step_x[2] >= 0)
+            coverage |= 1u << i;
+    }
+    return coverage;
+#endif
+}
+
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     TextureCache& texture_cache);
 
 } // namespace Pica::Rasterizer
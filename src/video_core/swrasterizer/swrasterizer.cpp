@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "core/hw/gpu.h"
+#include "video_core/pica_state.h"
+#include "video_core/regs_framebuffer.h"
 #include "video_core/swrasterizer/clipper.h"
 #include "video_core/swrasterizer/swrasterizer.h"
 
@@ -10,7 +13,31 @@ namespace VideoCore {
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v1,
                                const Pica::Shader::OutputVertex& v2) {
-    Pica::Clipper::ProcessTriangle(v0, v1, v2);
+    Pica::Clipper::ProcessTriangle(v0, v1, v2, texture_cache);
+}
+
+void SWRasterizer::DrawTriangles() {
+    // The framebuffer is written directly to emulated memory, so textures decoded from it (e.g.
+    // when rendering to a texture) are stale now.
+    const auto& framebuffer = Pica::g_state.regs.framebuffer.framebuffer;
+    const u32 num_pixels = framebuffer.GetWidth() * framebuffer.GetHeight();
+    texture_cache.InvalidateRegion(
+        framebuffer.GetColorBufferPhysicalAddress(),
+        num_pixels * GPU::Regs::BytesPerPixel(
+                         GPU::Regs::PixelFormat(framebuffer.color_format.Value())));
+    texture_cache.InvalidateRegion(
+        framebuffer.GetDepthBufferPhysicalAddress(),
+        num_pixels * Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format));
+
+    texture_cache.Trim();
+}
+
+void SWRasterizer::InvalidateRegion(PAddr addr, u32 size) {
+    texture_cache.InvalidateRegion(addr, size);
+}
+
+void SWRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    texture_cache.InvalidateRegion(addr, size);
 }
 
 } // namespace VideoCore
@@ -6,6 +6,7 @@
 
 #include "common/common_types.h"
 #include "video_core/rasterizer_interface.h"
+#include "video_core/swrasterizer/texture_cache.h"
 
 namespace Pica::Shader {
 struct OutputVertex;
@@ -16,12 +17,15 @@ namespace VideoCore {
 class SWRasterizer : public RasterizerInterface {
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
-    void DrawTriangles() override {}
+    void DrawTriangles() override;
     void NotifyPicaRegisterChanged(u32 id) override {}
     void FlushAll() override {}
     void FlushRegion(PAddr addr, u32 size) override {}
-    void InvalidateRegion(PAddr addr, u32 size) override {}
-    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+    void InvalidateRegion(PAddr addr, u32 size) override;
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+
+private:
+    Pica::Rasterizer::TextureCache texture_cache;
 };
 
 } // namespace VideoCore
@@ -0,0 +1,124 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <functional>
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/memory.h"
+#include "video_core/swrasterizer/texture_cache.h"
+#include "video_core/video_core.h"
+
+namespace Pica::Rasterizer {
+
+MICROPROFILE_DEFINE(GPU_SWTextureDecode, "GPU", "Texture Decode", MP_RGB(100, 100, 240));
+
+TextureCache::~TextureCache() {
+    InvalidateAll();
+}
+
+const CachedTexture& TextureCache::GetTexture(const Texture::TextureInfo& info) {
+    const Key key = GetKey(info);
+    auto lookup = texture_lookup.find(key);
+    Iterator it;
+    if (lookup == texture_lookup.end()) {
+        MICROPROFILE_SCOPE(GPU_SWTextureDecode);
+
+        const std::size_t size = info.width * info.height * sizeof(Common::Vec4<u8>);
+        MakeRoom(size);
+
+        CachedTexture texture;
+        texture.info = info;
+        texture.texels.resize(info.width * info.height);
+
+        const u8* source = VideoCore::Memory()->GetPhysicalPointer(info.physical_address);
+        if (source != nullptr) {
+            Texture::DecodeTexture(source, info, texture.texels.data());
+        } else {
+            LOG_ERROR(HW_GPU, "Texture at invalid address {:08X}", info.physical_address);
+        }
+
+        UpdatePagesCachedCount(info.physical_address, texture.GetSourceSize(), 1);
+        decoded_size += size;
+        it = textures.insert(textures.end(), std::move(texture));
+        texture_lookup.emplace(key, it);
+    } else {
+        it = lookup->second;
+        textures.splice(textures.end(), textures, it);
+    }
+
+    it->last_use = ++use_counter;
+    return *it;
+}
+
+void TextureCache::InvalidateRegion(PAddr addr, u32 size) {
+    const PAddr end = addr + size;
+    for (auto it = textures.begin(); it != textures.end();) {
+        const PAddr texture_start = it->info.physical_address;
+        const PAddr texture_end = texture_start + it->GetSourceSize();
+        if (texture_start < end && addr < texture_end) {
+            it = Erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TextureCache::InvalidateAll() {
+    for (auto it = textures.begin(); it != textures.end();) {
+        it = Erase(it);
+    }
+}
+
+void TextureCache::Trim() {
+    while (decoded_size > MaxDecodedSize) {
+        Erase(textures.begin());
+    }
+    trim_use_counter = use_counter;
+}
+
+TextureCache::Key TextureCache::GetKey(const Texture::TextureInfo& info) {
+    return {info.physical_address, info.width, info.height, info.format};
+}
+
+void TextureCache::MakeRoom(std::size_t size) {
+    // Textures used since the last Trim() may still be referenced by the draw in progress
+    while (decoded_size + size > MaxDecodedSize && !textures.empty() &&
+           textures.front().last_use <= trim_use_counter) {
+        Erase(textures.begin());
+    }
+}
+
+TextureCache::Iterator TextureCache::Erase(Iterator it) {
+    UpdatePagesCachedCount(it->info.physical_address, it->GetSourceSize(), -1);
+    decoded_size -= it->texels.size() * sizeof(Common::Vec4<u8>);
+    texture_lookup.erase(GetKey(it->info));
+    return textures.erase(it);
+}
+
+void TextureCache::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
+    if (size == 0) {
+        return;
+    }
+
+    const u32 page_start = addr >> Memory::PAGE_BITS;
+    const u32 page_end = (addr + size - 1) >> Memory::PAGE_BITS;
+    for (u32 page = page_start; page <= page_end; ++page) {
+        const PAddr page_addr = page << Memory::PAGE_BITS;
+        if (delta > 0) {
+            if (cached_pages[page]++ == 0) {
+                VideoCore::Memory()->RasterizerMarkRegionCached(page_addr, Memory::PAGE_SIZE,
+                                                                true);
+            }
+        } else {
+            const auto count = cached_pages.find(page);
+            if (--count->second == 0) {
+                cached_pages.erase(count);
+                VideoCore::Memory()->RasterizerMarkRegionCached(page_addr, Memory::PAGE_SIZE,
+                                                                false);
+            }
+        }
+    }
+}
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,90 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/regs_texturing.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace Pica::Rasterizer {
+
+/// A texture decoded from its tiled PICA format to linear RGBA8
+struct CachedTexture {
+    Texture::TextureInfo info;
+    /// Decoded texels, laid out row by row with the same coordinates LookupTexture takes
+    std::vector<Common::Vec4<u8>> texels;
+    /// Value of the cache's use counter when this texture was last requested
+    u64 last_use = 0;
+
+    Common::Vec4<u8> Lookup(unsigned int x, unsigned int y) const {
+        return texels[y * info.width + x];
+    }
+
+    /// Returns the size of the texture's source data in emulated memory
+    u32 GetSourceSize() const {
+        return static_cast<u32>(info.stride * (info.height / 8));
+    }
+};
+
+/**
+ * Caches textures used by the software rasterizer in decoded form, so that sampling does not
+ * have to decode texels from the tiled source format (ETC1, 4-bit formats, ...) over and over.
+ *
+ * The pages backing cached textures are marked as rasterizer-cached, so CPU writes to them end up
+ * in InvalidateRegion just like they do for the OpenGL rasterizer cache.
+ */
+class TextureCache {
+public:
+    /// Upper bound for the memory used by decoded textures, enforced in Trim()
+    static constexpr std::size_t MaxDecodedSize = 64 * 1024 * 1024;
+
+    /// Drops all cached textures, so that their pages are no longer marked as cached
+    ~TextureCache();
+
+    /**
+     * Returns the decoded texture described by `info`, decoding it first if it isn't cached.
+     * Decoding a texture evicts textures which have not been used since the last Trim() to stay
+     * within MaxDecodedSize, so the returned reference stays valid until the next call to Trim()
+     * or an invalidation.
+     */
+    const CachedTexture& GetTexture(const Texture::TextureInfo& info);
+
+    /// Drops all cached textures overlapping the given region of emulated memory
+    void InvalidateRegion(PAddr addr, u32 size);
+
+    /// Drops all cached textures
+    void InvalidateAll();
+
+    /// Evicts the least recently used textures until the cache fits into MaxDecodedSize
+    void Trim();
+
+private:
+    using Key = std::tuple<PAddr, u32, u32, TexturingRegs::TextureFormat>;
+    using Iterator = std::list<CachedTexture>::iterator;
+
+    static Key GetKey(const Texture::TextureInfo& info);
+    /// Evicts textures not used since the last Trim() until `size` more bytes fit into the limit
+    void MakeRoom(std::size_t size);
+    Iterator Erase(Iterator it);
+    void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
+
+    /// Cached textures, least recently used first
+    std::list<CachedTexture> textures;
+    std::map<Key, Iterator> texture_lookup;
+    std::unordered_map<u32, u32> cached_pages;
+    std::size_t decoded_size = 0;
+    u64 use_counter = 0;
+    /// Value of use_counter at the last call to Trim()
+    u64 trim_use_counter = 0;
+};
+
+} // namespace Pica::Rasterizer
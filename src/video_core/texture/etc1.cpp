@@ -69,19 +69,14 @@ union ETC1Tile {
         BitField<60, 4, u64> r1;
     } separate;
 
-    const Common::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
-        int texel = 4 * x + y;
-
-        if (flip)
-            std::swap(x, y);
-
-        // Lookup base value
+    /// Returns the base color of the first (x < 2 when not flipped) or second subtile half
+    Common::Vec3<int> GetBaseColor(bool second_half) const {
         Common::Vec3<int> ret;
         if (differential_mode) {
             ret.r() = static_cast<int>(differential.r);
             ret.g() = static_cast<int>(differential.g);
             ret.b() = static_cast<int>(differential.b);
-            if (x >= 2) {
+            if (second_half) {
                 ret.r() += static_cast<int>(differential.dr);
                 ret.g() += static_cast<int>(differential.dg);
                 ret.b() += static_cast<int>(differential.db);
@@ -90,7 +85,7 @@ union ETC1Tile {
             ret.g() = Color::Convert5To8(ret.g());
             ret.b() = Color::Convert5To8(ret.b());
         } else {
-            if (x < 2) {
+            if (!second_half) {
                 ret.r() = Color::Convert4To8(static_cast<u8>(separate.r1));
                 ret.g() = Color::Convert4To8(static_cast<u8>(separate.g1));
                 ret.b() = Color::Convert4To8(static_cast<u8>(separate.b1));
@@ -100,20 +95,45 @@ union ETC1Tile {
                 ret.b() = Color::Convert4To8(static_cast<u8>(separate.b2));
             }
         }
+        return ret;
+    }
 
-        // Add modifier
+    /// Applies the modifier of the given texel to the base color of its subtile half
+    Common::Vec3<u8> ApplyModifier(const Common::Vec3<int>& base, bool second_half,
+                                   unsigned texel) const {
         unsigned table_index =
-            static_cast<int>((x < 2) ? table_index_1.Value() : table_index_2.Value());
+            static_cast<int>(second_half ? table_index_2.Value() : table_index_1.Value());
 
         int modifier = etc1_modifier_table[table_index][GetTableSubIndex(texel)];
         if (GetNegationFlag(texel))
             modifier *= -1;
 
-        ret.r() = std::clamp(ret.r() + modifier, 0, 255);
-        ret.g() = std::clamp(ret.g() + modifier, 0, 255);
-        ret.b() = std::clamp(ret.b() + modifier, 0, 255);
+        return Common::MakeVec(std::clamp(base.r() + modifier, 0, 255),
+                               std::clamp(base.g() + modifier, 0, 255),
+                               std::clamp(base.b() + modifier, 0, 255))
+            .Cast<u8>();
+    }
+
+    const Common::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
+        int texel = 4 * x + y;
+
+        if (flip)
+            std::swap(x, y);
 
-        return ret.Cast<u8>();
+        const bool second_half = x >= 2;
+        return ApplyModifier(GetBaseColor(second_half), second_half, texel);
+    }
+
+    void GetAllRGB(std::array<Common::Vec3<u8>, 16>& dest) const {
+        // The base colors only depend on the subtile half, so look them up once for all texels
+        const std::array<Common::Vec3<int>, 2> base = {GetBaseColor(false), GetBaseColor(true)};
+
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                const bool second_half = (flip ? y : x) >= 2;
+                dest[x + 4 * y] = ApplyModifier(base[second_half], second_half, 4 * x + y);
+            }
+        }
     }
 };
 
@@ -124,4 +144,9 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, std::array<Common::Vec3<u8>, 16>& dest) {
+    ETC1Tile tile{value};
+    tile.GetAllRGB(dest);
+}
+
 } // namespace Pica::Texture
@@ -2,6 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/logging/log.h"
@@ -211,6 +217,298 @@ Common::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned in
     }
 }
 
+namespace {
+
+/// In-tile coordinates of the texels of an 8x8 tile, indexed by their position in Morton order
+constexpr std::array<std::array<u8, 2>, TILE_SIZE> MakeMortonDeinterleaveTable() {
+    std::array<std::array<u8, 2>, TILE_SIZE> table{};
+    for (u8 y = 0; y < 8; ++y) {
+        for (u8 x = 0; x < 8; ++x) {
+            table[VideoCore::MortonInterleave(x, y)] = {x, y};
+        }
+    }
+    return table;
+}
+
+constexpr auto morton_deinterleave = MakeMortonDeinterleaveTable();
+
+/// Decodes the texels of a tile in Morton order, `decode` maps a Morton index to its color
+template <typename DecodeFunc>
+void DecodeMortonTile(Common::Vec4<u8>* dest, std::ptrdiff_t dest_stride, DecodeFunc&& decode) {
+    for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+        const auto [x, y] = morton_deinterleave[i];
+        dest[x + y * dest_stride] = decode(i);
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+/**
+ * Stores four RGBA8 texels which are consecutive in Morton order. These always form a 2x2 block,
+ * so each store writes two texels of each of two destination rows.
+ */
+void StoreMortonQuad(Common::Vec4<u8>* dest, std::ptrdiff_t dest_stride, std::size_t i,
+                     __m128i texels) {
+    const auto [x, y] = morton_deinterleave[i];
+    Common::Vec4<u8>* row = dest + x + y * dest_stride;
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(row), texels);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(row + dest_stride), _mm_srli_si128(texels, 8));
+}
+
+/// Extracts the `bits` wide field at `shift` of every 32-bit lane and expands it to 8 bits
+template <int shift, int bits>
+__m128i ExpandField(__m128i texels) {
+    static_assert(bits >= 4 && bits <= 8);
+    const __m128i field =
+        _mm_and_si128(_mm_srli_epi32(texels, shift), _mm_set1_epi32((1 << bits) - 1));
+    return _mm_or_si128(_mm_slli_epi32(field, 8 - bits), _mm_srli_epi32(field, 2 * bits - 8));
+}
+
+/// Packs 8-bit components held in 32-bit lanes into RGBA8 texels
+__m128i PackRGBA(__m128i r, __m128i g, __m128i b, __m128i a) {
+    return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                        _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+}
+
+/**
+ * Decodes a tile of a 16-bit format four texels at a time. `decode` receives four texels zero
+ * extended to 32-bit lanes and returns them as RGBA8.
+ */
+template <typename DecodeFunc>
+void Decode16BitTile(const u8* source, Common::Vec4<u8>* dest, std::ptrdiff_t dest_stride,
+                     DecodeFunc&& decode) {
+    for (std::size_t i = 0; i < TILE_SIZE; i += 4) {
+        const __m128i texels = _mm_unpacklo_epi16(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i * 2)),
+            _mm_setzero_si128());
+        StoreMortonQuad(dest, dest_stride, i, decode(texels));
+    }
+}
+#endif
+
+void DecodeRGBA8Tile(const u8* source, Common::Vec4<u8>* dest, std::ptrdiff_t dest_stride,
+                     bool disable_alpha) {
+#ifdef ARCHITECTURE_x86_64
+    const __m128i byte_mask = _mm_set1_epi32(0x0000FF00);
+    const __m128i alpha_mask = _mm_set1_epi32(disable_alpha ? static_cast<int>(0xFF000000) : 0);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 4) {
+        const __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+
+        // Byte swap each texel, turning ABGR in memory into RGBA
+        __m128i swapped = _mm_or_si128(_mm_slli_epi32(texels, 24), _mm_srli_epi32(texels, 24));
+        swapped = _mm_or_si128(swapped, _mm_and_si128(_mm_srli_epi32(texels, 8), byte_mask));
+        swapped = _mm_or_si128(swapped, _mm_slli_epi32(_mm_and_si128(texels, byte_mask), 8));
+        swapped = _mm_or_si128(swapped, alpha_mask);
+
+        StoreMortonQuad(dest, dest_stride, i, swapped);
+    }
+#else
+    DecodeMortonTile(dest, dest_stride, [&](std::size_t i) -> Common::Vec4<u8> {
+        const u8* texel = source + i * 4;
+        return {texel[3], texel[2], texel[1], disable_alpha ? u8{255} : texel[0]};
+    });
+#endif
+}
+
+void DecodeRGB5A1Tile(const u8* source, Common::Vec4<u8>* dest, std::ptrdiff_t dest_stride,
+                      bool disable_alpha) {
+#ifdef ARCHITECTURE_x86_64
+    const __m128i alpha_mask = _mm_set1_epi32(disable_alpha ? 0xFF : 0);
+    Decode16BitTile(source, dest, dest_stride, [&](__m128i texels) {
+        // The alpha bit becomes 0 or 0xFF by negating it
+        const __m128i alpha = _mm_and_si128(
+            _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(texels, _mm_set1_epi32(1))),
+            _mm_set1_epi32(0xFF));
+        return PackRGBA(ExpandField<11, 5>(texels), ExpandField<6, 5>(texels),
+                        ExpandField<1, 5>(texels), _mm_or_si128(alpha, alpha_mask));
+    });
+#else
+    DecodeMortonTile(dest, dest_stride, [&](std::size_t i) {
+        auto res = Color::DecodeRGB5A1(source + i * 2);
+        return Common::MakeVec(res.r(), res.g(), res.b(), disable_alpha ? u8{255} : res.a());
+    });
+#endif
+}
+
+void DecodeRGB565Tile(const u8* source, Common::Vec4<u8>* dest, std::ptrdiff_t dest_stride) {
+#ifdef ARCHITECTURE_x86_64
+    Decode16BitTile(source, dest, dest_stride, [](__m128i texels) {
+        return PackRGBA(ExpandField<11, 5>(texels), ExpandField<5, 6>(texels),
+                        ExpandField<0, 5>(texels), _mm_set1_epi32(0xFF));
+    });
+#else
+    DecodeMortonTile(dest, dest_stride,
+                     [&](std::size_t i) { return Color::DecodeRGB565(source + i * 2); });
+#endif
+}
+
+void DecodeRGBA4Tile(const u8* source, Common::Vec4<u8>* dest, std::ptrdiff_t dest_stride,
+                     bool disable_alpha) {
+#ifdef ARCHITECTURE_x86_64
+    const __m128i alpha_mask = _mm_set1_epi32(disable_alpha ? 0xFF : 0);
+    Decode16BitTile(source, dest, dest_stride, [&](__m128i texels) {
+        return PackRGBA(ExpandField<12, 4>(texels), ExpandField<8, 4>(texels),
+                        ExpandField<4, 4>(texels),
+                        _mm_or_si128(ExpandField<0, 4>(texels), alpha_mask));
+    });
+#else
+    DecodeMortonTile(dest, dest_stride, [&](std::size_t i) {
+        auto res = Color::DecodeRGBA4(source + i * 2);
+        return Common::MakeVec(res.r(), res.g(), res.b(), disable_alpha ? u8{255} : res.a());
+    });
+#endif
+}
+
+void DecodeETC1Tile(const u8* source, Common::Vec4<u8>* dest, std::ptrdiff_t dest_stride,
+                    bool has_alpha, bool disable_alpha) {
+    const std::size_t subtile_size = has_alpha ? 16 : 8;
+    std::array<Common::Vec3<u8>, 16> colors;
+
+    // ETC1 further subdivides each 8x8 tile into four 4x4 subtiles
+    for (unsigned int subtile_index = 0; subtile_index < ETC1_SUBTILES; ++subtile_index) {
+        const u8* subtile_ptr = source + subtile_index * subtile_size;
+
+        u64_le packed_alpha = 0;
+        if (has_alpha) {
+            std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+
+        u64_le subtile_data;
+        std::memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+        DecodeETC1Subtile(subtile_data, colors);
+
+        Common::Vec4<u8>* subtile_dest =
+            dest + (subtile_index % 2) * 4 + (subtile_index / 2) * 4 * dest_stride;
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                u8 alpha = 255;
+                if (has_alpha && !disable_alpha) {
+                    alpha = Color::Convert4To8((packed_alpha >> (4 * (x * 4 + y))) & 0xF);
+                }
+                subtile_dest[x + y * dest_stride] = Common::MakeVec(colors[x + 4 * y], alpha);
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+void DecodeTile(const u8* source, const TextureInfo& info, Common::Vec4<u8>* dest,
+                std::ptrdiff_t dest_stride, bool disable_alpha) {
+    switch (info.format) {
+    case TextureFormat::RGBA8:
+        DecodeRGBA8Tile(source, dest, dest_stride, disable_alpha);
+        break;
+
+    case TextureFormat::RGB8:
+        DecodeMortonTile(dest, dest_stride, [&](std::size_t i) -> Common::Vec4<u8> {
+            const u8* texel = source + i * 3;
+            return {texel[2], texel[1], texel[0], 255};
+        });
+        break;
+
+    case TextureFormat::RGB5A1:
+        DecodeRGB5A1Tile(source, dest, dest_stride, disable_alpha);
+        break;
+
+    case TextureFormat::RGB565:
+        DecodeRGB565Tile(source, dest, dest_stride);
+        break;
+
+    case TextureFormat::RGBA4:
+        DecodeRGBA4Tile(source, dest, dest_stride, disable_alpha);
+        break;
+
+    case TextureFormat::IA8:
+        DecodeMortonTile(dest, dest_stride, [&](std::size_t i) -> Common::Vec4<u8> {
+            const u8* texel = source + i * 2;
+            if (disable_alpha) {
+                // Show intensity as red, alpha as green
+                return {texel[1], texel[0], 0, 255};
+            }
+            return {texel[1], texel[1], texel[1], texel[0]};
+        });
+        break;
+
+    case TextureFormat::RG8:
+        DecodeMortonTile(dest, dest_stride, [&](std::size_t i) -> Common::Vec4<u8> {
+            auto res = Color::DecodeRG8(source + i * 2);
+            return {res.r(), res.g(), 0, 255};
+        });
+        break;
+
+    case TextureFormat::I8:
+        DecodeMortonTile(dest, dest_stride, [&](std::size_t i) -> Common::Vec4<u8> {
+            return {source[i], source[i], source[i], 255};
+        });
+        break;
+
+    case TextureFormat::A8:
+        DecodeMortonTile(dest, dest_stride, [&](std::size_t i) -> Common::Vec4<u8> {
+            if (disable_alpha) {
+                return {source[i], source[i], source[i], 255};
+            }
+            return {0, 0, 0, source[i]};
+        });
+        break;
+
+    case TextureFormat::IA4:
+        DecodeMortonTile(dest, dest_stride, [&](std::size_t i) -> Common::Vec4<u8> {
+            u8 intensity = Color::Convert4To8((source[i] & 0xF0) >> 4);
+            u8 alpha = Color::Convert4To8(source[i] & 0xF);
+            if (disable_alpha) {
+                // Show intensity as red, alpha as green
+                return {intensity, alpha, 0, 255};
+            }
+            return {intensity, intensity, intensity, alpha};
+        });
+        break;
+
+    case TextureFormat::I4:
+        DecodeMortonTile(dest, dest_stride, [&](std::size_t i) -> Common::Vec4<u8> {
+            u8 intensity = Color::Convert4To8((source[i / 2] >> ((i % 2) * 4)) & 0xF);
+            return {intensity, intensity, intensity, 255};
+        });
+        break;
+
+    case TextureFormat::A4:
+        DecodeMortonTile(dest, dest_stride, [&](std::size_t i) -> Common::Vec4<u8> {
+            u8 alpha = Color::Convert4To8((source[i / 2] >> ((i % 2) * 4)) & 0xF);
+            if (disable_alpha) {
+                return {alpha, alpha, alpha, 255};
+            }
+            return {0, 0, 0, alpha};
+        });
+        break;
+
+    case TextureFormat::ETC1:
+    case TextureFormat::ETC1A4:
+        DecodeETC1Tile(source, dest, dest_stride, info.format == TextureFormat::ETC1A4,
+                       disable_alpha);
+        break;
+
+    default:
+        LOG_ERROR(HW_GPU, "Unknown texture format: {:x}", (u32)info.format);
+        DEBUG_ASSERT(false);
+        for (unsigned int y = 0; y < 8; ++y) {
+            std::fill_n(dest + y * dest_stride, 8, Common::Vec4<u8>{});
+        }
+        break;
+    }
+}
+
+void DecodeTexture(const u8* source, const TextureInfo& info, Common::Vec4<u8>* dest,
+                   bool disable_alpha) {
+    const std::size_t tile_size = CalculateTileSize(info.format);
+    for (unsigned int y = 0; y < info.height; y += 8) {
+        const u8* line = source + (y / 8) * info.stride;
+        for (unsigned int x = 0; x < info.width; x += 8) {
+            DecodeTile(line + (x / 8) * tile_size, info, dest + x + y * info.width, info.width,
+                       disable_alpha);
+        }
+    }
+}
+
 TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& config,
                                           const TexturingRegs::TextureFormat& format) {
     TextureInfo info;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_texturing.h"
@@ -55,4 +56,32 @@ Common::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
 Common::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int y,
                                    const TextureInfo& info, bool disable_alpha);
 
+/**
+ * Decodes all texels of a single 8x8 texture tile. This yields the same colors as calling
+ * LookupTexelInTile for every in-tile coordinate, but only dispatches on the format once.
+ * RGBA8, RGB5A1, RGB565 and RGBA4 are decoded four texels at a time with SSE2 on x86_64. ETC1 is
+ * decoded a subtile at a time, and the remaining formats one texel at a time.
+ *
+ * @param source Pointer to the beginning of the tile.
+ * @param info TextureInfo describing the texture format.
+ * @param dest Destination for the decoded texels. In-tile texel (x, y) is written to
+ *             dest[x + y * dest_stride].
+ * @param dest_stride Distance between two rows in the destination, in texels. May be negative.
+ * @param disable_alpha Used for debugging, see LookupTexelInTile.
+ */
+void DecodeTile(const u8* source, const TextureInfo& info, Common::Vec4<u8>* dest,
+                std::ptrdiff_t dest_stride, bool disable_alpha = false);
+
+/**
+ * Decodes a whole texture to linear RGBA8 texels.
+ *
+ * @param source Source pointer to read data from
+ * @param info TextureInfo object describing the texture setup
+ * @param dest Destination for info.width * info.height texels. The texel LookupTexture returns
+ *             for coordinates (x, y) is written to dest[x + y * info.width].
+ * @param disable_alpha Used for debugging, see LookupTexture.
+ */
+void DecodeTexture(const u8* source, const TextureInfo& info, Common::Vec4<u8>* dest,
+                   bool disable_alpha = false);
+
 } // namespace Pica::Texture